@@ -1,5 +1,7 @@
 include(resources/theme/material/material.pri)
 
+QT += quick
+
 TEMPLATE = app
 TARGET = clockwork
 CONFIG += c++14
@@ -27,6 +29,7 @@ INCLUDEPATH += \
 HEADERS += \
     src/graphics/Framebuffer.hh \
     src/graphics/GraphicsEngine.hh \
+    src/graphics/SwapChain.hh \
     src/math/Matrix4.hh \
     src/math/Point3.hh \
     src/math/Quaternion.hh \
@@ -36,13 +39,14 @@ HEADERS += \
     src/system/Error.hh \
     src/system/Service.hh \
     src/task/TaskManager.hh \
-    src/ui/FramebufferProvider.hh \
+    src/ui/FramebufferItem.hh \
     src/ui/UserInterface.hh \
     src/clockwork.hh
 
 SOURCES += \
     src/graphics/Framebuffer.cc \
     src/graphics/GraphicsEngine.cc \
+    src/graphics/SwapChain.cc \
     src/math/Matrix4.cc \
     src/math/Point3.cc \
     src/math/Point4.cc \
@@ -53,6 +57,6 @@ SOURCES += \
     src/system/Error.cc \
     src/system/Service.cc \
     src/task/TaskManager.cc \
-    src/ui/FramebufferProvider.cc \
+    src/ui/FramebufferItem.cc \
     src/ui/UserInterface.cc \
     src/clockwork.cc
@@ -0,0 +1,5 @@
+# The benchmarks: clockwork-bench renders whole frames, and clockwork-microbench times the
+# engine's hot paths in isolation.
+TEMPLATE = subdirs
+SUBDIRS = clockwork-bench \
+          clockwork-microbench
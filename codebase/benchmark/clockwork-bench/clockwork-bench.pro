@@ -0,0 +1,11 @@
+# The headless benchmark suite. Run ../../build/clockwork-bench --help for its options.
+TEMPLATE = app
+TARGET = clockwork-bench
+
+include(../../clockwork.pri)
+
+INCLUDEPATH += $$PWD/../../include/benchmark
+
+HEADERS += $$PWD/../../include/benchmark/benchmark.hh
+SOURCES += $$PWD/../../src/clockwork.bench.cpp \
+           $$PWD/../../src/benchmark/benchmark.cpp
@@ -0,0 +1,13 @@
+# The micro-benchmarks of the engine's hot paths. Run ../../build/clockwork-microbench --help
+# for its options.
+TEMPLATE = app
+TARGET = clockwork-microbench
+
+include(../../clockwork.pri)
+
+INCLUDEPATH += $$PWD/../../include/benchmark
+
+HEADERS += $$PWD/../../include/benchmark/micro.benchmark.hh
+SOURCES += $$PWD/../../src/clockwork.microbench.cpp \
+           $$PWD/../../src/benchmark/micro.benchmark.cpp \
+           $$PWD/../../src/benchmark/micro.benchmarks.cpp
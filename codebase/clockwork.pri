@@ -0,0 +1,226 @@
+# The engine, which is shared by the application (clockwork.pro) and the benchmarks
+# (benchmark/benchmark.pro). The including project sets its TEMPLATE and TARGET first.
+QT += widgets
+CONFIG += c++14
+
+QMAKE_CXXFLAGS += -Wextra
+
+# Build with CONFIG+=profiler to compile the frame profiler and its heads-up display.
+profiler {
+   DEFINES += CLOCKWORK_PROFILER
+}
+
+DESTDIR = $$PWD/../build
+OBJECTS_DIR = $${DESTDIR}/obj/$${TARGET}
+MOC_DIR = $${DESTDIR}/moc/$${TARGET}
+RCC_DIR = $${DESTDIR}/rcc/$${TARGET}
+UI_DIR = $${DESTDIR}/ui
+
+INCLUDEPATH += $$PWD \
+               $$PWD/include \
+               $$PWD/include/system \
+               $$PWD/include/ui \
+               $$PWD/include/graphics \
+               $$PWD/include/types/math \
+               $$PWD/include/system/resource \
+               $$PWD/include/ui/views \
+               $$PWD/include/scene \
+               $$PWD/include/system/subsystem \
+               $$PWD/include/concurrency \
+               $$PWD/include/graphics/filter \
+               $$PWD/include/types \
+               $$PWD/include/graphics/renderer \
+               $$PWD/include/graphics/projection \
+               $$PWD/include/graphics/line.algorithm \
+               $$PWD/include/scene/property \
+               $$PWD/include/io \
+               $$PWD/include/ui/comboboxes \
+               $$PWD/include/graphics/renderer/algorithm
+
+# Input
+HEADERS += $$PWD/include/system.hh \
+           $$PWD/include/concurrency/frame.loop.hh \
+           $$PWD/include/concurrency/task.geometry.hh \
+           $$PWD/include/concurrency/task.hh \
+           $$PWD/include/concurrency/task.raster.hh \
+           $$PWD/include/concurrency/task.update.hh \
+           $$PWD/include/graphics/bounding.volume.hh \
+           $$PWD/include/graphics/camera.hh \
+           $$PWD/include/graphics/color.hh \
+           $$PWD/include/graphics/face.hh \
+           $$PWD/include/graphics/fragment.hh \
+           $$PWD/include/graphics/framebuffer.hh \
+           $$PWD/include/graphics/frustum.hh \
+           $$PWD/include/graphics/index.buffer.hh \
+           $$PWD/include/graphics/material.hh \
+           $$PWD/include/graphics/material.library.hh \
+           $$PWD/include/graphics/mesh.optimizer.hh \
+           $$PWD/include/graphics/mesh.simplifier.hh \
+           $$PWD/include/graphics/model3d.hh \
+           $$PWD/include/graphics/occlusion.buffer.hh \
+           $$PWD/include/graphics/pipeline.statistics.hh \
+           $$PWD/include/graphics/primitive.mode.hh \
+           $$PWD/include/graphics/ray.hh \
+           $$PWD/include/graphics/tangent.space.hh \
+           $$PWD/include/graphics/texture.hh \
+           $$PWD/include/graphics/triangle.hierarchy.hh \
+           $$PWD/include/graphics/vertex.hh \
+           $$PWD/include/graphics/viewport.hh \
+           $$PWD/include/io/file.reader.hh \
+           $$PWD/include/io/model3d.cache.hh \
+           $$PWD/include/io/tostring.hh \
+           $$PWD/include/scene/bounding.volume.hierarchy.hh \
+           $$PWD/include/scene/predefs.hh \
+           $$PWD/include/scene/scene.generator.hh \
+           $$PWD/include/scene/scene.hh \
+           $$PWD/include/scene/scene.object.hh \
+           $$PWD/include/scene/scene.property.hh \
+           $$PWD/include/scene/scene.snapshot.hh \
+           $$PWD/include/scene/scene.viewer.hh \
+           $$PWD/include/scene/transform.hierarchy.hh \
+           $$PWD/include/system/debug.hh \
+           $$PWD/include/system/error.hh \
+           $$PWD/include/system/execution.context.hh \
+           $$PWD/include/system/profiler.hh \
+           $$PWD/include/system/services.hh \
+           $$PWD/include/system/subsystem.hh \
+           $$PWD/include/types/factory.hh \
+           $$PWD/include/ui/ui.component.hh \
+           $$PWD/include/ui/ui.display.hh \
+           $$PWD/include/ui/ui.hh \
+           $$PWD/include/ui/window.hh \
+           $$PWD/include/graphics/filter/image.filter.hh \
+           $$PWD/include/graphics/filter/texture.filter.hh \
+           $$PWD/include/graphics/line.algorithm/line.algorithm.hh \
+           $$PWD/include/graphics/projection/projection.factory.hh \
+           $$PWD/include/graphics/projection/projection.hh \
+           $$PWD/include/graphics/renderer/render.algorithm.hh \
+           $$PWD/include/scene/property/property.appearance.hh \
+           $$PWD/include/scene/property/property.light.emission.hh \
+           $$PWD/include/system/resource/resource.hh \
+           $$PWD/include/system/resource/resource.manager.hh \
+           $$PWD/include/system/subsystem/concurrency.subsystem.hh \
+           $$PWD/include/system/subsystem/graphics.subsystem.hh \
+           $$PWD/include/system/subsystem/physics.subsystem.hh \
+           $$PWD/include/types/math/matrix4.hh \
+           $$PWD/include/types/math/numerical.hh \
+           $$PWD/include/types/math/point3.hh \
+           $$PWD/include/types/math/point4.hh \
+           $$PWD/include/types/math/quaternion.hh \
+           $$PWD/include/types/math/vector3.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.framebuffer.resolution.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.image.filter.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.line.algorithm.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.primitive.mode.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.projection.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.renderer.hh \
+           $$PWD/include/ui/comboboxes/ui.combobox.texture.filter.hh \
+           $$PWD/include/ui/views/ui.view.hh \
+           $$PWD/include/ui/views/ui.view.scene.hh \
+           $$PWD/include/graphics/line.algorithm/algorithm/bresenham.line.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/bump.map.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/cel.shading.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/constant.shading.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/deferred.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/depth.map.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/normal.map.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/phong.shading.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/point.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/polygon.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/random.shading.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/texture.map.render.algorithm.hh \
+           $$PWD/include/graphics/renderer/algorithm/wireframe.render.algorithm.hh
+SOURCES += $$PWD/src/system.cpp \
+           $$PWD/src/concurrency/frame.loop.cpp \
+           $$PWD/src/concurrency/geometry.task.cpp \
+           $$PWD/src/concurrency/raster.task.cpp \
+           $$PWD/src/concurrency/task.cpp \
+           $$PWD/src/concurrency/update.task.cpp \
+           $$PWD/src/graphics/bounding.volume.cpp \
+           $$PWD/src/graphics/camera.cpp \
+           $$PWD/src/graphics/color.cpp \
+           $$PWD/src/graphics/face.cpp \
+           $$PWD/src/graphics/fragment.cpp \
+           $$PWD/src/graphics/framebuffer.cpp \
+           $$PWD/src/graphics/frustum.cpp \
+           $$PWD/src/graphics/index.buffer.cpp \
+           $$PWD/src/graphics/material.cpp \
+           $$PWD/src/graphics/material.library.cpp \
+           $$PWD/src/graphics/mesh.optimizer.cpp \
+           $$PWD/src/graphics/mesh.simplifier.cpp \
+           $$PWD/src/graphics/model3d.cpp \
+           $$PWD/src/graphics/occlusion.buffer.cpp \
+           $$PWD/src/graphics/pipeline.statistics.cpp \
+           $$PWD/src/graphics/ray.cpp \
+           $$PWD/src/graphics/tangent.space.cpp \
+           $$PWD/src/graphics/texture.cpp \
+           $$PWD/src/graphics/triangle.hierarchy.cpp \
+           $$PWD/src/graphics/vertex.cpp \
+           $$PWD/src/graphics/viewport.cpp \
+           $$PWD/src/io/file.reader.mtl.cpp \
+           $$PWD/src/io/file.reader.obj.cpp \
+           $$PWD/src/io/model3d.cache.cpp \
+           $$PWD/src/io/output.cpp \
+           $$PWD/src/io/tostring.cpp \
+           $$PWD/src/scene/bounding.volume.hierarchy.cpp \
+           $$PWD/src/scene/generator.cpp \
+           $$PWD/src/scene/object.cpp \
+           $$PWD/src/scene/predefs.cpp \
+           $$PWD/src/scene/property.cpp \
+           $$PWD/src/scene/scene.cpp \
+           $$PWD/src/scene/snapshot.cpp \
+           $$PWD/src/scene/transform.hierarchy.cpp \
+           $$PWD/src/scene/viewer.cpp \
+           $$PWD/src/system/debug.cpp \
+           $$PWD/src/system/profiler.cpp \
+           $$PWD/src/system/services.cpp \
+           $$PWD/src/system/subsystem.cpp \
+           $$PWD/src/types/matrix4.cpp \
+           $$PWD/src/types/numerical.cpp \
+           $$PWD/src/types/point3.cpp \
+           $$PWD/src/types/point4.cpp \
+           $$PWD/src/types/quaternion.cpp \
+           $$PWD/src/types/vector3.cpp \
+           $$PWD/src/ui/ui.component.cpp \
+           $$PWD/src/ui/ui.cpp \
+           $$PWD/src/ui/ui.display.cpp \
+           $$PWD/src/ui/window.cpp \
+           $$PWD/src/graphics/filter/image.filter.cpp \
+           $$PWD/src/graphics/filter/texture.filter.cpp \
+           $$PWD/src/graphics/line.algorithm/line.algorithm.cpp \
+           $$PWD/src/graphics/primitive.mode/primitive.mode.cpp \
+           $$PWD/src/graphics/projection/projection.cpp \
+           $$PWD/src/graphics/projection/projection.factory.cpp \
+           $$PWD/src/graphics/renderer/render.algorithm.cpp \
+           $$PWD/src/scene/property/appearance.cpp \
+           $$PWD/src/scene/property/light.emission.cpp \
+           $$PWD/src/system/resource/resource.cpp \
+           $$PWD/src/system/resource/resource.manager.cpp \
+           $$PWD/src/system/subsystem/concurrency.subsystem.cpp \
+           $$PWD/src/system/subsystem/graphics.subsystem.cpp \
+           $$PWD/src/system/subsystem/physics.subsystem.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.framebuffer.resolution.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.image.filter.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.line.algorithm.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.primitive.mode.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.projection.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.renderer.cpp \
+           $$PWD/src/ui/comboboxes/ui.combobox.texture.filter.cpp \
+           $$PWD/src/ui/views/ui.view.cpp \
+           $$PWD/src/ui/views/ui.view.scene.cpp \
+           $$PWD/src/graphics/line.algorithm/algorithm/bresenham.line.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/bump.map.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/cel.shading.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/constant.shading.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/deferred.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/depth.map.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/normal.map.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/phong.shading.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/point.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/polygon.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/random.shading.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/texture.map.render.algorithm.cpp \
+           $$PWD/src/graphics/renderer/algorithms/wireframe.render.algorithm.cpp
+RESOURCES += $$PWD/clockwork.qrc
@@ -0,0 +1,223 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "render.algorithm.hh"
+#include "framebuffer.hh"
+#include "model3d.hh"
+#include "scene.generator.hh"
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+namespace clockwork {
+namespace benchmark {
+
+/**
+ * The Benchmark renders a set of scenes along fixed camera paths, with every combination
+ * of render algorithm, framebuffer resolution and thread count, and measures how long
+ * it takes. It doesn't need a display, since frames are drawn to the framebuffer only.
+ */
+class Benchmark
+{
+public:
+   /**
+    * The cases to run. An empty list selects every available value.
+    */
+   struct Options
+   {
+      /**
+       * The names of the scenes to render.
+       */
+      QStringList scenes;
+      /**
+       * The render algorithms to render the scenes with.
+       */
+      QList<clockwork::graphics::RenderAlgorithm::Identifier> algorithms;
+      /**
+       * The framebuffer resolutions to render the scenes at.
+       */
+      QList<clockwork::graphics::Framebuffer::Resolution> resolutions;
+      /**
+       * The numbers of threads to render the scenes with.
+       */
+      QList<int> threadCounts;
+      /**
+       * The number of frames that are measured along each camera path.
+       */
+      unsigned int frameCount = 120;
+      /**
+       * The number of frames that are drawn before the measurement starts, so that caches
+       * and buffers are warm.
+       */
+      unsigned int warmupFrameCount = 10;
+   };
+   /**
+    * The measurements of a single benchmark case.
+    */
+   struct Result
+   {
+      /**
+       * The name of the scene that was rendered.
+       */
+      QString scene;
+      /**
+       * The render algorithm the scene was rendered with.
+       */
+      clockwork::graphics::RenderAlgorithm::Identifier algorithm;
+      /**
+       * The framebuffer resolution the scene was rendered at.
+       */
+      clockwork::graphics::Framebuffer::Resolution resolution;
+      /**
+       * The number of threads the scene was rendered with.
+       */
+      int threadCount;
+      /**
+       * The average time it takes to draw a frame, in milliseconds.
+       */
+      double millisecondsPerFrame;
+      /**
+       * The number of triangles submitted to the render algorithm, in millions per second.
+       */
+      double trianglesPerSecond;
+      /**
+       * The number of framebuffer pixels drawn, in millions per second.
+       */
+      double pixelsPerSecond;
+      /**
+       * The speedup over the case with the fewest threads, divided by the ratio of their
+       * thread counts. A value of 1 means that the case scales perfectly.
+       */
+      double scalingEfficiency;
+   };
+   /**
+    * Instantiate a benchmark, which adds its scenes to the scene graph. The scenes are
+    * pruned until they are rendered.
+    */
+   Benchmark();
+   /**
+    * The destructor removes the benchmark's scenes from the scene graph.
+    */
+   ~Benchmark();
+   /**
+    * A benchmark is not copyable.
+    */
+   Benchmark(const Benchmark&) = delete;
+   Benchmark& operator=(const Benchmark&) = delete;
+   /**
+    * Generate a scene, and add it to the available scenes. Generated scenes follow their
+    * motion along the camera path. Returns the scene's name.
+    * @param options the generated scene's parameters.
+    */
+   QString addScene(const clockwork::scene::SceneGenerator::Options& options);
+   /**
+    * Return the names of the available scenes.
+    */
+   QStringList getSceneNames() const;
+   /**
+    * Run the benchmark cases that are selected by a set of options, and return their results.
+    * @param options the options.
+    * @param progress the stream that the progress is written to.
+    */
+   std::vector<Result> run(const Options& options, std::ostream& progress);
+   /**
+    * Convert a set of results into a JSON object.
+    * @param options the options the results were obtained with.
+    * @param results the results.
+    */
+   static QJsonObject toJson(const Options& options, const std::vector<Result>& results);
+   /**
+    * Compare a set of results with a baseline that was created by toJson, and write a
+    * report. Returns false if any case is slower than its baseline by more than the
+    * given tolerance, true otherwise. Cases that are missing from the baseline are
+    * reported, but never fail the comparison.
+    * @param results the results to compare.
+    * @param baseline the baseline.
+    * @param tolerance the fraction by which a case may be slower than its baseline.
+    * @param report the stream that the report is written to.
+    */
+   static bool compare
+   (
+      const std::vector<Result>& results,
+      const QJsonObject& baseline,
+      const double& tolerance,
+      std::ostream& report
+   );
+private:
+   /**
+    * A set of scene objects, and the path that the camera follows through them.
+    */
+   struct Scene
+   {
+      /**
+       * The scene's name.
+       */
+      QString name;
+      /**
+       * The objects that are drawn.
+       */
+      std::vector<clockwork::scene::Object*> objects;
+      /**
+       * Place the scene at a given point of the camera path, where 0 is its beginning
+       * and 1 its end.
+       */
+      std::function<void(const double& t)> path;
+   };
+   /**
+    * Enable a scene and prune the others.
+    * @param scene the scene to enable, or nullptr to prune every scene.
+    */
+   void select(const Scene* const scene);
+   /**
+    * Draw a frame of a scene at a given point of its camera path.
+    * @param scene the scene to draw.
+    * @param t the point of the camera path.
+    */
+   void draw(const Scene& scene, const double& t);
+   /**
+    * The scenes.
+    */
+   std::vector<Scene> _scenes;
+   /**
+    * The generated 3D models that are used by the scenes.
+    */
+   std::vector<std::unique_ptr<clockwork::graphics::Model3D>> _models;
+   /**
+    * The objects that were added to the scene graph.
+    */
+   std::vector<clockwork::scene::Object*> _roots;
+   /**
+    * The generated scenes.
+    */
+   std::vector<std::unique_ptr<clockwork::scene::SceneGenerator>> _generators;
+};
+
+} // namespace benchmark
+} // namespace clockwork
@@ -0,0 +1,237 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+
+namespace clockwork {
+namespace benchmark {
+
+/**
+ * A MicroBenchmark times a small piece of code by running it in a loop, in the manner
+ * of Google Benchmark. The number of iterations grows until the loop runs for long
+ * enough to be measured reliably. Benchmarks are registered with CLOCKWORK_BENCHMARK.
+ */
+class MicroBenchmark
+{
+public:
+   /**
+    * The state of a benchmark run, which controls the benchmark's loop.
+    */
+   class State
+   {
+   friend class MicroBenchmark;
+   public:
+      /**
+       * Returns true if the loop must run another iteration, false otherwise. The timer
+       * starts with the first call and stops with the last, so any setup must be done
+       * before the loop.
+       */
+      inline bool keepRunning()
+      {
+         if (_remainingIterationCount == _iterationCount)
+            resumeTiming();
+         if (_remainingIterationCount > 0)
+         {
+            --_remainingIterationCount;
+            return true;
+         }
+         pauseTiming();
+         return false;
+      }
+      /**
+       * Return the number of iterations the loop runs.
+       */
+      const uint64_t& getIterationCount() const;
+      /**
+       * Set the number of items that are processed by each iteration, e.g. the vertices
+       * of a batch. The throughput is reported in items per second.
+       * @param count the number of items.
+       */
+      void setItemsPerIteration(const uint64_t& count);
+      /**
+       * Stop the timer, e.g. while data is prepared inside the loop.
+       */
+      void pauseTiming();
+      /**
+       * Restart the timer.
+       */
+      void resumeTiming();
+   private:
+      /**
+       * Instantiate a state that runs the loop a given number of times.
+       * @param iterationCount the number of iterations.
+       */
+      explicit State(const uint64_t& iterationCount);
+      /**
+       * The number of iterations the loop runs.
+       */
+      const uint64_t _iterationCount;
+      /**
+       * The number of iterations left to run.
+       */
+      uint64_t _remainingIterationCount;
+      /**
+       * The number of items that are processed by each iteration.
+       */
+      uint64_t _itemsPerIteration;
+      /**
+       * The time at which the timer was last started, in nanoseconds.
+       */
+      int64_t _start;
+      /**
+       * The time the loop has run for, in nanoseconds.
+       */
+      int64_t _elapsed;
+   };
+   /**
+    * The measurements of a benchmark.
+    */
+   struct Result
+   {
+      /**
+       * The benchmark's name.
+       */
+      QString name;
+      /**
+       * The number of iterations in the measured run.
+       */
+      uint64_t iterationCount;
+      /**
+       * The average time an iteration takes, in nanoseconds.
+       */
+      double nanosecondsPerIteration;
+      /**
+       * The number of items processed per second, or 0 if the benchmark doesn't count items.
+       */
+      double itemsPerSecond;
+   };
+   /**
+    * The signature of a benchmark's function.
+    */
+   using Function = std::function<void(MicroBenchmark::State&)>;
+   /**
+    * Register a benchmark. This returns true, so that it can initialise a static variable.
+    * @param name the benchmark's name.
+    * @param function the benchmark's function.
+    */
+   static bool add(const QString& name, const Function& function);
+   /**
+    * Run the benchmarks whose names match a regular expression, and return their results.
+    * @param filter the regular expression that selects the benchmarks.
+    * @param minimumTime the time a benchmark must run for to be measured, in seconds.
+    * @param output the stream that the results are written to as they are measured.
+    */
+   static std::vector<Result> run(const QString& filter, const double& minimumTime, std::ostream& output);
+   /**
+    * Convert a set of results into a JSON object that follows Google Benchmark's format.
+    * @param results the results.
+    */
+   static QJsonObject toJson(const std::vector<Result>& results);
+   /**
+    * Compare a set of results with a baseline that was created by toJson, and write a
+    * report. Returns false if any benchmark is slower than its baseline by more than
+    * the given tolerance, true otherwise.
+    * @param results the results to compare.
+    * @param baseline the baseline.
+    * @param tolerance the fraction by which a benchmark may be slower than its baseline.
+    * @param report the stream that the report is written to.
+    */
+   static bool compare
+   (
+      const std::vector<Result>& results,
+      const QJsonObject& baseline,
+      const double& tolerance,
+      std::ostream& report
+   );
+private:
+   /**
+    * A registered benchmark.
+    */
+   struct Entry
+   {
+      /**
+       * The benchmark's name.
+       */
+      QString name;
+      /**
+       * The benchmark's function.
+       */
+      Function function;
+   };
+   /**
+    * Return the registered benchmarks, in the order they were registered.
+    */
+   static std::vector<Entry>& getEntries();
+   /**
+    * Return the current time, in nanoseconds.
+    */
+   static int64_t now();
+};
+
+/**
+ * Prevent the compiler from discarding a value that is never used, or from assuming that
+ * a variable hasn't changed, so that the code being measured isn't optimised away.
+ * @param value the value.
+ */
+template<class T>
+inline void
+doNotOptimize(T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   asm volatile("" : "+m"(value) : : "memory");
+#else
+   static void* volatile sink;
+   sink = &value;
+#endif
+}
+/**
+ * @see doNotOptimize(T&).
+ */
+template<class T>
+inline void
+doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   asm volatile("" : : "m"(value) : "memory");
+#else
+   static const void* volatile sink;
+   sink = &value;
+#endif
+}
+
+} // namespace benchmark
+} // namespace clockwork
+
+/**
+ * Register a micro-benchmark function under a given name.
+ */
+#define CLOCKWORK_BENCHMARK(function, name) \
+static const bool function##IsRegistered = clockwork::benchmark::MicroBenchmark::add(name, function)
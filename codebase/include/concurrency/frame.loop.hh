@@ -0,0 +1,198 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <QObject>
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace concurrency {
+
+/**
+ * The frame loop paces the production of frames. On each tick of its timer, the
+ * simulation is advanced by a whole number of fixed timesteps before a frame is
+ * submitted to the thread pool. A frame is produced by a pipeline of tasks: an
+ * UpdateTask and GeometryTask that access the scene, then a RasterTask that doesn't.
+ * A new frame is only submitted once the previous one no longer accesses the scene,
+ * so one frame can be rasterised while the next one is updated and processed.
+ *
+ * The number of frames that may be in flight at any time is bounded: when the limit is
+ * reached, the tick is skipped and its elapsed time is folded into the next frame, so
+ * stale frames are coalesced instead of queueing up behind one another.
+ */
+class FrameLoop : public QObject
+{
+Q_OBJECT
+public:
+   /**
+    * Instantiate a FrameLoop.
+    * @param parent the loop's parent object.
+    */
+   explicit FrameLoop(QObject* const parent = nullptr);
+   /**
+    * Return the fixed simulation timestep, in seconds.
+    */
+   const double& getTimestep() const;
+   /**
+    * Set the fixed simulation timestep.
+    * @param timestep the timestep to set, in seconds.
+    */
+   void setTimestep(const double& timestep);
+   /**
+    * Return the target frame rate, in frames per second.
+    */
+   const double& getTargetFrameRate() const;
+   /**
+    * Set the target frame rate. Ticks are paced to this rate, much like vertical
+    * synchronisation would.
+    * @param frameRate the frame rate to set, in frames per second.
+    */
+   void setTargetFrameRate(const double& frameRate);
+   /**
+    * Return the maximum number of frames that may be in flight.
+    */
+   const unsigned int& getMaximumInFlightFrameCount() const;
+   /**
+    * Set the maximum number of frames that may be in flight.
+    * @param count the maximum number of frames, which is at least 1.
+    */
+   void setMaximumInFlightFrameCount(const unsigned int& count);
+   /**
+    * Return the number of frames that have been submitted but not yet rendered.
+    */
+   unsigned int getInFlightFrameCount() const;
+   /**
+    * Return the number of ticks that were coalesced into a later frame because too many
+    * frames were in flight.
+    */
+   const uint64_t& getCoalescedFrameCount() const;
+   /**
+    * Return true if frames are produced on every tick, false if they are only produced
+    * when requested.
+    */
+   bool isContinuous() const;
+   /**
+    * Enable or disable continuous frame production. When disabled, the loop goes idle
+    * until a frame is requested.
+    * @param continuous true to produce frames on every tick, false otherwise.
+    */
+   void setContinuous(const bool& continuous);
+public slots:
+   /**
+    * Request a frame. Requests made before the next tick are coalesced into one frame.
+    */
+   void requestFrame();
+   /**
+    * Signal that a frame has been processed, so that the next one may be updated. This
+    * slot is thread-safe.
+    */
+   void onFrameProcessed();
+   /**
+    * Signal that a frame has been rendered, and is no longer in flight. This slot is
+    * thread-safe.
+    */
+   void onFrameRetired();
+   /**
+    * Signal that a frame has been cancelled, and is no longer in flight. Another frame
+    * is requested so that the scene's changes are eventually drawn. This slot is
+    * thread-safe.
+    */
+   void onFrameCancelled();
+signals:
+   /**
+    * This signal is emitted for each fixed timestep the simulation is advanced by.
+    * @param timestep the timestep, in seconds.
+    */
+   void stepped(const double& timestep);
+private:
+   /**
+    * The largest number of timesteps the simulation is advanced by in a single frame.
+    * When a frame takes longer than this, the excess time is dropped so that a slow
+    * frame doesn't lead to even slower ones.
+    */
+   static constexpr unsigned int MAXIMUM_STEP_COUNT = 5;
+   /**
+    * The timer that paces the loop.
+    */
+   QBasicTimer _timer;
+   /**
+    * The clock that measures the time between two ticks.
+    */
+   QElapsedTimer _clock;
+   /**
+    * The fixed simulation timestep.
+    */
+   double _timestep;
+   /**
+    * The target frame rate.
+    */
+   double _targetFrameRate;
+   /**
+    * The time that has yet to be simulated.
+    */
+   double _accumulator;
+   /**
+    * The maximum number of frames that may be in flight.
+    */
+   unsigned int _maximumInFlightFrameCount;
+   /**
+    * The number of frames in flight.
+    */
+   std::atomic<unsigned int> _inFlightFrameCount;
+   /**
+    * True if a frame is being updated or processed.
+    */
+   std::atomic<bool> _isProcessingFrame;
+   /**
+    * The number of coalesced ticks.
+    */
+   uint64_t _coalescedFrameCount;
+   /**
+    * True if frames are produced on every tick.
+    */
+   bool _isContinuous;
+   /**
+    * True if a frame has been requested since the last one was submitted.
+    */
+   bool _isFrameRequested;
+   /**
+    * Start the timer, if it isn't already running.
+    */
+   void start();
+   /**
+    * Advance the simulation and submit a frame, if possible.
+    */
+   void tick();
+   /**
+    * @see QObject::timerEvent.
+    */
+   void timerEvent(QTimerEvent* const) override final;
+};
+
+} // namespace concurrency
+} // namespace clockwork
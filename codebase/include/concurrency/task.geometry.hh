@@ -0,0 +1,65 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "task.hh"
+
+
+namespace clockwork {
+namespace concurrency {
+
+class FrameLoop;
+
+/**
+ * The geometry task processes the snapshot that is published once the scene has been
+ * updated: it determines what has changed and runs the geometry stages of the render
+ * algorithms, then hands the resulting frame packet over to a RasterTask. Once it
+ * completes, the next frame may be updated.
+ */
+class GeometryTask : public Task
+{
+public:
+   /**
+    * Instantiate a GeometryTask with a given priority.
+    * @param frameLoop the frame loop that submitted the frame.
+    * @param priority the task's priority.
+    */
+   explicit GeometryTask(FrameLoop& frameLoop, const int priority = 0);
+private:
+   /**
+    * The frame loop that submitted the frame.
+    */
+   FrameLoop& _frameLoop;
+   /**
+    * @see Task::execute.
+    */
+   void execute() override final;
+   /**
+    * @see Task::onCancelled.
+    */
+   void onCancelled() override final;
+};
+
+} // namespace concurrency
+} // namespace clockwork
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <QRunnable>
+#include <atomic>
 
 
 namespace clockwork {
@@ -36,22 +37,60 @@ public:
     * Return the task's priority.
     */
    const int& getPriority() const;
-//public slots:
    /**
-    * Terminate the task's execution.
+    * Request the task's cancellation. A task that hasn't started will not be executed,
+    * while a running task stops at its next cancellation checkpoint. This is thread-safe.
     */
-//   void terminate();
+   void cancel();
+   /**
+    * Return true if the task's cancellation has been requested, false otherwise.
+    */
+   bool isCancelled() const;
+   /**
+    * Return true if the task has started running, false if it is still queued.
+    */
+   bool isStarted() const;
+   /**
+    * Return true if this task is made redundant by another, newer task, i.e. the other
+    * task will produce a more recent version of this task's result. A queued task that
+    * is superseded by a newly submitted task is cancelled.
+    * @param task the newer task.
+    */
+   virtual bool isSupersededBy(const Task& task) const;
+   /**
+    * Run the task, unless it has been cancelled.
+    * @see QRunnable::run.
+    */
+   void run() override final;
 protected:
    /**
     * Instantiate a task with a specified priority.
     * @param priority the tasks's priority.
     */
    explicit Task(const int priority = 0);
+   /**
+    * Execute the task. Long tasks should check isCancelled between their stages, and
+    * return early if it returns true.
+    */
+   virtual void execute() = 0;
+   /**
+    * This function is called when the task is cancelled before or during its execution.
+    * It gives the task a chance to release whatever it has reserved.
+    */
+   virtual void onCancelled();
 private:
    /**
     * The task's priority.
     */
    const int _priority;
+   /**
+    * True if the task's cancellation has been requested.
+    */
+   std::atomic<bool> _isCancelled;
+   /**
+    * True if the task has started running.
+    */
+   std::atomic<bool> _isStarted;
 };
 
 } // namespace concurrency
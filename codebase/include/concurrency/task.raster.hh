@@ -0,0 +1,84 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <QObject>
+#include "task.hh"
+#include "graphics.subsystem.hh"
+#include <memory>
+
+
+namespace clockwork {
+namespace concurrency {
+
+class FrameLoop;
+
+/**
+ * The raster task is the last stage of a frame: it rasterises and post-processes a frame
+ * packet that was produced by a GeometryTask. Since the packet doesn't refer to the scene,
+ * the next frame's update and geometry stages can run at the same time.
+ */
+class RasterTask : public QObject, public Task
+{
+Q_OBJECT
+public:
+   /**
+    * Instantiate a RasterTask with a given priority.
+    * @param frameLoop the frame loop that the rasterised frame belongs to. The loop is
+    * notified when the task completes or is cancelled.
+    * @param packet the frame packet to rasterise.
+    * @param priority the task's priority.
+    */
+   RasterTask
+   (
+      FrameLoop& frameLoop,
+      const std::shared_ptr<const clockwork::system::GraphicsSubsystem::FramePacket>& packet,
+      const int priority = 0
+   );
+private:
+   /**
+    * The frame packet to rasterise.
+    */
+   const std::shared_ptr<const clockwork::system::GraphicsSubsystem::FramePacket> _packet;
+   /**
+    * @see Task::execute.
+    */
+   void execute() override final;
+   /**
+    * @see Task::onCancelled.
+    */
+   void onCancelled() override final;
+signals:
+   /**
+    * This signal is emitted when the task completes its execution successfully.
+    */
+   void completed();
+   /**
+    * This signal is emitted when the task is cancelled.
+    */
+   void cancelled();
+};
+
+} // namespace concurrency
+} // namespace clockwork
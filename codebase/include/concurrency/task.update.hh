@@ -24,30 +24,40 @@
 #pragma once
 
 #include "task.hh"
-#include "scene.object.hh"
 
 
 namespace clockwork {
 namespace concurrency {
 
+class FrameLoop;
+
 class UpdateTask : public Task
 {
 public:
    /**
     * Instantiate an UpdateTask with a given priority.
+    * @param frameLoop the frame loop that submitted the task.
     * @param priority the task's priority.
     */
-   explicit UpdateTask(const int priority = 0);
+   explicit UpdateTask(FrameLoop& frameLoop, const int priority = 0);
    /**
-    * @see QRunnable::run.
+    * An update is superseded by a newer one, which applies all pending changes.
+    * @see Task::isSupersededBy.
     */
-   void run() override final;
+   bool isSupersededBy(const Task& task) const override;
 private:
    /**
-    * Update a scene object's properties.
-    * @param object the scene object to update.
+    * @see Task::execute.
+    */
+   void execute() override final;
+   /**
+    * @see Task::onCancelled.
+    */
+   void onCancelled() override final;
+   /**
+    * The frame loop that submitted the task.
     */
-   void update(clockwork::scene::Object& object) const;
+   FrameLoop& _frameLoop;
 };
 
 } // namespace concurrency
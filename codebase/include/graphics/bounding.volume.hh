@@ -0,0 +1,178 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "point3.hh"
+#include "matrix4.hh"
+#include "ray.hh"
+#include <array>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * An axis-aligned bounding box.
+ */
+struct BoundingBox
+{
+   /**
+    * The box's minimum corner.
+    */
+   clockwork::Point3 minimum;
+   /**
+    * The box's maximum corner.
+    */
+   clockwork::Point3 maximum;
+   /**
+    * The default constructor creates an empty bounding box, i.e. a box that does not
+    * contain any point.
+    */
+   BoundingBox();
+   /**
+    * Instantiate a bounding box with given minimum and maximum corners.
+    * @param minimum the box's minimum corner.
+    * @param maximum the box's maximum corner.
+    */
+   BoundingBox(const clockwork::Point3& minimum, const clockwork::Point3& maximum);
+   /**
+    * Grow the box to contain a given point.
+    * @param point the point to contain.
+    */
+   void extend(const clockwork::Point3& point);
+   /**
+    * Grow the box to contain another box.
+    * @param box the box to contain.
+    */
+   void extend(const BoundingBox& box);
+   /**
+    * Return true if the box does not contain any point, false otherwise.
+    */
+   bool isEmpty() const;
+   /**
+    * Return the box's center.
+    */
+   clockwork::Point3 getCenter() const;
+   /**
+    * Return the box's surface area.
+    */
+   double getSurfaceArea() const;
+   /**
+    * Return true if this box contains another box, false otherwise.
+    * @param box the box to test.
+    */
+   bool contains(const BoundingBox& box) const;
+   /**
+    * Return true if this box intersects another box, false otherwise.
+    * @param box the box to test.
+    */
+   bool intersects(const BoundingBox& box) const;
+   /**
+    * Return true if a ray intersects this box within a given distance interval, false otherwise.
+    * If the ray intersects the box, the interval is narrowed down to the distances at which
+    * the ray enters and exits the box.
+    * @param ray the ray to test.
+    * @param minimumDistance the distance from which the ray is tested.
+    * @param maximumDistance the distance up to which the ray is tested.
+    */
+   bool intersects(const Ray& ray, double& minimumDistance, double& maximumDistance) const;
+   /**
+    * Return the axis-aligned box that contains a given box after it is transformed.
+    * @param box the box to transform.
+    * @param transform the transformation to apply.
+    */
+   static BoundingBox transform(const BoundingBox& box, const clockwork::Matrix4& transform);
+};
+
+/**
+ * A bounding sphere.
+ */
+struct BoundingSphere
+{
+   /**
+    * The sphere's center.
+    */
+   clockwork::Point3 center;
+   /**
+    * The sphere's radius.
+    */
+   double radius;
+   /**
+    * Instantiate a bounding sphere with a given center and radius.
+    * @param center the sphere's center.
+    * @param radius the sphere's radius.
+    */
+   BoundingSphere(const clockwork::Point3& center = clockwork::Point3(), const double& radius = 0);
+   /**
+    * Return the sphere that contains a given sphere after it is transformed.
+    * @param sphere the sphere to transform.
+    * @param transform the transformation to apply.
+    */
+   static BoundingSphere transform(const BoundingSphere& sphere, const clockwork::Matrix4& transform);
+};
+
+/**
+ * A convex volume bounded by six planes, typically a viewer's view frustum.
+ */
+struct BoundingFrustum
+{
+   /**
+    * The result of a containment test.
+    */
+   enum class Containment
+   {
+      Outside,
+      Intersecting,
+      Inside
+   };
+   /**
+    * The frustum's left, right, bottom, top, near and far planes. Each plane is stored
+    * as the coefficients (a, b, c, d) of the equation ax + by + cz + d = 0, where the
+    * normal (a, b, c) points into the frustum.
+    */
+   std::array<std::array<double, 4>, 6> planes;
+   /**
+    * Instantiate the frustum that contains every point that a given transformation
+    * maps into the canonical view volume.
+    * @param transform the transformation, typically a view-projection matrix.
+    */
+   explicit BoundingFrustum(const clockwork::Matrix4& transform);
+   /**
+    * Return whether a box is outside, partially inside or completely inside the frustum.
+    * The test is conservative: some boxes that are outside the frustum may be reported
+    * as intersecting it.
+    * @param box the box to test.
+    */
+   Containment contains(const BoundingBox& box) const;
+};
+
+/**
+ * Return the largest factor by which a transformation scales lengths, i.e. the length
+ * of the longest of its basis vectors.
+ * @param transform the transformation.
+ */
+double getMaximumScale(const clockwork::Matrix4& transform);
+
+} // namespace graphics
+} // namespace clockwork
@@ -31,7 +31,9 @@ namespace clockwork {
 namespace graphics {
 
 /**
- * TODO Explain me.
+ * A face is a triangle's vertex indices and per-corner attributes, as described by a
+ * model file. Faces are only used to import mesh data: a Model3D welds them into shared
+ * vertex arrays and an index buffer.
  */
 class Face
 {
@@ -48,6 +50,21 @@ public:
       const std::array<const clockwork::Vector3, 3>& normals,
       const std::array<const Texture::Coordinates, 3>& textureCoordinates
    );
+   /**
+    * Instantiate a face with a given list of vertex indices, normals, texture mapping coordinates
+    * and tangents.
+    * @param indices the list of vertices that make up this face.
+    * @param normals the face's vertex normals.
+    * @param texcoords the face's texture mapping coordinates.
+    * @param tangents the face's vertex tangents.
+    */
+   Face
+   (
+      const std::array<const uint32_t, 3>& indices,
+      const std::array<const clockwork::Vector3, 3>& normals,
+      const std::array<const Texture::Coordinates, 3>& textureCoordinates,
+      const std::array<const Tangent, 3>& tangents
+   );
    /**
     * Instantiate a face with a given list of vertex indices.
     * @param indices the face's vertices.
@@ -65,6 +82,10 @@ public:
     * Return the face's texture coordinates.
     */
    const std::array<const Texture::Coordinates, 3>& getTextureMappingCoordinates() const;
+   /**
+    * Return the face's vertex tangents.
+    */
+   const std::array<const Tangent, 3>& getTangents() const;
 private:
    /**
     * The face's vertex indices.
@@ -78,6 +99,10 @@ private:
     * The texture mapping coordinates.
     */
    const std::array<const Texture::Coordinates, 3> _textureMappingCoordinates;
+   /**
+    * The vertex tangents.
+    */
+   const std::array<const Tangent, 3> _tangents;
 };
 
 } // namespace graphics
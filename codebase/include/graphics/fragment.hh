@@ -51,6 +51,10 @@ public:
     * The fragment's normal vector.
     */
    clockwork::Vector3 normal;
+   /**
+    * The fragment's tangent.
+    */
+   Tangent tangent;
    /**
     * The fragment's texture mapping coordinates.
     */
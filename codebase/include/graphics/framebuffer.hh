@@ -25,10 +25,13 @@
 
 #include <QObject>
 #include <QImage>
+#include <QMutex>
+#include <QRegion>
 #include <cstdint>
 #include <atomic>
 #include <functional>
 #include "fragment.hh"
+#include "pipeline.statistics.hh"
 
 
 namespace clockwork {
@@ -142,6 +145,35 @@ public:
     * Clear the framebuffer.
     */
    void clear();
+   /**
+    * Clear the part of the framebuffer that lies in the given rectangle.
+    * @param rectangle the rectangle to clear.
+    */
+   void clear(const QRect& rectangle);
+   /**
+    * Return the clip rectangle. Fragments outside of this rectangle are never written.
+    */
+   const QRect& getClipRectangle() const;
+   /**
+    * Set the clip rectangle. The rectangle is clamped to the framebuffer's bounds.
+    * @param rectangle the clip rectangle to set.
+    */
+   void setClipRectangle(const QRect& rectangle);
+   /**
+    * Reset the clip rectangle to the framebuffer's bounds.
+    */
+   void resetClipRectangle();
+   /**
+    * Mark a region of the framebuffer as damaged, i.e. changed since the frame was last
+    * presented. The damage accumulates until it is taken by the display device.
+    * @param region the damaged region.
+    */
+   void addDamagedRegion(const QRegion& region);
+   /**
+    * Return the region that has been damaged since the last call to this function, and
+    * reset it. This is safe to call while the framebuffer is being rendered to.
+    */
+   QRegion takeDamagedRegion();
    /**
     * Resize the framebuffer.
     * @param resolution the framebuffer's new resolution.
@@ -154,6 +186,12 @@ public:
     * @param y the framebuffer element's column position.
     */
    void discard(const uint32_t& x, const uint32_t& y);
+   /**
+    * Set the pipeline statistics that the fragments written to the framebuffer are
+    * counted in, or nullptr to stop counting them.
+    * @param statistics the pipeline statistics to update.
+    */
+   void setStatistics(clockwork::graphics::PipelineStatistics* const statistics);
    /**
     * Return all available framebuffer resolutions.
     */
@@ -214,6 +252,23 @@ private:
     * A flag to make the framebuffer writable or readable-only.
     */
    std::atomic<bool> _ignoreWrites;
+   /**
+    * The rectangle outside of which fragments are discarded.
+    */
+   QRect _clipRectangle;
+   /**
+    * The region damaged since the display device last presented the framebuffer.
+    */
+   QRegion _damagedRegion;
+   /**
+    * The mutex that guards the damaged region, which is written by the renderer and
+    * taken by the display device.
+    */
+   QMutex _damagedRegionMutex;
+   /**
+    * The pipeline statistics that fragments are counted in, if any.
+    */
+   clockwork::graphics::PipelineStatistics* _statistics;
    /**
     * Test if a given fragment passes all fragment tests. It will return the
     * fragment's buffer offset if the fragment passes all tests, otherwise -1.
@@ -230,6 +285,11 @@ signals:
     * be drawn to the display device.
     */
    void frameReady();
+   /**
+    * This signal is emitted when the framebuffer has been resized, after which its
+    * contents have been cleared.
+    */
+   void resized();
 };
 
 } // namespace graphics
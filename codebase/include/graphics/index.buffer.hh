@@ -0,0 +1,102 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * An index buffer is a list of vertex indices. To save memory, indices are stored
+ * as 16-bit integers when every vertex can be addressed with 16 bits, and as 32-bit
+ * integers otherwise.
+ */
+class IndexBuffer
+{
+public:
+   /**
+    * Available index types.
+    */
+   enum class Type
+   {
+      UInt16,
+      UInt32
+   };
+   /**
+    * The default constructor creates an empty 16-bit index buffer.
+    */
+   IndexBuffer();
+   /**
+    * Instantiate an index buffer with a given set of indices.
+    * @param indices the indices to store.
+    * @param vertexCount the number of vertices that the indices may refer to, which
+    * determines the index type.
+    */
+   IndexBuffer(const std::vector<uint32_t>& indices, const std::size_t& vertexCount);
+   /**
+    * Return the index type.
+    */
+   Type getType() const;
+   /**
+    * Return the index at the given position in the buffer.
+    * @param i the index's position in the buffer.
+    */
+   uint32_t get(const std::size_t& i) const;
+   /**
+    * Return a copy of the indices as 32-bit integers.
+    */
+   std::vector<uint32_t> toVector() const;
+   /**
+    * Return the number of indices in the buffer.
+    */
+   std::size_t size() const;
+   /**
+    * Return the amount of memory (in bytes) occupied by the indices.
+    */
+   std::size_t getSizeInBytes() const;
+   /**
+    * Return true if the buffer does not contain any indices, false otherwise.
+    */
+   bool isEmpty() const;
+private:
+   /**
+    * The index type.
+    */
+   Type _type;
+   /**
+    * The 16-bit indices. This is empty if the index type is UInt32.
+    */
+   std::vector<uint16_t> _indices16;
+   /**
+    * The 32-bit indices. This is empty if the index type is UInt16.
+    */
+   std::vector<uint32_t> _indices32;
+};
+
+} // namespace graphics
+} // namespace clockwork
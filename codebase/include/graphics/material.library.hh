@@ -0,0 +1,76 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "resource.hh"
+#include "material.hh"
+#include <QHash>
+#include <QString>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * A material library is a named collection of materials that is parsed from a
+ * single material template library (.mtl) file, and shared by every 3D model that
+ * references the said file.
+ */
+class MaterialLibrary : public clockwork::system::Resource
+{
+public:
+   /**
+    * The default constructor.
+    */
+   MaterialLibrary();
+   /**
+    * Return the material with the given name, or nullptr if the library does not
+    * contain such a material.
+    * @param name the material's name.
+    */
+   const Material* getMaterial(const QString& name) const;
+   /**
+    * Add a named material to the library. If a material with the same name already
+    * exists, then it is replaced.
+    * @param name the material's name.
+    * @param material the material to add.
+    */
+   void addMaterial(const QString& name, const Material& material);
+   /**
+    * Return the number of materials in the library.
+    */
+   int getMaterialCount() const;
+   /**
+    * Return true if the library does not contain any materials, false otherwise.
+    */
+   bool isEmpty() const;
+private:
+   /**
+    * The material table where each material is identified by its name.
+    */
+   QHash<QString, Material> _materials;
+};
+
+} // namespace graphics
+} // namespace clockwork
@@ -0,0 +1,85 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * The size of the post-transform vertex cache that triangle orders are optimised for.
+ */
+constexpr std::size_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+/**
+ * Reorder a list of triangles to improve the locality of vertex references, using the
+ * Tipsify algorithm (Sander, Nehab and Barczak, 2007). The reordered triangles are also
+ * split into clusters that can be reordered without significantly degrading vertex
+ * locality, which is what optimizeOverdraw expects.
+ * @param indices the triangles' vertex indices, which are reordered in place.
+ * @param indexCount the number of indices, i.e. three times the number of triangles.
+ * @param vertexCount the number of vertices referenced by the indices.
+ * @param clusters the container where the index of each cluster's first triangle will be stored.
+ * @param cacheSize the size of the vertex cache.
+ */
+void optimizeVertexCache
+(
+   uint32_t* const indices,
+   const std::size_t& indexCount,
+   const std::size_t& vertexCount,
+   std::vector<std::size_t>& clusters,
+   const std::size_t& cacheSize = DEFAULT_VERTEX_CACHE_SIZE
+);
+/**
+ * Reorder clusters of triangles to reduce overdraw from any viewpoint. Clusters that
+ * face away from the mesh's centroid are likely to occlude other clusters, so they are
+ * drawn first.
+ * @param indices the triangles' vertex indices, which are reordered in place.
+ * @param indexCount the number of indices, i.e. three times the number of triangles.
+ * @param positions the vertex positions.
+ * @param clusters the index of each cluster's first triangle, in ascending order.
+ */
+void optimizeOverdraw
+(
+   uint32_t* const indices,
+   const std::size_t& indexCount,
+   const std::vector<std::array<float, 3>>& positions,
+   const std::vector<std::size_t>& clusters
+);
+/**
+ * Renumber vertices in the order in which they are first referenced, so that vertex
+ * attributes are fetched sequentially. Vertices that are not referenced are removed.
+ * @param indices the vertex indices to renumber.
+ * @param vertexCount the number of vertices.
+ * @return a table that maps each vertex's previous number to its new one, or to -1
+ * if the vertex is not referenced.
+ */
+std::vector<int64_t> optimizeVertexFetch(std::vector<uint32_t>& indices, const std::size_t& vertexCount);
+
+} // namespace graphics
+} // namespace clockwork
@@ -0,0 +1,59 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "model3d.hh"
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * Simplify a triangle mesh by collapsing edges in the order given by the quadric error
+ * metric (Garland and Heckbert, 1997), until the number of triangles reaches a target.
+ * Vertices are only collapsed onto other existing vertices so that the simplified mesh
+ * can share the original's vertex arrays. Vertices that lie on a mesh border, on a
+ * texture or normal seam, or between two submeshes are never moved, and collapses
+ * that would flip a triangle are rejected.
+ * @param positions the vertex positions.
+ * @param indices the triangles' vertex indices.
+ * @param submeshes the submeshes that partition the indices.
+ * @param targetTriangleCount the number of triangles to reduce the mesh to.
+ * @param outputIndices the container where the simplified mesh's indices will be stored.
+ * @param outputSubmeshes the container where the simplified mesh's submeshes will be stored.
+ * @return the simplified mesh's error, i.e. an estimate of the largest distance between
+ * the simplified and original surfaces.
+ */
+double simplifyMesh
+(
+   const std::vector<std::array<float, 3>>& positions,
+   const std::vector<uint32_t>& indices,
+   const std::vector<Model3D::Submesh>& submeshes,
+   const std::size_t& targetTriangleCount,
+   std::vector<uint32_t>& outputIndices,
+   std::vector<Model3D::Submesh>& outputSubmeshes
+);
+
+} // namespace graphics
+} // namespace clockwork
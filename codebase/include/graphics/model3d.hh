@@ -26,68 +26,249 @@
 #include "resource.hh"
 #include "face.hh"
 #include "material.hh"
+#include "index.buffer.hh"
+#include "bounding.volume.hh"
+#include "triangle.hierarchy.hh"
 #include <vector>
+#include <array>
+#include <memory>
 
 
 namespace clockwork {
 namespace graphics {
 
+/**
+ * A 3D model is an indexed triangle mesh. Vertex attributes are stored in separate,
+ * single-precision arrays where each vertex (a unique combination of position, normal,
+ * texture mapping coordinates and tangent) appears only once, and triangles refer to
+ * vertices through an index buffer.
+ */
 class Model3D : public clockwork::system::Resource
 {
 public:
+   /**
+    * A submesh is a contiguous range of indices that share the same material. Faces
+    * are grouped by material when a model is loaded so that a renderer only needs
+    * to set up its material state once per submesh, rather than once per face.
+    */
+   struct Submesh
+   {
+      /**
+       * Instantiate a submesh that covers a given range of indices.
+       * @param offset the position of the submesh's first index in the index buffer.
+       * @param count the number of indices in the submesh.
+       * @param material the material shared by every face in the submesh.
+       */
+      Submesh(const uint32_t offset, const uint32_t count, const Material& material);
+      /**
+       * The position of the submesh's first index in the index buffer.
+       */
+      uint32_t offset;
+      /**
+       * The number of indices in the submesh, i.e. three times its number of triangles.
+       */
+      uint32_t count;
+      /**
+       * The material shared by every face in the submesh.
+       */
+      Material material;
+   };
+   /**
+    * A level of detail is a simplified version of the model's triangles. Every level
+    * shares the model's vertex arrays but has its own index buffer and submeshes, where
+    * each submesh uses the same material as its counterpart in the first level.
+    */
+   struct LevelOfDetail
+   {
+      /**
+       * Instantiate a level of detail.
+       * @param indices the level's index buffer.
+       * @param submeshes the level's submeshes.
+       * @param error the largest distance (in object space) between the level's surface
+       * and the model's original surface.
+       */
+      LevelOfDetail(const IndexBuffer& indices, const std::vector<Submesh>& submeshes, const double& error);
+      /**
+       * The level's index buffer.
+       */
+      IndexBuffer indices;
+      /**
+       * The level's submeshes.
+       */
+      std::vector<Submesh> submeshes;
+      /**
+       * The largest distance (in object space) between the level's surface and the model's
+       * original surface.
+       */
+      double error;
+   };
    /**
     * The default constructor.
     */
    Model3D();
    /**
     * Instantiate a 3D model with a given set of vertex positions, triangular polygonal faces,
-    * and a material.
+    * and a material. The resulting model is made up of a single submesh.
     * @param positions the model's vertex position data.
     * @param faces the model's polygonal face data.
     * @param material the model's material data.
     */
    Model3D(const std::vector<clockwork::Point3>& positions, const std::vector<Face>& faces, const Material& material);
    /**
-    * Return the model's vertex position data.
+    * Return the vertex positions.
+    */
+   const std::vector<std::array<float, 3>>& getPositions() const;
+   /**
+    * Return the vertex normals.
+    */
+   const std::vector<std::array<float, 3>>& getNormals() const;
+   /**
+    * Return the vertex texture mapping coordinates.
+    */
+   const std::vector<std::array<float, 2>>& getTextureMappingCoordinates() const;
+   /**
+    * Return the vertex tangents, where the fourth component is the tangent space's handedness.
+    */
+   const std::vector<std::array<float, 4>>& getTangents() const;
+   /**
+    * Return the index buffer, where every three consecutive indices form a triangle.
+    * @param level the level of detail, where 0 is the original mesh.
     */
-   const std::vector<clockwork::Point3>& getVertexPositions() const;
+   const IndexBuffer& getIndices(const std::size_t& level = 0) const;
    /**
-    * Return the model's triangular polygonal face data.
+    * Return the model's submeshes, i.e. its triangles grouped by material.
+    * @param level the level of detail, where 0 is the original mesh.
     */
-   const std::vector<Face>& getFaces() const;
+   const std::vector<Submesh>& getSubmeshes(const std::size_t& level = 0) const;
    /**
-    * Add a polygonal face.
-    * @param indices the face's index list.
-    * @param indices the face's vertex normals.
-    * @param textureMappingCoordinates the face's texture mapping coordinates.
+    * Return the number of unique vertices.
     */
-   void addFace
+   std::size_t getVertexCount() const;
+   /**
+    * Return the number of triangles.
+    * @param level the level of detail, where 0 is the original mesh.
+    */
+   std::size_t getTriangleCount(const std::size_t& level = 0) const;
+   /**
+    * Return the levels of detail, ordered from the original mesh (level 0) to the coarsest.
+    */
+   const std::vector<LevelOfDetail>& getLevelsOfDetail() const;
+   /**
+    * Add a level of detail that is coarser than the current coarsest level.
+    * @param indices the level's triangle indices.
+    * @param submeshes the level's submeshes.
+    * @param error the level's error.
+    */
+   void addLevelOfDetail(const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const double& error);
+   /**
+    * Generate a chain of levels of detail by repeatedly simplifying the coarsest level.
+    * Any previously generated levels are discarded.
+    * @param maximumLevelCount the maximum number of levels, including the original mesh.
+    * @param reduction the fraction of triangles that each level keeps from the previous one.
+    * @param minimumTriangleCount the number of triangles below which no more levels are generated.
+    */
+   void generateLevelsOfDetail
    (
-      const std::array<const uint32_t, 3>& indices,
-      const std::array<const clockwork::Vector3, 3>& normals,
-      const std::array<const Texture::Coordinates, 3>& textureMappingCoordinates
+      const std::size_t& maximumLevelCount = 6,
+      const double& reduction = 0.5,
+      const std::size_t& minimumTriangleCount = 64
    );
    /**
-    * Return the model's material data.
+    * Return the model's bounding box, in object space.
+    */
+   const BoundingBox& getBoundingBox() const;
+   /**
+    * Return the model's bounding sphere, in object space.
+    */
+   const BoundingSphere& getBoundingSphere() const;
+   /**
+    * Return the hierarchy over the model's triangles that is used for ray casting.
+    * The hierarchy is built the first time it is requested.
     */
-   const Material& getMaterial() const;
+   const TriangleHierarchy& getTriangleHierarchy() const;
+   /**
+    * Set the model's mesh data. The faces' vertices are welded so that identical vertices
+    * are only stored once, and the order of the faces is preserved. Note that the faces
+    * must be ordered so that each submesh refers to a contiguous range of faces.
+    * @param positions the model's vertex position data.
+    * @param faces the model's polygonal face data.
+    * @param submeshes the model's submeshes, where the offset and count of each submesh
+    * are expressed in indices, i.e. three per face.
+    */
+   void setMesh
+   (
+      const std::vector<clockwork::Point3>& positions,
+      const std::vector<Face>& faces,
+      const std::vector<Submesh>& submeshes
+   );
+   /**
+    * Set the model's mesh data from attribute arrays that have already been welded.
+    * @param positions the vertex positions.
+    * @param normals the vertex normals.
+    * @param texcoords the vertex texture mapping coordinates.
+    * @param tangents the vertex tangents and their handedness.
+    * @param indices the triangle indices.
+    * @param submeshes the model's submeshes, where the offset and count of each submesh
+    * are expressed in indices.
+    */
+   void setMesh
+   (
+      const std::vector<std::array<float, 3>>& positions,
+      const std::vector<std::array<float, 3>>& normals,
+      const std::vector<std::array<float, 2>>& texcoords,
+      const std::vector<std::array<float, 4>>& tangents,
+      const std::vector<uint32_t>& indices,
+      const std::vector<Submesh>& submeshes
+   );
+   /**
+    * Reorder the triangles in each submesh of each level of detail to improve vertex cache
+    * locality and reduce overdraw, then renumber the vertices in the order in which they
+    * are first used by the original mesh. The submeshes' ranges are left unchanged.
+    */
+   void optimize();
    /**
     * Return true if this container does not have any vertices or faces, false otherwise.
     */
    bool isEmpty() const;
 private:
    /**
-    * The 3D model's vertex positions.
+    * The vertex positions.
+    */
+   std::vector<std::array<float, 3>> _positions;
+   /**
+    * The vertex normals.
+    */
+   std::vector<std::array<float, 3>> _normals;
+   /**
+    * The vertex texture mapping coordinates.
+    */
+   std::vector<std::array<float, 2>> _texcoords;
+   /**
+    * The vertex tangents and their handedness.
+    */
+   std::vector<std::array<float, 4>> _tangents;
+   /**
+    * The levels of detail, where the first level is the original mesh.
+    */
+   std::vector<LevelOfDetail> _levelsOfDetail;
+   /**
+    * The model's bounding box.
+    */
+   BoundingBox _boundingBox;
+   /**
+    * The model's bounding sphere.
     */
-   std::vector<clockwork::Point3> _positions;
+   BoundingSphere _boundingSphere;
    /**
-    * The 3D model's polygonal face data.
+    * The hierarchy over the model's triangles, or nullptr if it has not been built yet.
+    * Since it is immutable once built, it is shared by copies of the model.
     */
-   std::vector<Face> _faces;
+   mutable std::shared_ptr<const TriangleHierarchy> _triangleHierarchy;
    /**
-    * The 3D model's material data.
+    * Calculate the model's bounding volumes from its vertex positions, and discard
+    * the triangle hierarchy.
     */
-   Material _material;
+   void updateBoundingVolumes();
 };
 
 } // namespace graphics
@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "point4.hh"
+#include "matrix4.hh"
+#include "bounding.volume.hh"
+#include <vector>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * @see model3d.hh.
+ */
+class Model3D;
+
+/**
+ * An OcclusionBuffer is a low-resolution depth buffer that is filled with a few large
+ * occluders before a viewer's scene is rendered. Objects and primitives whose bounds are
+ * completely behind the occluders can then be discarded before they are rasterised.
+ * The buffer is conservative: a texel is only written if it is entirely covered by an
+ * occluder, and it holds the occluder's farthest depth, so visible geometry is never culled.
+ * Depths are stored in normalised device coordinates, where smaller values are nearer.
+ */
+class OcclusionBuffer
+{
+public:
+   /**
+    * The buffer's width, in texels.
+    */
+   static constexpr uint32_t WIDTH = 256;
+   /**
+    * The buffer's height, in texels.
+    */
+   static constexpr uint32_t HEIGHT = 128;
+   /**
+    * Instantiate an empty occlusion buffer.
+    */
+   OcclusionBuffer();
+   /**
+    * Remove all occluders from the buffer.
+    */
+   void clear();
+   /**
+    * Return true if no occluder has been rasterised since the buffer was last cleared.
+    */
+   bool isEmpty() const;
+   /**
+    * Rasterise a 3D model's triangles into the buffer.
+    * @param model3D the model.
+    * @param transform the model-view-projection transformation matrix.
+    */
+   void addOccluder(const Model3D& model3D, const clockwork::Matrix4& transform);
+   /**
+    * Rasterise a triangle into the buffer. Triangles that cross the near plane are ignored.
+    * @param v0 the triangle's first vertex, in clip space.
+    * @param v1 the triangle's second vertex, in clip space.
+    * @param v2 the triangle's third vertex, in clip space.
+    */
+   void addOccluder(const clockwork::Point4& v0, const clockwork::Point4& v1, const clockwork::Point4& v2);
+   /**
+    * Returns true if any part of a box may be visible, false if the box is completely occluded.
+    * @param box the box, in world space.
+    * @param transform the view-projection transformation matrix.
+    */
+   bool isVisible(const BoundingBox& box, const clockwork::Matrix4& transform) const;
+   /**
+    * Returns true if any part of a set of points' screen-space bounds may be visible, false
+    * if the bounds are completely occluded.
+    * @param points the points, in clip space.
+    * @param count the number of points.
+    */
+   bool isVisible(const clockwork::Point4* const points, const std::size_t& count) const;
+   /**
+    * Returns true if any part of a rectangle at a given depth may be visible, false if the
+    * rectangle is completely occluded.
+    * @param xmin the rectangle's left edge, in normalised device coordinates.
+    * @param ymin the rectangle's bottom edge, in normalised device coordinates.
+    * @param xmax the rectangle's right edge, in normalised device coordinates.
+    * @param ymax the rectangle's top edge, in normalised device coordinates.
+    * @param depth the rectangle's nearest depth, in normalised device coordinates.
+    */
+   bool isVisible(const double& xmin, const double& ymin, const double& xmax, const double& ymax, const double& depth) const;
+private:
+   /**
+    * The depth of each texel. Texels that are not covered by an occluder hold infinity.
+    */
+   std::vector<float> _depths;
+   /**
+    * True if no occluder has been rasterised since the buffer was last cleared.
+    */
+   bool _isEmpty;
+};
+
+} // namespace graphics
+} // namespace clockwork
@@ -0,0 +1,93 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <cstdint>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * PipelineStatistics count the work done by each stage of the render pipeline, in the
+ * spirit of OpenGL's pipeline statistics queries. They are gathered for each object
+ * that is drawn in a frame, and summed over the frame.
+ */
+struct PipelineStatistics
+{
+   /**
+    * The number of vertices that were submitted to the vertex stage.
+    */
+   uint64_t verticesIn = 0;
+   /**
+    * The number of submitted vertices that were found in the vertex cache, and so
+    * weren't processed by the vertex program again.
+    */
+   uint64_t vertexCacheHits = 0;
+   /**
+    * The number of primitives that were assembled.
+    */
+   uint64_t primitivesAssembled = 0;
+   /**
+    * The number of primitives that were culled because they face away from the viewer.
+    */
+   uint64_t backfaceCulled = 0;
+   /**
+    * The number of primitives that were culled because they lie outside the view frustum.
+    */
+   uint64_t frustumCulled = 0;
+   /**
+    * The number of primitives that were culled because they are hidden behind occluders.
+    * An object that is occluded as a whole counts all of its triangles.
+    */
+   uint64_t occlusionCulled = 0;
+   /**
+    * The number of primitives that were removed by clipping.
+    */
+   uint64_t primitivesClipped = 0;
+   /**
+    * The number of fragments that were generated by the rasteriser.
+    */
+   uint64_t fragmentsGenerated = 0;
+   /**
+    * The number of fragments that failed the depth test.
+    */
+   uint64_t fragmentsDepthRejected = 0;
+   /**
+    * The number of fragments that were processed by the fragment program.
+    */
+   uint64_t fragmentsShaded = 0;
+   /**
+    * The number of fragments that were written to the framebuffer.
+    */
+   uint64_t fragmentsWritten = 0;
+   /**
+    * Add the counters of another set of statistics to these.
+    * @param statistics the statistics to add.
+    */
+   PipelineStatistics& operator+=(const PipelineStatistics& statistics);
+};
+
+} // namespace graphics
+} // namespace clockwork
@@ -0,0 +1,65 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "point3.hh"
+#include "vector3.hh"
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * A half-line that starts at an origin and extends infinitely in a given direction.
+ */
+struct Ray
+{
+   /**
+    * The ray's origin.
+    */
+   clockwork::Point3 origin;
+   /**
+    * The ray's normalised direction.
+    */
+   clockwork::Vector3 direction;
+   /**
+    * The reciprocal of each of the direction's components. This is precalculated since
+    * ray-box intersection tests use it to avoid divisions.
+    */
+   clockwork::Vector3 inverseDirection;
+   /**
+    * Instantiate a ray with a given origin and direction.
+    * @param origin the ray's origin.
+    * @param direction the ray's direction. It does not need to be normalised.
+    */
+   Ray(const clockwork::Point3& origin, const clockwork::Vector3& direction);
+   /**
+    * Return the point at a given distance along the ray.
+    * @param distance the distance from the ray's origin.
+    */
+   clockwork::Point3 getPoint(const double& distance) const;
+};
+
+} // namespace graphics
+} // namespace clockwork
@@ -41,6 +41,19 @@ class BumpMapRenderAlgorithm : public PolygonRenderAlgorithm
 {
 friend class RenderAlgorithmFactory;
 public:
+   /**
+    * This implementation of the vertex program transforms the vertex's normal and tangent
+    * into view space, which is where the tangent space basis is rebuilt for each fragment.
+    * @see RenderAlgorithm::vertexProgram.
+    */
+   Vertex vertexProgram
+   (
+      const RenderAlgorithm::Parameters&,
+      const clockwork::Point3& position,
+      const clockwork::Vector3& normal,
+      const Tangent& tangent,
+      const Texture::Coordinates&
+   ) const override final;
 private:
    /**
     * The BumpMapRenderAlgorithm is a singleton, and only instantiable by the RenderAlgorithmFactory.
@@ -49,6 +49,7 @@ public:
       const RenderAlgorithm::Parameters&,
       const clockwork::Point3& position,
       const clockwork::Vector3& normal,
+      const Tangent&,
       const Texture::Coordinates&
    ) const override final;
    /**
@@ -45,6 +45,11 @@ public:
     * @see RenderAlgorithm::primitiveAssembly.
     */
    VertexArray& primitiveAssembly(const clockwork::graphics::PrimitiveMode&, VertexArray&) const override final;
+   /**
+    * Points are made up of a single vertex.
+    * @see RenderAlgorithm::getPrimitiveVertexCount.
+    */
+   std::size_t getPrimitiveVertexCount() const override final;
    /**
     * Perform point clipping on a collection of vertices.
     * @param vertices the vertices to clip.
@@ -39,6 +39,11 @@ public:
     * @see RenderAlgorithm::primitiveAssembly.
     */
    VertexArray& primitiveAssembly(const clockwork::graphics::PrimitiveMode&, VertexArray&) const override final;
+   /**
+    * Polygons are assembled into triangles.
+    * @see RenderAlgorithm::getPrimitiveVertexCount.
+    */
+   std::size_t getPrimitiveVertexCount() const override final;
    /**
     * Perform polygon clipping (Sutherland-Hodgman) on a collection of vertices.
     * @param vertices the vertices to clip.
@@ -48,6 +53,12 @@ public:
     * @see RenderAlgorithm::backfaceCulling.
     */
    VertexArray& backfaceCulling(VertexArray&) const override final;
+   /**
+    * Remove the triangles whose screen-space bounds are completely hidden behind the
+    * occluders in the graphics subsystem's occlusion buffer.
+    * @see RenderAlgorithm::occlusionCulling.
+    */
+   VertexArray& occlusionCulling(VertexArray&) const override final;
    /**
     * Rasterise triangle primitives using polygon scan conversion, under a given set of render parameters.
     * @see RenderAlgorithm::rasterise.
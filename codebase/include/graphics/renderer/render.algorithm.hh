@@ -28,14 +28,16 @@
 #include "factory.hh"
 #include "matrix4.hh"
 #include "model3d.hh"
+#include "pipeline.statistics.hh"
 #include "viewport.hh"
 #include <functional>
+#include <vector>
 
 
 /**
- * @see scene.object.hh and scene.viewer.hh.
+ * @see scene.object.hh, scene.viewer.hh and scene.snapshot.hh.
  */
-namespace clockwork { namespace scene { class Object; class Viewer; } }
+namespace clockwork { namespace scene { class Object; class Viewer; struct ObjectSnapshot; struct ViewerSnapshot; } }
 
 namespace clockwork {
 namespace graphics {
@@ -83,39 +85,99 @@ public:
          const clockwork::graphics::Model3D&,
          const clockwork::graphics::Material&,
          const clockwork::Matrix4& MODEL,
-         clockwork::scene::Viewer&
+         const clockwork::scene::ViewerSnapshot&
       );
+      /**
+       * Instantiate a copy of a given set of render parameters that uses a different material.
+       * @param parameters the render parameters to copy.
+       * @param material the material to use.
+       */
+      Parameters(const Parameters& parameters, const clockwork::graphics::Material& material);
       // TODO Uncomment and fix!
 //      Parameters(const Parameters&) = delete;
       Parameters& operator=(const Parameters&) = delete;
    public:
+      // The model and materials are resources that outlive a frame. The transforms and
+      // viewer state are copied, so that the parameters remain valid after the scene
+      // has been updated for the next frame.
       const Model3D& model3D;
       const Material& material;
-      const clockwork::Point3& viewpoint;
-      const clockwork::graphics::Viewport& viewport;
+      const clockwork::Point3 viewpoint;
+      const clockwork::graphics::Viewport viewport;
 
       const clockwork::graphics::PrimitiveMode& primitiveMode;
       const clockwork::graphics::LineAlgorithm& lineAlgorithm;
 
-      const clockwork::Matrix4& MODEL;
-      const clockwork::Matrix4  INVERSE_MODEL;
-      const clockwork::Matrix4& VIEW;
-      const clockwork::Matrix4  MODELVIEW;
-      const clockwork::Matrix4& PROJECTION;
-      const clockwork::Matrix4& VIEWPROJECTION;
-      const clockwork::Matrix4  MODELVIEWPROJECTION;
-      const clockwork::Matrix4  NORMAL;
+      const clockwork::Matrix4 MODEL;
+      const clockwork::Matrix4 INVERSE_MODEL;
+      const clockwork::Matrix4 VIEW;
+      const clockwork::Matrix4 MODELVIEW;
+      const clockwork::Matrix4 PROJECTION;
+      const clockwork::Matrix4 VIEWPROJECTION;
+      const clockwork::Matrix4 MODELVIEWPROJECTION;
+      const clockwork::Matrix4 NORMAL;
+   };
+   /**
+    * A draw command holds primitives that have been through the geometry stages of a
+    * render algorithm (vertex program, primitive assembly, culling, clipping and viewport
+    * transform), and only need to be rasterised. Since it doesn't refer to the scene, it
+    * can be rasterised while the scene is updated for the next frame.
+    */
+   struct DrawCommand
+   {
+      /**
+       * The render algorithm that rasterises the primitives.
+       */
+      const RenderAlgorithm* algorithm;
+      /**
+       * The scene object that the primitives belong to. This is only used as a key, to
+       * attribute the work done by the raster stages to the object, and is never read.
+       */
+      const clockwork::scene::Object* object;
+      /**
+       * The render parameters.
+       */
+      RenderAlgorithm::Parameters parameters;
+      /**
+       * The primitives' vertices, in window coordinates.
+       */
+      VertexArray vertices;
    };
    /**
     * Return the algorithm's identifier.
     */
    const RenderAlgorithm::Identifier& getIdentifier() const;
    /**
-    * Apply this algorithm to a scene object that is observed by a given viewer.
+    * Apply this algorithm to a scene object that is observed by a given viewer. This
+    * processes and rasterises the object immediately.
     * @param object the scene object to render.
     * @param viewer the viewer from which the object is being observed.
     */
    void apply(clockwork::scene::Object& object, clockwork::scene::Viewer& viewer) const;
+   /**
+    * Run the geometry stages of this algorithm on a snapshot of a scene object that is
+    * observed by a given viewer, and append the resulting draw commands to a list. This
+    * only reads the snapshots, and never touches the scene.
+    * @param object the snapshot of the scene object to process.
+    * @param viewer the snapshot of the viewer from which the object is being observed.
+    * @param levelOfDetail the level of detail that was last selected for the object and
+    * viewer, which is replaced by the level that is selected for this frame.
+    * @param commands the list that the draw commands are appended to.
+    * @param statistics the pipeline statistics that the geometry stages' work is added to.
+    */
+   void process
+   (
+      const clockwork::scene::ObjectSnapshot& object,
+      const clockwork::scene::ViewerSnapshot& viewer,
+      std::size_t& levelOfDetail,
+      std::vector<RenderAlgorithm::DrawCommand>& commands,
+      PipelineStatistics& statistics
+   ) const;
+   /**
+    * Rasterise a draw command that was created by this algorithm.
+    * @param command the draw command to rasterise.
+    */
+   void draw(const RenderAlgorithm::DrawCommand& command) const;
 protected:
    /**
     * Instantiate a render algorithm with a given identifier.
@@ -127,6 +189,7 @@ protected:
     * @param parameters the render parameters.
     * @param position the vertex's position in object space.
     * @param normal the vertex's normal in object space.
+    * @param tangent the vertex's tangent in object space.
     * @param uvmap the vertex's texture mapping coordinates.
     */
    virtual Vertex vertexProgram
@@ -134,23 +197,64 @@ protected:
       const RenderAlgorithm::Parameters& parameters,
       const clockwork::Point3& position,
       const clockwork::Vector3& normal,
+      const Tangent& tangent,
       const Texture::Coordinates& uvmap
    ) const;
    /**
     * TODO Explain me.
     */
    virtual VertexArray& primitiveAssembly(const clockwork::graphics::PrimitiveMode&, VertexArray&) const = 0;
+   /**
+    * Return the number of vertices that make up each of the primitives that are created
+    * by the primitive assembly.
+    */
+   virtual std::size_t getPrimitiveVertexCount() const = 0;
+   /**
+    * The largest error (in pixels) that a level of detail may have on the screen to be selected.
+    */
+   static constexpr double LEVEL_OF_DETAIL_THRESHOLD = 1.0;
+   /**
+    * The fraction of the threshold by which a level of detail's projected error must
+    * change before a different level is selected. This prevents the levels of detail
+    * from popping back and forth when an object hovers around a switching distance.
+    */
+   static constexpr double LEVEL_OF_DETAIL_HYSTERESIS = 0.25;
+   /**
+    * Select the coarsest level of detail whose error, projected onto the viewer's screen,
+    * is below the level of detail threshold. The current level is only changed when the
+    * projected error crosses the threshold by a margin.
+    * @param last the level of detail that was last selected.
+    * @param parameters the render parameters.
+    */
+   std::size_t selectLevelOfDetail(const std::size_t& last, const RenderAlgorithm::Parameters& parameters) const;
+   /**
+    * Assemble, cull and clip a set of vertices that have been processed by the vertex
+    * program and share the same render parameters, then convert them into window
+    * coordinates. Returns false if no primitives remain to be rasterised.
+    * @param parameters the render parameters.
+    * @param vertices the vertices to prepare.
+    * @param statistics the pipeline statistics that the number of primitives that were
+    * assembled, culled and clipped is added to.
+    */
+   bool prepare(const RenderAlgorithm::Parameters& parameters, VertexArray& vertices, PipelineStatistics& statistics) const;
    /**
     * Perform backface culling to remove triangular primitives that are not facing the viewer,
     * i.e. surfaces that are not visible to the viewer.
     * @param vertices the vertices to cull.
     */
    virtual VertexArray& backfaceCulling(VertexArray& vertices) const;
+   /**
+    * Remove the primitives that lie completely outside the view frustum, i.e. whose
+    * vertices are all outside the same clipping plane. The remaining primitives may
+    * still straddle the frustum, and are left to the clipper.
+    * @param vertices the vertices to cull, in clip space.
+    */
+   VertexArray& frustumCulling(VertexArray& vertices) const;
    /**
     * Perform occlusion culling to remove primitives that are occluded from the viewer by other primitives.
     * @param vertices the vertices to cull.
     */
-   VertexArray& occlusionCulling(VertexArray& vertices) const;
+   virtual VertexArray& occlusionCulling(VertexArray& vertices) const;
    /**
     * TODO Explain me.
     */
@@ -0,0 +1,85 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "point3.hh"
+#include "vector3.hh"
+#include "vertex.hh"
+#include <vector>
+#include <array>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * The default crease angle (60 degrees, in radians). Adjacent faces that meet at a
+ * larger angle do not share vertex normals, which keeps hard edges sharp.
+ */
+constexpr double DEFAULT_CREASE_ANGLE = 1.0471975511965976;
+/**
+ * A triangle's vertex indices.
+ */
+using TriangleIndices = std::array<uint32_t, 3>;
+/**
+ * Compute smooth vertex normals for each corner of a set of triangles. A corner's
+ * normal is the area-weighted average of the normals of the faces that share its
+ * vertex, excluding faces that meet the corner's face at an angle larger than the
+ * crease angle. The work is distributed over the concurrency subsystem's threads.
+ * @param positions the vertex positions.
+ * @param triangles the triangles' vertex indices.
+ * @param normals the container where each triangle's corner normals will be stored.
+ * @param creaseAngle the largest angle (in radians) at which two faces are smoothed.
+ */
+void computeVertexNormals
+(
+   const std::vector<clockwork::Point3>& positions,
+   const std::vector<TriangleIndices>& triangles,
+   std::vector<std::array<clockwork::Vector3, 3>>& normals,
+   const double& creaseAngle = DEFAULT_CREASE_ANGLE
+);
+/**
+ * Compute vertex tangents for each corner of a set of triangles, in the spirit of
+ * MikkTSpace: per-face tangents are derived from the texture mapping coordinates,
+ * accumulated over corners that share the same vertex, normal, mapping coordinates
+ * and handedness, then orthogonalised against the corner's normal. The work is
+ * distributed over the concurrency subsystem's threads.
+ * @param positions the vertex positions.
+ * @param triangles the triangles' vertex indices.
+ * @param normals each triangle's corner normals.
+ * @param texcoords each triangle's corner texture mapping coordinates.
+ * @param tangents the container where each triangle's corner tangents will be stored.
+ */
+void computeVertexTangents
+(
+   const std::vector<clockwork::Point3>& positions,
+   const std::vector<TriangleIndices>& triangles,
+   const std::vector<std::array<clockwork::Vector3, 3>>& normals,
+   const std::vector<std::array<Texture::Coordinates, 3>>& texcoords,
+   std::vector<std::array<Tangent, 3>>& tangents
+);
+
+} // namespace graphics
+} // namespace clockwork
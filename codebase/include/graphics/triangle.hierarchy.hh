@@ -0,0 +1,171 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "ray.hh"
+#include <vector>
+#include <array>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace graphics {
+
+/**
+ * @see model3d.hh.
+ */
+class Model3D;
+
+/**
+ * A TriangleHierarchy is a bounding volume hierarchy over a 3D model's triangles that
+ * accelerates ray casting. It is built once with the surface area heuristic and never
+ * modified. Each leaf holds up to four triangles that are stored in a structure of arrays,
+ * so that a ray can be tested against all of them at once with SSE instructions.
+ */
+class TriangleHierarchy
+{
+public:
+   /**
+    * The point at which a ray intersects a triangle.
+    */
+   struct Hit
+   {
+      /**
+       * The index of the intersected triangle, i.e. the triangle's vertex indices are
+       * stored at offsets 3t, 3t + 1 and 3t + 2 of the model's index buffer.
+       */
+      uint32_t triangle;
+      /**
+       * The barycentric coordinates of the intersection with respect to the triangle's
+       * second and third vertices. The first vertex's coordinate is 1 - u - v.
+       */
+      float u;
+      float v;
+      /**
+       * The distance from the ray's origin to the intersection.
+       */
+      double distance;
+   };
+   /**
+    * Build the hierarchy for the highest level of detail of a 3D model.
+    * @param model3D the model.
+    */
+   explicit TriangleHierarchy(const Model3D& model3D);
+   /**
+    * Find the closest triangle that is intersected by a ray. Returns true if a triangle
+    * is intersected within the given distance, false otherwise.
+    * @param ray the ray in the model's coordinate space.
+    * @param maximumDistance the distance up to which the ray is tested.
+    * @param hit the intersection, if any.
+    */
+   bool intersect(const Ray& ray, const double& maximumDistance, Hit& hit) const;
+   /**
+    * Return the number of nodes in the hierarchy.
+    */
+   std::size_t getNodeCount() const;
+private:
+   /**
+    * The maximum number of triangles in a leaf.
+    */
+   static constexpr unsigned int LEAF_SIZE = 4;
+   /**
+    * The number of bins used to evaluate the surface area heuristic.
+    */
+   static constexpr unsigned int SAH_BIN_COUNT = 16;
+   /**
+    * The depth beyond which nodes are split at their median rather than with the surface
+    * area heuristic. This bounds the hierarchy's depth, and therefore the traversal stack.
+    */
+   static constexpr unsigned int SAH_MAXIMUM_DEPTH = 32;
+   /**
+    * The size of the traversal stack.
+    */
+   static constexpr unsigned int STACK_SIZE = 64;
+   /**
+    * A node's bounds are padded to four components so that they can be loaded directly into
+    * SSE registers. An internal node's children are stored next to each other, starting at
+    * 'index'. A leaf's triangles are stored in the packet at 'index'.
+    */
+   struct Node
+   {
+      std::array<float, 4> minimum;
+      std::array<float, 4> maximum;
+      uint32_t index;
+      uint32_t count;
+      /**
+       * Return true if the node is a leaf, false otherwise.
+       */
+      inline bool isLeaf() const { return count > 0; }
+   };
+   /**
+    * Up to four triangles stored as a structure of arrays. Each triangle is defined by its
+    * first vertex and the two edges that start at it. Unused lanes hold degenerate triangles.
+    */
+   struct TrianglePacket
+   {
+      std::array<std::array<float, LEAF_SIZE>, 3> vertex;
+      std::array<std::array<float, LEAF_SIZE>, 3> edge1;
+      std::array<std::array<float, LEAF_SIZE>, 3> edge2;
+      std::array<uint32_t, LEAF_SIZE> triangles;
+   };
+   /**
+    * A triangle's vertices, bounds and centroid, used during construction.
+    */
+   struct BuildEntry
+   {
+      std::array<std::array<float, 3>, 3> vertices;
+      std::array<float, 3> minimum;
+      std::array<float, 3> maximum;
+      std::array<float, 3> centroid;
+      uint32_t triangle;
+   };
+   /**
+    * Build the subtree of a node from a range of build entries.
+    * @param node the index of the node.
+    * @param entries the build entries.
+    * @param begin the index of the first entry in the range.
+    * @param end the index of the entry after the last entry in the range.
+    * @param depth the node's depth.
+    */
+   void build(const uint32_t& node, std::vector<BuildEntry>& entries, const std::size_t& begin, const std::size_t& end, const unsigned int& depth);
+   /**
+    * Create a leaf packet from a range of build entries.
+    * @param node the index of the leaf node.
+    * @param entries the build entries.
+    * @param begin the index of the first entry in the range.
+    * @param end the index of the entry after the last entry in the range.
+    */
+   void createLeaf(const uint32_t& node, const std::vector<BuildEntry>& entries, const std::size_t& begin, const std::size_t& end);
+   /**
+    * The hierarchy's nodes. The root is the first node.
+    */
+   std::vector<Node> _nodes;
+   /**
+    * The leaves' triangle packets.
+    */
+   std::vector<TrianglePacket> _packets;
+};
+
+} // namespace graphics
+} // namespace clockwork
@@ -33,6 +33,31 @@
 namespace clockwork {
 namespace graphics {
 
+/**
+ * A tangent is a unit vector that lies on a surface and points in the direction of
+ * increasing U texture mapping coordinates. Together with the surface normal, it
+ * defines the tangent space that is used to apply normal and bump maps.
+ */
+struct Tangent
+{
+   /**
+    * The tangent's direction.
+    */
+   clockwork::Vector3 direction;
+   /**
+    * The handedness of the tangent space (+1 or -1), which determines the direction
+    * of the bitangent, i.e. B = handedness * (N x T).
+    */
+   double handedness;
+   /**
+    * Instantiate a tangent with a given direction and handedness.
+    * @param direction the tangent's direction.
+    * @param handedness the tangent space's handedness.
+    */
+   Tangent(const clockwork::Vector3& direction = clockwork::Vector3(), const double& handedness = 1.0);
+};
+
+
 struct Vertex : public clockwork::Point4
 {
 public:
@@ -53,6 +78,10 @@ public:
     * The vertex's normal.
     */
    clockwork::Vector3 normal;
+   /**
+    * The vertex's tangent.
+    */
+   Tangent tangent;
    /**
     * The vertex's color.
     */
@@ -26,6 +26,7 @@
 #include "error.hh"
 #include <QFile>
 #include "model3d.hh"
+#include "material.library.hh"
 
 
 namespace clockwork {
@@ -37,6 +38,12 @@ namespace io {
  * @param outputModel the container where mesh and material data will be stored.
  */
 clockwork::Error loadOBJ(QFile& file, clockwork::graphics::Model3D& outputModel);
+/**
+ * Load every material defined in an MTL file and store them in the given material library.
+ * @param file the file containing the data to load.
+ * @param outputLibrary the container where the material data will be stored.
+ */
+clockwork::Error loadMTL(QFile& file, clockwork::graphics::MaterialLibrary& outputLibrary);
 
 } // namespace io
 } // namespace clockwork
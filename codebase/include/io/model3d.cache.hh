@@ -0,0 +1,55 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "error.hh"
+#include "model3d.hh"
+#include <QFile>
+
+
+namespace clockwork {
+namespace io {
+
+/**
+ * The model cache file format's version. It must be incremented whenever the format,
+ * or the way imported models are processed, changes so that outdated cache files are
+ * ignored.
+ */
+constexpr quint32 MODEL3D_CACHE_VERSION = 2;
+/**
+ * Load a 3D model from a model cache file, i.e. a binary snapshot of a model that was
+ * previously imported and processed.
+ * @param file the file containing the data to load.
+ * @param outputModel the container where mesh and material data will be stored.
+ */
+clockwork::Error readModel3DCache(QFile& file, clockwork::graphics::Model3D& outputModel);
+/**
+ * Save a 3D model to a model cache file.
+ * @param file the file where the data will be saved.
+ * @param model the 3D model to save.
+ */
+clockwork::Error writeModel3DCache(QFile& file, const clockwork::graphics::Model3D& model);
+
+} // namespace io
+} // namespace clockwork
@@ -0,0 +1,246 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "bounding.volume.hh"
+#include "ray.hh"
+#include <QHash>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace scene {
+
+/**
+ * @see scene.object.hh and transform.hierarchy.hh.
+ */
+class Object;
+class TransformHierarchy;
+
+/**
+ * A BoundingVolumeHierarchy is a dynamic binary tree of axis-aligned bounding boxes
+ * that contain the world-space bounds of the scene's visible objects. Each leaf stores
+ * a slightly enlarged ("fat") box so that objects that move a little do not modify
+ * the tree. When an object leaves its fat box, the leaf is enlarged and its ancestors
+ * are refitted. Refitting degrades the tree's quality over time, so the tree is rebuilt
+ * using the surface area heuristic when its cost grows too large.
+ */
+class BoundingVolumeHierarchy
+{
+public:
+   /**
+    * Instantiate an empty hierarchy.
+    */
+   BoundingVolumeHierarchy();
+   /**
+    * Return the number of objects in the hierarchy.
+    */
+   std::size_t size() const;
+   /**
+    * Return true if the hierarchy contains the specified object, false otherwise.
+    * @param object the object to find.
+    */
+   bool contains(const Object& object) const;
+   /**
+    * Insert an object into the hierarchy or, if it is already in the hierarchy, update its bounds.
+    * @param object the object to insert or update.
+    * @param box the object's world-space bounding box.
+    */
+   void update(Object& object, const clockwork::graphics::BoundingBox& box);
+   /**
+    * Remove an object from the hierarchy.
+    * @param object the object to remove.
+    */
+   void remove(const Object& object);
+   /**
+    * Update the bounds of every object whose cumulative transform has changed in a transform
+    * hierarchy, and remove the objects that are no longer part of it.
+    * @param hierarchy the transform hierarchy.
+    */
+   void update(const TransformHierarchy& hierarchy);
+   /**
+    * Rebuild the entire tree using the surface area heuristic.
+    */
+   void rebuild();
+   /**
+    * Return the tree's cost, i.e. the sum of the surface areas of its internal nodes.
+    */
+   double getCost() const;
+   /**
+    * Visit every object whose bounds are potentially inside a frustum.
+    * @param frustum the frustum to test.
+    * @param visitor the function called for each object.
+    */
+   void query(const clockwork::graphics::BoundingFrustum& frustum, const std::function<void(Object&)>& visitor) const;
+   /**
+    * Visit every object whose bounds overlap a box.
+    * @param box the box to test.
+    * @param visitor the function called for each object.
+    */
+   void query(const clockwork::graphics::BoundingBox& box, const std::function<void(Object&)>& visitor) const;
+   /**
+    * Visit every object whose bounds are intersected by a ray, roughly in front-to-back
+    * order. The visitor is given the distance at which the ray enters the object's bounds,
+    * and returns the distance beyond which the remaining objects are of no interest, which
+    * allows the search for the closest intersection to terminate early.
+    * @param ray the ray to test.
+    * @param maximumDistance the distance up to which the ray is tested.
+    * @param visitor the function called for each object.
+    */
+   void query
+   (
+      const clockwork::graphics::Ray& ray,
+      const double& maximumDistance,
+      const std::function<double(Object&, const double& distance)>& visitor
+   ) const;
+   /**
+    * Return an object's world-space bounding box, or an empty box if the object has no appearance.
+    * @param object the object.
+    */
+   static clockwork::graphics::BoundingBox getBoundingBox(const Object& object);
+private:
+   /**
+    * The index of a non-existent node.
+    */
+   static constexpr int32_t NULL_NODE = -1;
+   /**
+    * The fraction of a box's extent by which a leaf's box is enlarged.
+    */
+   static constexpr double FAT_MARGIN = 0.1;
+   /**
+    * The tree is rebuilt when its cost exceeds its cost after the last rebuild by this factor.
+    */
+   static constexpr double REBUILD_THRESHOLD = 1.5;
+   /**
+    * The number of bins used to evaluate the surface area heuristic during a rebuild.
+    */
+   static constexpr unsigned int SAH_BIN_COUNT = 12;
+   /**
+    * A node in the tree. A node is a leaf if it has no children.
+    */
+   struct Node
+   {
+      /**
+       * The box that contains the node's subtree.
+       */
+      clockwork::graphics::BoundingBox box;
+      /**
+       * The index of the parent node, or the next free node if this node is not in use.
+       */
+      int32_t parent;
+      /**
+       * The indices of the node's children.
+       */
+      int32_t left;
+      int32_t right;
+      /**
+       * The object stored in a leaf node.
+       */
+      Object* object;
+      /**
+       * Return true if the node is a leaf, false otherwise.
+       */
+      inline bool isLeaf() const { return left == NULL_NODE; }
+   };
+   /**
+    * A leaf's object and box, used when rebuilding the tree.
+    */
+   struct LeafEntry
+   {
+      Object* object;
+      clockwork::graphics::BoundingBox box;
+      clockwork::Point3 centroid;
+   };
+   /**
+    * Return a new node.
+    */
+   int32_t allocateNode();
+   /**
+    * Return a node to the free list.
+    * @param index the node's index.
+    */
+   void freeNode(const int32_t& index);
+   /**
+    * Set a node's box and update the tree's cost.
+    * @param index the node's index.
+    * @param box the node's new box.
+    */
+   void setBox(const int32_t& index, const clockwork::graphics::BoundingBox& box);
+   /**
+    * Insert a leaf into the tree next to the sibling that minimises the tree's cost.
+    * @param leaf the leaf's index.
+    */
+   void insertLeaf(const int32_t& leaf);
+   /**
+    * Remove a leaf from the tree without freeing it.
+    * @param leaf the leaf's index.
+    */
+   void removeLeaf(const int32_t& leaf);
+   /**
+    * Recalculate the boxes of a node and its ancestors.
+    * @param index the index of the first node to refit.
+    */
+   void refit(int32_t index);
+   /**
+    * Build a subtree from a range of leaf entries, and return the subtree's root.
+    * @param entries the leaf entries.
+    * @param begin the index of the first entry in the range.
+    * @param end the index of the entry after the last entry in the range.
+    * @param parent the index of the subtree's parent.
+    */
+   int32_t build(std::vector<LeafEntry>& entries, const std::size_t& begin, const std::size_t& end, const int32_t& parent);
+   /**
+    * The tree's nodes.
+    */
+   std::vector<Node> _nodes;
+   /**
+    * The index of the tree's root.
+    */
+   int32_t _root;
+   /**
+    * The index of the first unused node.
+    */
+   int32_t _freeList;
+   /**
+    * The leaf that contains each object.
+    */
+   QHash<const Object*, int32_t> _leaves;
+   /**
+    * The sum of the surface areas of the internal nodes.
+    */
+   double _cost;
+   /**
+    * The tree's cost after it was last rebuilt.
+    */
+   double _rebuildCost;
+   /**
+    * The revision of the transform hierarchy's topology that the tree was last updated with.
+    */
+   uint64_t _topologyRevision;
+};
+
+} // namespace scene
+} // namespace clockwork
@@ -26,11 +26,18 @@
 #include "scene.property.hh"
 #include "model3d.hh"
 #include "material.hh"
+#include <QHash>
 
 
 namespace clockwork {
 namespace scene {
 
+/**
+ * @see scene.viewer.hh.
+ */
+class Viewer;
+
+
 class Appearance : public Property
 {
 public:
@@ -62,6 +69,20 @@ public:
     * @param material the material to set.
     */
    void setMaterial(const clockwork::graphics::Material&& material);
+   /**
+    * Return the level of detail that was last selected when the 3D model was rendered
+    * for a given viewer, or 0 if it has never been rendered for the viewer.
+    * @param viewer the viewer.
+    */
+   std::size_t getLevelOfDetail(const Viewer& viewer) const;
+   /**
+    * Set the level of detail that was selected when the 3D model was rendered for a
+    * given viewer. The selection is render state rather than a part of the object's
+    * appearance, so it can be set on a const Appearance.
+    * @param viewer the viewer.
+    * @param level the selected level of detail.
+    */
+   void setLevelOfDetail(const Viewer& viewer, const std::size_t& level) const;
 private:
    /**
     * A 3D model.
@@ -71,6 +92,10 @@ private:
     * A material, i.e. the 3D model's look and feel.
     */
    clockwork::graphics::Material _material;
+   /**
+    * The level of detail that was last selected for each viewer.
+    */
+   mutable QHash<const Viewer*, std::size_t> _levelsOfDetail;
 };
 
 } // namespace scene
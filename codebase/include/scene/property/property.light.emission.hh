@@ -0,0 +1,71 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "scene.property.hh"
+#include "color.hh"
+
+
+namespace clockwork {
+namespace scene {
+
+class LightEmission : public Property
+{
+public:
+   /**
+    * Instantiate a LightEmission property with a specified proprietor.
+    * @param proprietor the scene object that is described by this property.
+    */
+   explicit LightEmission(Object& proprietor);
+   /**
+    * Return the color of the emitted light.
+    */
+   const clockwork::graphics::ColorRGBA& getColor() const;
+   /**
+    * Set the color of the emitted light.
+    * @param color the color to set.
+    */
+   void setColor(const clockwork::graphics::ColorRGBA& color);
+   /**
+    * Return the intensity of the emitted light.
+    */
+   const float& getIntensity() const;
+   /**
+    * Set the intensity of the emitted light.
+    * @param intensity the intensity to set, which is clamped to a non-negative value.
+    */
+   void setIntensity(const float& intensity);
+private:
+   /**
+    * The color of the emitted light.
+    */
+   clockwork::graphics::ColorRGBA _color;
+   /**
+    * The intensity of the emitted light.
+    */
+   float _intensity;
+};
+
+} // namespace scene
+} // namespace clockwork
@@ -0,0 +1,265 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "scene.object.hh"
+#include "model3d.hh"
+#include "point3.hh"
+#include <QString>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+namespace clockwork {
+namespace scene {
+
+/**
+ * The SceneGenerator builds procedural scenes of a given size and shape under a root
+ * object, so that culling, updates and rasterisation can be measured as scenes grow.
+ * The mesh objects are laid out on a square grid along a Z-order curve, and grouped
+ * into a hierarchy so that each group covers a compact area of the grid. A scene is
+ * entirely determined by its options, so the same options always generate the same
+ * scene.
+ */
+class SceneGenerator
+{
+public:
+   /**
+    * The meshes that scene objects are drawn with.
+    */
+   enum class Mesh
+   {
+      Sphere,  // A UV sphere.
+      Grid,    // A flat square grid.
+      Terrain  // A square grid displaced by fractal noise.
+   };
+   /**
+    * The ways that scene objects move.
+    */
+   enum class Motion
+   {
+      Static,  // Nothing moves.
+      Turn,    // The whole scene turns around its center, as a single transform.
+      Spin,    // Each object spins on the spot, so its bounds barely change.
+      Orbit,   // Each object circles around its place in the grid.
+      Scatter  // Each object travels to a random place and back, across the scene.
+   };
+   /**
+    * The parameters of a generated scene.
+    */
+   struct Options
+   {
+      /**
+       * The number of mesh objects, between 1 and MAXIMUM_OBJECT_COUNT.
+       */
+      uint32_t objectCount = 100;
+      /**
+       * The number of levels of the hierarchy below the scene's root. The mesh objects are
+       * at the last level, and the levels above them are made of group objects.
+       */
+      uint32_t hierarchyDepth = 1;
+      /**
+       * The mesh the objects are drawn with.
+       */
+      Mesh mesh = Mesh::Sphere;
+      /**
+       * The number of subdivisions of each mesh along each of its axes. A sphere has twice
+       * as many slices as it has stacks.
+       */
+      uint32_t meshResolution = 16;
+      /**
+       * The fraction of objects that share a 3D model with other objects, where 0 gives
+       * each object its own 3D model and 1 draws every object with the same 3D model.
+       */
+      double instancingRatio = 1.0;
+      /**
+       * The number of light sources, which are placed on a ring around the objects.
+       */
+      uint32_t lightCount = 0;
+      /**
+       * The way that objects move.
+       */
+      Motion motion = Motion::Static;
+      /**
+       * The fraction of objects that move, when each object moves on its own.
+       */
+      double movingRatio = 1.0;
+      /**
+       * The seed of the generator's random values.
+       */
+      uint32_t seed = 0;
+   };
+   /**
+    * The largest number of mesh objects a scene may have.
+    */
+   static constexpr uint32_t MAXIMUM_OBJECT_COUNT = 1000000;
+   /**
+    * The largest number of levels a scene's hierarchy may have.
+    */
+   static constexpr uint32_t MAXIMUM_HIERARCHY_DEPTH = 32;
+   /**
+    * Generate a scene and add it to a parent object.
+    * @param options the scene's parameters.
+    * @param parent the object that the scene's root is added to.
+    */
+   SceneGenerator(const Options& options, Object& parent);
+   /**
+    * The destructor removes the generated scene from its parent.
+    */
+   ~SceneGenerator();
+   /**
+    * A generated scene is not copyable.
+    */
+   SceneGenerator(const SceneGenerator&) = delete;
+   SceneGenerator& operator=(const SceneGenerator&) = delete;
+   /**
+    * Return the options the scene was generated with.
+    */
+   const Options& getOptions() const;
+   /**
+    * Return the scene's root object.
+    */
+   Object& getRoot();
+   /**
+    * Return every generated object, i.e. the root, the groups, the mesh objects and the
+    * light sources.
+    */
+   const std::vector<Object*>& getObjects() const;
+   /**
+    * Return the number of distinct 3D models the mesh objects are drawn with.
+    */
+   std::size_t getModel3DCount() const;
+   /**
+    * Move the scene's objects to a given point of their motion, where 0 is its beginning
+    * and 1 its end. The motion is periodic, so 0 and 1 place the objects identically.
+    * @param t the point of the motion.
+    */
+   void animate(const double& t);
+   /**
+    * Parse a scene description, i.e. a comma-separated list of key=value pairs such as
+    * "objects=10000,depth=3,mesh=terrain,motion=orbit", into a set of options. Keys that
+    * are not in the description keep their value. The keys are objects, depth, mesh,
+    * resolution, instancing, lights, motion, moving and seed.
+    * @param description the description to parse.
+    * @param options the options that the description is written to.
+    * @param errors the stream that parsing errors are written to.
+    */
+   static bool parse(const QString& description, Options& options, std::ostream& errors);
+   /**
+    * Return the description of a set of options, which can be parsed back into the same
+    * options.
+    * @param options the options.
+    */
+   static QString toString(const Options& options);
+   /**
+    * Create a UV sphere with a given number of slices (around its vertical axis) and
+    * stacks (from pole to pole). The sphere has a radius of 1, and is centered on the
+    * origin.
+    * @param slices the number of slices.
+    * @param stacks the number of stacks.
+    */
+   static std::unique_ptr<clockwork::graphics::Model3D> createSphere(const uint32_t& slices, const uint32_t& stacks);
+   /**
+    * Create a square grid with a given number of cells along each axis. The grid spans
+    * [-1, 1] along the X and Y axes, and faces the Z axis. If an amplitude is given, the
+    * grid's vertices are displaced along the Z axis by fractal noise, which makes it a
+    * terrain.
+    * @param resolution the number of cells along each axis.
+    * @param amplitude the largest displacement of a vertex.
+    * @param seed the seed of the noise.
+    */
+   static std::unique_ptr<clockwork::graphics::Model3D>
+   createGrid(const uint32_t& resolution, const double& amplitude = 0.0, const uint32_t& seed = 0);
+private:
+   /**
+    * An object that moves on its own, and the parameters of its motion.
+    */
+   struct MovingObject
+   {
+      /**
+       * The object.
+       */
+      Object* object;
+      /**
+       * The object's place in the grid, relative to its parent.
+       */
+      clockwork::Point3 home;
+      /**
+       * The place that the object travels to when it scatters, relative to its parent.
+       */
+      clockwork::Point3 destination;
+      /**
+       * The offset of the object's motion, so that objects don't move in unison.
+       */
+      double phase;
+   };
+   /**
+    * Create the 3D models the mesh objects are drawn with.
+    */
+   void createModel3Ds();
+   /**
+    * Create the group and mesh objects.
+    */
+   void createObjects();
+   /**
+    * Create the light sources.
+    */
+   void createLights();
+   /**
+    * The options the scene was generated with.
+    */
+   const Options _options;
+   /**
+    * The object that the scene was added to.
+    */
+   Object& _parent;
+   /**
+    * The scene's root object.
+    */
+   Object* const _root;
+   /**
+    * The object that the light sources are attached to.
+    */
+   Object* _lights;
+   /**
+    * The distance between two neighbouring mesh objects on the grid.
+    */
+   double _spacing;
+   /**
+    * Every generated object.
+    */
+   std::vector<Object*> _objects;
+   /**
+    * The objects that move on their own.
+    */
+   std::vector<MovingObject> _movingObjects;
+   /**
+    * The 3D models the mesh objects are drawn with.
+    */
+   std::vector<std::unique_ptr<clockwork::graphics::Model3D>> _model3Ds;
+};
+
+} // namespace scene
+} // namespace clockwork
@@ -26,7 +26,10 @@
 #include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QSet>
+#include <memory>
 #include "scene.object.hh"
+#include "transform.hierarchy.hh"
+#include "bounding.volume.hierarchy.hh"
 
 
 namespace clockwork {
@@ -51,6 +54,14 @@ public:
     * Return the scene graph.
     */
    Object& getGraph();
+   /**
+    * Return the scene graph's transform hierarchy.
+    */
+   TransformHierarchy& getTransformHierarchy();
+   /**
+    * Return the bounding volume hierarchy that contains the scene's visible objects.
+    */
+   BoundingVolumeHierarchy& getBoundingVolumeHierarchy();
    /**
     * Return the set of active viewers.
     */
@@ -70,6 +81,18 @@ public:
     * Return true if the scene has at least one active viewer, false otherwise.
     */
    bool hasActiveViewers() const;
+   /**
+    * Capture a snapshot of the scene and publish it, replacing the previous snapshot.
+    * This must be called by the update stage, once the scene's hierarchies are up to
+    * date. Snapshots are double-buffered: the snapshot that was replaced by the previous
+    * capture is reused, unless a reader still holds it.
+    */
+   std::shared_ptr<const SceneSnapshot> captureSnapshot();
+   /**
+    * Return the most recently published snapshot, or nullptr if none has been captured.
+    * This doesn't lock, and may be called from any thread.
+    */
+   std::shared_ptr<const SceneSnapshot> getSnapshot() const;
    /**
     * Save the scene to a JSON file.
     * @param filename the name of the JSON file.
@@ -110,10 +133,30 @@ private:
     * The scene graph.
     */
    Object* const _graph;
+   /**
+    * The flattened transform hierarchy of the scene graph.
+    */
+   TransformHierarchy _transformHierarchy;
+   /**
+    * The spatial index of the scene's visible objects.
+    */
+   BoundingVolumeHierarchy _boundingVolumeHierarchy;
    /**
     * The set of active viewers.
     */
    QSet<Viewer*> _activeViewers;
+   /**
+    * The published snapshot, which is only accessed through the atomic shared_ptr functions.
+    */
+   std::shared_ptr<SceneSnapshot> _snapshot;
+   /**
+    * The snapshot that was published before the current one, and is reused by the next capture.
+    */
+   std::shared_ptr<SceneSnapshot> _spareSnapshot;
+   /**
+    * The sequence number of the last captured snapshot.
+    */
+   uint64_t _snapshotSequence;
    /**
     * When true, this signals that each active viewer's viewport needs to be updated.
     */
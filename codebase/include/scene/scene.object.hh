@@ -35,6 +35,11 @@
 namespace clockwork {
 namespace scene {
 
+/**
+ * @see transform.hierarchy.hh.
+ */
+class TransformHierarchy;
+
 /**
  * An Object is a node in the scene graph that has a set of one or more
  * properties, with a position, orientation (rotation) and scale at least.
@@ -43,6 +48,7 @@ namespace scene {
  */
 class Object : public QObject
 {
+friend class TransformHierarchy;
 public:
    /**
     * Instantiate a named object.
@@ -116,15 +122,18 @@ public:
    /**
     * Return the object's model transformation matrix.
     */
-   const clockwork::Matrix4& getModelTransform();
+   const clockwork::Matrix4& getModelTransform() const;
    /**
     * Return the object's cumulative (composite) model transformation matrix (CMTM).
+    * The CMTM is maintained by the scene's transform hierarchy. If the object is
+    * not part of a hierarchy, its model transformation matrix is returned.
     */
    const clockwork::Matrix4& getCMTM() const;
    /**
-    * Update the model's cumulative transformation matrix.
+    * Signal that the object's model transformation matrix, and everything that is
+    * derived from it such as its world-space bounds, needs to be updated.
     */
-   void updateCMTM();
+   void invalidateModelTransform();
    /**
     * Returns true if this object is pruned, false otherwise.
     */
@@ -200,16 +209,20 @@ private:
    /**
     * The object's model transformation matrix.
     */
-   clockwork::Matrix4 _modelTransform;
+   mutable clockwork::Matrix4 _modelTransform;
    /**
     * When true, this signals that the model transformation matrix needs to be updated.
     */
-   bool _doModelTransformUpdate;
+   mutable bool _doModelTransformUpdate;
+   /**
+    * The transform hierarchy that contains this object, or nullptr if the object
+    * has not been added to a hierarchy.
+    */
+   TransformHierarchy* _hierarchy;
    /**
-    * The object's cumulative (composite) model transformation matrix. This is a
-    * concatenation of the model transformation matrices of this node's parents.
+    * The object's index in its transform hierarchy.
     */
-   clockwork::Matrix4 _CMTM;
+   std::size_t _hierarchyIndex;
    /**
     * The object's children.
     */
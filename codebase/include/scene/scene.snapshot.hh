@@ -0,0 +1,222 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "matrix4.hh"
+#include "point3.hh"
+#include "bounding.volume.hh"
+#include "material.hh"
+#include "model3d.hh"
+#include "viewport.hh"
+#include "render.algorithm.hh"
+#include "image.filter.hh"
+#include "line.algorithm.hh"
+#include "primitive.mode.hh"
+#include <vector>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace scene {
+
+/**
+ * @see scene.object.hh.
+ */
+class Object;
+
+/**
+ * @see scene.viewer.hh.
+ */
+class Viewer;
+
+/**
+ * @see scene.hh.
+ */
+class Scene;
+
+/**
+ * An ObjectSnapshot is a copy of the state that is needed to render a scene object.
+ */
+struct ObjectSnapshot
+{
+   /**
+    * The captured object. It identifies the object across snapshots, and must never be
+    * dereferenced since the object may have been modified or destroyed since.
+    */
+   const Object* key;
+   /**
+    * The object's 3D model. Models are resources that outlive the objects that use them.
+    */
+   const clockwork::graphics::Model3D* model3D;
+   /**
+    * The object's material.
+    */
+   clockwork::graphics::Material material;
+   /**
+    * The object's cumulative model transformation matrix.
+    */
+   clockwork::Matrix4 MODEL;
+   /**
+    * The object's bounds, in world space.
+    */
+   clockwork::graphics::BoundingBox box;
+};
+
+/**
+ * A ViewerSnapshot is a copy of the state that is needed to render a scene from a
+ * viewer's point of view.
+ */
+struct ViewerSnapshot
+{
+   /**
+    * The captured viewer. Like an object snapshot's key, it must never be dereferenced.
+    */
+   const Viewer* key;
+   /**
+    * The viewer's position.
+    */
+   clockwork::Point3 position;
+   /**
+    * The viewer's origin, in world space.
+    */
+   clockwork::Point3 viewpoint;
+   /**
+    * The viewer's view, projection and view-projection transforms.
+    */
+   clockwork::Matrix4 VIEW;
+   clockwork::Matrix4 PROJECTION;
+   clockwork::Matrix4 VIEWPROJECTION;
+   /**
+    * The viewer's viewport.
+    */
+   clockwork::graphics::Viewport viewport;
+   /**
+    * The viewer's render algorithm, primitive mode, line algorithm and image filter.
+    */
+   clockwork::graphics::RenderAlgorithm::Identifier renderAlgorithm;
+   clockwork::graphics::PrimitiveMode::Identifier primitiveMode;
+   clockwork::graphics::LineAlgorithm::Identifier lineAlgorithm;
+   clockwork::graphics::ImageFilter::Type imageFilter;
+   /**
+    * The indices of the snapshot objects that are inside the viewer's view frustum.
+    */
+   std::vector<uint32_t> visibleObjects;
+   /**
+    * Copy a viewer's state into the snapshot. This leaves the visible objects untouched.
+    * @param viewer the viewer to capture.
+    */
+   void capture(Viewer& viewer);
+};
+
+/**
+ * A SceneSnapshot is an immutable copy of the part of the scene that the renderer
+ * needs to draw a frame: the active viewers, the renderable objects that are inside
+ * their view frustums, and the renderable objects that have moved since the previous
+ * snapshot. It is captured by the update stage and published by the scene, after which
+ * the renderer reads it without locking, and without touching the scene's objects.
+ * @see Scene::captureSnapshot.
+ */
+class SceneSnapshot
+{
+friend class Scene;
+public:
+   /**
+    * Instantiate an empty snapshot.
+    */
+   SceneSnapshot();
+   /**
+    * Return the snapshot's position in the order snapshots are captured. The first
+    * snapshot's sequence number is 1.
+    */
+   const uint64_t& getSequence() const;
+   /**
+    * Return the transform hierarchy's topology revision when the snapshot was captured.
+    */
+   const uint64_t& getTopologyRevision() const;
+   /**
+    * Return the captured objects.
+    */
+   const std::vector<ObjectSnapshot>& getObjects() const;
+   /**
+    * Return the captured viewers.
+    */
+   const std::vector<ViewerSnapshot>& getViewers() const;
+   /**
+    * Return the indices of the captured objects whose transform changed since the
+    * previous snapshot was captured.
+    */
+   const std::vector<uint32_t>& getChangedObjects() const;
+private:
+   /**
+    * Capture the scene. The scene's transform and bounding volume hierarchies must be
+    * up to date. The containers are cleared rather than reallocated, so that a snapshot
+    * that is captured over and over again rarely allocates memory.
+    * @param scene the scene to capture.
+    * @param sequence the snapshot's sequence number.
+    */
+   void capture(Scene& scene, const uint64_t& sequence);
+   /**
+    * Add an object to the snapshot if it hasn't been added already, and return its index,
+    * or NOT_RENDERABLE if the object has nothing to render.
+    * @param scene the scene that is captured.
+    * @param object the object to add.
+    */
+   int32_t add(Scene& scene, const Object& object);
+   /**
+    * The index of an object that hasn't been added to the snapshot.
+    */
+   static constexpr int32_t NOT_CAPTURED = -1;
+   /**
+    * The index of an object that has no 3D model, and so is not added to the snapshot.
+    */
+   static constexpr int32_t NOT_RENDERABLE = -2;
+   /**
+    * The snapshot's sequence number.
+    */
+   uint64_t _sequence;
+   /**
+    * The transform hierarchy's topology revision.
+    */
+   uint64_t _topologyRevision;
+   /**
+    * The captured objects.
+    */
+   std::vector<ObjectSnapshot> _objects;
+   /**
+    * The captured viewers.
+    */
+   std::vector<ViewerSnapshot> _viewers;
+   /**
+    * The indices of the captured objects that have moved.
+    */
+   std::vector<uint32_t> _changedObjects;
+   /**
+    * The index of each object of the transform hierarchy in the snapshot, which is only
+    * used while the snapshot is captured.
+    */
+   std::vector<int32_t> _indices;
+};
+
+} // namespace scene
+} // namespace clockwork
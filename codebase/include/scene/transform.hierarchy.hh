@@ -0,0 +1,203 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include "matrix4.hh"
+#include <QMutex>
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+
+namespace clockwork {
+namespace scene {
+
+/**
+ * @see scene.object.hh.
+ */
+class Object;
+
+/**
+ * A TransformHierarchy is a flattened representation of the scene graph's transforms.
+ * Objects are stored in breadth-first order so that a parent always precedes its children,
+ * which allows every cumulative model transformation matrix to be updated in a single
+ * linear sweep over contiguous arrays. Only the objects whose local transform changed,
+ * and their descendants, are recomputed. Objects at the same depth are independent of
+ * each other, so each depth level is updated in parallel.
+ *
+ * Changes may be signalled from any thread while an update is running. They are recorded
+ * and only applied to the hierarchy when the next update begins.
+ */
+class TransformHierarchy
+{
+public:
+   /**
+    * Instantiate a transform hierarchy for the graph with the given root.
+    * @param root the root of the scene graph.
+    */
+   explicit TransformHierarchy(Object& root);
+   /**
+    * Return the number of objects in the hierarchy.
+    */
+   std::size_t size() const;
+   /**
+    * Return the object at the specified index.
+    * @param index the object's index in the hierarchy.
+    */
+   Object& getObject(const std::size_t& index) const;
+   /**
+    * Return the specified object's index in the hierarchy.
+    * @param object the object, which must be a part of the hierarchy.
+    */
+   std::size_t getIndex(const Object& object) const;
+   /**
+    * Return the index of the specified object's parent, or -1 if the object is the root.
+    * @param index the object's index in the hierarchy.
+    */
+   const int32_t& getParent(const std::size_t& index) const;
+   /**
+    * Return the number of depth levels in the hierarchy.
+    */
+   std::size_t getLevelCount() const;
+   /**
+    * Return the cumulative model transformation matrix of the object at the specified index.
+    * @param index the object's index in the hierarchy.
+    */
+   const clockwork::Matrix4& getCumulativeTransform(const std::size_t& index) const;
+   /**
+    * Return the indices of the objects whose cumulative transform changed during the last update.
+    */
+   const std::vector<std::size_t>& getChangedObjects() const;
+   /**
+    * Return a number that is incremented each time the hierarchy is rebuilt.
+    */
+   const uint64_t& getTopologyRevision() const;
+   /**
+    * Signal that an object's local transform has changed. The object's cumulative transform
+    * is recalculated by the next update that begins after this call.
+    * @param object the object, which must be a part of the hierarchy.
+    */
+   void setDirty(const Object& object);
+   /**
+    * Signal that objects were added to or removed from the scene graph. The hierarchy
+    * will be rebuilt before its next update.
+    */
+   void setTopologyDirty();
+   /**
+    * Remove an object and its descendants from the hierarchy.
+    * @param object the object to remove.
+    */
+   void detach(Object& object);
+   /**
+    * Update the cumulative model transformation matrices of all objects that have changed
+    * since the last update, rebuilding the hierarchy first if its topology has changed.
+    */
+   void update();
+private:
+   /**
+    * A dirty flag that signals that an object's local transform has changed.
+    */
+   static constexpr uint8_t LOCAL_DIRTY = 0x1;
+   /**
+    * A dirty flag that signals that an object's cumulative transform has changed
+    * during the current update.
+    */
+   static constexpr uint8_t CUMULATIVE_DIRTY = 0x2;
+   /**
+    * The index used when no object is dirty.
+    */
+   static constexpr std::size_t NO_DIRTY_INDEX = std::numeric_limits<std::size_t>::max();
+   /**
+    * The number of objects updated by a single parallel task.
+    */
+   static constexpr std::size_t UPDATE_GRAIN = 2048;
+   /**
+    * Rebuild the hierarchy's arrays from the scene graph.
+    */
+   void rebuild();
+   /**
+    * Update the cumulative transforms of the objects in the range [begin, end). The parents
+    * of every object in the range must have been updated beforehand.
+    * @param begin the index of the first object to update.
+    * @param end the index of the object after the last object to update.
+    */
+   void update(const std::size_t& begin, const std::size_t& end);
+   /**
+    * The root of the scene graph.
+    */
+   Object& _root;
+   /**
+    * The objects in breadth-first order.
+    */
+   std::vector<Object*> _objects;
+   /**
+    * The index of each object's parent, or -1 for the root.
+    */
+   std::vector<int32_t> _parents;
+   /**
+    * The index of the first object in each depth level, followed by the number of objects.
+    * Objects in the range [_levels[n], _levels[n + 1]) are at depth n.
+    */
+   std::vector<std::size_t> _levels;
+   /**
+    * The local model transformation matrix of each object.
+    */
+   std::vector<clockwork::Matrix4> _localTransforms;
+   /**
+    * The cumulative model transformation matrix of each object.
+    */
+   std::vector<clockwork::Matrix4> _cumulativeTransforms;
+   /**
+    * The dirty flags of each object. These are only accessed by the update.
+    */
+   std::vector<uint8_t> _dirty;
+   /**
+    * The smallest index of a dirty object. Since parents precede their children, the
+    * update sweep can start at this index.
+    */
+   std::size_t _firstDirtyIndex;
+   /**
+    * The objects whose local transform changed since the last update began.
+    */
+   std::vector<const Object*> _pendingObjects;
+   /**
+    * The indices of the objects whose cumulative transform changed during the last update.
+    */
+   std::vector<std::size_t> _changedObjects;
+   /**
+    * The number of times the hierarchy has been rebuilt.
+    */
+   uint64_t _topologyRevision;
+   /**
+    * When true, this signals that the hierarchy needs to be rebuilt.
+    */
+   bool _isTopologyDirty;
+   /**
+    * The mutex that guards the pending objects and the topology flag.
+    */
+   QMutex _pendingMutex;
+};
+
+} // namespace scene
+} // namespace clockwork
@@ -24,10 +24,12 @@
 #pragma once
 
 #include <QApplication>
-#include <QBasicTimer>
 #include "error.hh"
+#include "frame.loop.hh"
 #include "window.hh"
 #include "services.hh"
+#include "scene.generator.hh"
+#include <memory>
 
 
 namespace clockwork {
@@ -57,10 +59,28 @@ public:
    clockwork::Error initialise();
 public slots:
    /**
-    * Update the system.
+    * Update the system. Requests made before the frame loop's next tick are coalesced
+    * into a single frame.
     */
    void update();
+private slots:
+   /**
+    * Advance the generated scene's motion by a simulation timestep.
+    * @param timestep the timestep, in seconds.
+    */
+   void step(const double& timestep);
 private:
+   /**
+    * The time it takes a generated scene to go through its motion once, in seconds.
+    */
+   static constexpr double SCENE_MOTION_PERIOD = 10.0;
+   /**
+    * Generate a scene from its description, and draw it instead of the default scene.
+    * If the description can't be parsed, the default scene is kept.
+    * @param description the scene's description.
+    * @see SceneGenerator::parse.
+    */
+   void generateScene(const QString& description);
     /**
      * Parse the command line arguments and return an execution context.
      * @param argc the number of command line arguments.
@@ -72,17 +92,19 @@ private:
      */
     clockwork::ui::Window _window;
     /**
-     * This timer is used to coalesce (group) multiple updates into one. When an
-     * update is triggered, then this timer starts a countdown. If another update
-     * is requested while the timer is counting down, then it is restarted. Once the
-     * timer times out, then an update is made.
+     * The frame loop, which paces updates and renders, and coalesces update requests
+     * made between two frames into one.
+     */
+    clockwork::concurrency::FrameLoop _frameLoop;
+    /**
+     * The generated scene, if one was requested with the CLOCKWORK_SCENE environment
+     * variable.
      */
-    QBasicTimer _coalescer;
+    std::unique_ptr<clockwork::scene::SceneGenerator> _sceneGenerator;
     /**
-     * The timerEvent event handler contains the actual system update algorithm and is
-     * called when _coalescer times out.
+     * The point of the generated scene's motion, in [0, 1).
      */
-    void timerEvent(QTimerEvent* const) override final;
+    double _sceneTime;
 signals:
     /**
      * This signal is emitted when the system update is complete.
@@ -33,6 +33,8 @@ enum class Error : unsigned int
    None = 0,
    Unknown = 1,
    FileNotAccessible = 2,
+   FileNotWritable = 3,
+   InvalidFileFormat = 4,
 };
 
 } // namespace clockwork
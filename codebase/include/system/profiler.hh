@@ -0,0 +1,339 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+/**
+ * The profiler is only compiled when CLOCKWORK_PROFILER is defined, e.g. by building
+ * with CONFIG+=profiler. Otherwise, the profiling macros expand to nothing.
+ */
+#ifdef CLOCKWORK_PROFILER
+
+#include <QString>
+#include <QMutex>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+
+namespace clockwork {
+namespace system {
+
+/**
+ * The Profiler measures the time spent in each stage of a frame, on each thread. Scoped
+ * timers record events into a ring buffer that belongs to the calling thread, and that
+ * is written without locking. When a frame is retired, the events that were recorded
+ * since the previous frame are summed into the frame history, which is shown by the
+ * debug display. The most recent events can also be exported as a Chrome trace, which
+ * can be viewed in chrome://tracing.
+ */
+class Profiler
+{
+public:
+   /**
+    * The stages of a frame.
+    */
+   enum class Stage : uint8_t
+   {
+      Update,
+      Culling,
+      Vertex,
+      Setup,
+      Raster,
+      Fragment,
+      Post,
+      Present
+   };
+   /**
+    * The number of stages.
+    */
+   static constexpr std::size_t STAGE_COUNT = 8;
+   /**
+    * The time spent in a frame, and in each of its stages, in milliseconds. Stages that
+    * run on several threads, or overlap with the next frame, may add up to more than
+    * the frame's duration.
+    */
+   struct FrameRecord
+   {
+      double frameTime;
+      std::array<double, STAGE_COUNT> stageTimes;
+   };
+   /**
+    * A Scope records an event that lasts from its construction to its destruction.
+    */
+   class Scope
+   {
+   public:
+      /**
+       * Start measuring a stage.
+       * @param stage the measured stage.
+       */
+      explicit Scope(const Stage& stage);
+      /**
+       * Stop measuring the stage, and record the event.
+       */
+      ~Scope();
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+   private:
+      /**
+       * The profiler, which is instantiated before the scope's time is measured.
+       */
+      Profiler& _profiler;
+      /**
+       * The measured stage.
+       */
+      const Stage _stage;
+      /**
+       * The time at which the scope was entered.
+       */
+      const int64_t _begin;
+   };
+   /**
+    * An AccumulatingScope measures a stage that is too short-lived to be recorded as an
+    * event of its own, such as a fragment program. Its duration is added to the calling
+    * thread's pending time, which is reported at the end of the enclosing Scope's event.
+    */
+   class AccumulatingScope
+   {
+   public:
+      /**
+       * Start measuring a stage.
+       * @param stage the measured stage.
+       */
+      explicit AccumulatingScope(const Stage& stage);
+      /**
+       * Stop measuring the stage, and accumulate its duration.
+       */
+      ~AccumulatingScope();
+      AccumulatingScope(const AccumulatingScope&) = delete;
+      AccumulatingScope& operator=(const AccumulatingScope&) = delete;
+   private:
+      /**
+       * The profiler, which is instantiated before the scope's time is measured.
+       */
+      Profiler& _profiler;
+      /**
+       * The measured stage.
+       */
+      const Stage _stage;
+      /**
+       * The time at which the scope was entered.
+       */
+      const int64_t _begin;
+   };
+   /**
+    * Return the profiler's unique instance.
+    */
+   static Profiler& getInstance();
+   /**
+    * Return the current time of a monotonic clock, in nanoseconds.
+    */
+   static int64_t now();
+   /**
+    * Return a stage's name.
+    * @param stage the stage.
+    */
+   static const char* getName(const Stage& stage);
+   /**
+    * Record an event for the calling thread. The time that was accumulated by the thread
+    * since its last event is carved out of the end of this event, and recorded as events
+    * of the accumulated stages.
+    * @param stage the stage.
+    * @param begin the time at which the event began.
+    * @param end the time at which the event ended.
+    */
+   void record(const Stage& stage, const int64_t& begin, const int64_t& end);
+   /**
+    * Add a duration to the calling thread's pending time for a given stage.
+    * @param stage the stage.
+    * @param duration the duration, in nanoseconds.
+    */
+   void accumulate(const Stage& stage, const int64_t& duration);
+   /**
+    * Signal that a frame has been retired. This sums the events that were recorded since
+    * the previous frame into the frame history. This function is thread-safe.
+    */
+   void onFrameCompleted();
+   /**
+    * Return the most recent frames, from the oldest to the newest. This function is thread-safe.
+    */
+   std::vector<FrameRecord> getFrameHistory() const;
+   /**
+    * Write the events that are still held by the threads' ring buffers to a file, in the
+    * Chrome trace event format. Returns true if the file was written, false otherwise.
+    * @param filename the name of the file to write.
+    */
+   bool exportChromeTrace(const QString& filename) const;
+   /**
+    * The number of frames that are kept in the frame history.
+    */
+   static constexpr std::size_t HISTORY_LENGTH = 240;
+private:
+   /**
+    * Instantiate the profiler.
+    */
+   Profiler();
+   /**
+    * The destructor.
+    */
+   ~Profiler();
+   Profiler(const Profiler&) = delete;
+   Profiler& operator=(const Profiler&) = delete;
+   /**
+    * A measured stage.
+    */
+   struct Event
+   {
+      int64_t begin;
+      int64_t end;
+      Stage stage;
+   };
+   /**
+    * An EventBuffer is a ring buffer of the events recorded by a single thread. Only
+    * its thread writes to it, and it is read without locking: a reader copies the
+    * events, then discards the ones that may have been overwritten while it did.
+    */
+   struct EventBuffer
+   {
+      /**
+       * The number of events that a buffer holds, which is a power of two.
+       */
+      static constexpr std::size_t CAPACITY = 16384;
+      /**
+       * Instantiate an event buffer for a given thread.
+       * @param thread the thread's identifier in the trace.
+       * @param name the thread's name.
+       */
+      EventBuffer(const uint32_t& thread, const QString& name);
+      /**
+       * Append an event, overwriting the oldest one if the buffer is full.
+       * @param event the event to append.
+       */
+      void push(const Event& event);
+      /**
+       * Copy the events that were recorded after a given position, and return the
+       * position after the last event.
+       * @param from the position of the first event to copy.
+       * @param output the list that the events are copied to.
+       */
+      uint64_t read(uint64_t from, std::vector<Event>& output) const;
+      /**
+       * The events.
+       */
+      std::array<Event, CAPACITY> events;
+      /**
+       * The number of events that have been recorded.
+       */
+      std::atomic<uint64_t> head;
+      /**
+       * The time that was accumulated for each stage since the thread's last event.
+       */
+      std::array<int64_t, STAGE_COUNT> pending;
+      /**
+       * True if the thread has pending time, false otherwise.
+       */
+      bool hasPendingTime;
+      /**
+       * The position of the first event that hasn't been summed into the frame history.
+       */
+      uint64_t cursor;
+      /**
+       * The thread's identifier in the trace.
+       */
+      const uint32_t thread;
+      /**
+       * The thread's name.
+       */
+      const QString name;
+      /**
+       * The next buffer in the profiler's list of buffers.
+       */
+      EventBuffer* next;
+   };
+   /**
+    * Return the calling thread's event buffer, creating it if the thread has never
+    * recorded an event.
+    */
+   EventBuffer& getEventBuffer();
+   /**
+    * The time at which the profiler was instantiated.
+    */
+   const int64_t _epoch;
+   /**
+    * The list of event buffers. Buffers are only ever added to the front of the list,
+    * without locking, and are kept until the profiler is destroyed.
+    */
+   std::atomic<EventBuffer*> _buffers;
+   /**
+    * The number of threads that have recorded an event.
+    */
+   std::atomic<uint32_t> _threadCount;
+   /**
+    * The mutex that serialises accesses to the frame history.
+    */
+   mutable QMutex _historyMutex;
+   /**
+    * The frame history.
+    */
+   std::deque<FrameRecord> _history;
+   /**
+    * The time at which the last frame was retired.
+    */
+   int64_t _lastFrameTime;
+};
+
+} // namespace system
+} // namespace clockwork
+
+#define CLOCKWORK_PROFILER_CONCATENATE_(a, b) a##b
+#define CLOCKWORK_PROFILER_CONCATENATE(a, b) CLOCKWORK_PROFILER_CONCATENATE_(a, b)
+
+/**
+ * Measure a stage until the end of the enclosing block.
+ */
+#define CLOCKWORK_PROFILE(stage) \
+const clockwork::system::Profiler::Scope CLOCKWORK_PROFILER_CONCATENATE(_profilerScope, __LINE__) \
+(clockwork::system::Profiler::Stage::stage)
+
+/**
+ * Accumulate the time spent in a stage until the end of the enclosing block.
+ */
+#define CLOCKWORK_PROFILE_ACCUMULATE(stage) \
+const clockwork::system::Profiler::AccumulatingScope CLOCKWORK_PROFILER_CONCATENATE(_profilerScope, __LINE__) \
+(clockwork::system::Profiler::Stage::stage)
+
+/**
+ * Signal that a frame has been retired.
+ */
+#define CLOCKWORK_PROFILE_FRAME() clockwork::system::Profiler::getInstance().onFrameCompleted()
+
+#else
+
+#define CLOCKWORK_PROFILE(stage) static_cast<void>(0)
+#define CLOCKWORK_PROFILE_ACCUMULATE(stage) static_cast<void>(0)
+#define CLOCKWORK_PROFILE_FRAME() static_cast<void>(0)
+
+#endif // CLOCKWORK_PROFILER
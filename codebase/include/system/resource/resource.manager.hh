@@ -26,6 +26,7 @@
 #include <QHash>
 #include <QCryptographicHash>
 #include "model3d.hh"
+#include "material.library.hh"
 
 
 namespace clockwork {
@@ -42,7 +43,66 @@ public:
     * @param filename the name of the file containing the 3D model to load.
     */
    const clockwork::graphics::Model3D* loadModel3D(const QString& filename);
+   /**
+    * Load, store and return a material library from a given file. Like 3D models,
+    * material libraries are stored in the resource dictionary so that a library
+    * referenced by several models is only parsed once.
+    * @param filename the name of the file containing the material library to load.
+    */
+   const clockwork::graphics::MaterialLibrary* loadMaterialLibrary(const QString& filename);
+   /**
+    * Enable or disable mesh optimisation. When enabled, the triangles of an imported 3D
+    * model are reordered to improve vertex cache locality and reduce overdraw.
+    * @param enable true to enable mesh optimisation, false otherwise.
+    */
+   void enableMeshOptimisation(const bool& enable = true);
+   /**
+    * Is mesh optimisation enabled?
+    */
+   bool isMeshOptimisationEnabled() const;
+   /**
+    * Enable or disable level of detail generation. When enabled, a chain of simplified
+    * versions of each imported 3D model is generated.
+    * @param enable true to enable level of detail generation, false otherwise.
+    */
+   void enableLevelOfDetailGeneration(const bool& enable = true);
+   /**
+    * Is level of detail generation enabled?
+    */
+   bool isLevelOfDetailGenerationEnabled() const;
+   /**
+    * Enable or disable the model cache. When enabled, imported and processed 3D models
+    * are saved in a binary form so that subsequent imports of the same file are
+    * (almost) free.
+    * @param enable true to enable the model cache, false otherwise.
+    */
+   void enableModelCache(const bool& enable = true);
+   /**
+    * Is the model cache enabled?
+    */
+   bool isModelCacheEnabled() const;
 private:
+   /**
+    * Calculate the cryptographic hash of a given file's content, and return it
+    * in the form of a hexadecimal string. Note that the file must be open.
+    * @param file the file to hash.
+    */
+   QString hash(QFile& file);
+   /**
+    * Calculate a hash of the material libraries that a given OBJ file references, and
+    * return it in the form of a hexadecimal string, or an empty string if the file
+    * references no material library. Note that the file must be open.
+    * @param file the OBJ file.
+    */
+   QString hashMaterialLibraries(QFile& file);
+   /**
+    * Return the name of the model cache file for a 3D model with the given hash. The
+    * name also depends on the model's material libraries, since their materials are
+    * stored in the cache, and on the import options, since they change the cached data.
+    * @param hash the hash of the file containing the 3D model.
+    * @param materialLibrariesHash the hash of the model's material libraries.
+    */
+   QString getModelCacheFilename(const QString& hash, const QString& materialLibrariesHash) const;
    /**
     * The file hash generator.
     */
@@ -52,6 +112,18 @@ private:
     * cryptographic hash (stored in the form of a string).
     */
    QHash<const QString, clockwork::system::Resource*> _resources;
+   /**
+    * True if mesh optimisation is enabled, false otherwise.
+    */
+   bool _isMeshOptimisationEnabled;
+   /**
+    * True if level of detail generation is enabled, false otherwise.
+    */
+   bool _isLevelOfDetailGenerationEnabled;
+   /**
+    * True if the model cache is enabled, false otherwise.
+    */
+   bool _isModelCacheEnabled;
    /**
     * The ResourceManager is a singleton object so only a single instance of this
     * class should be created. To prevent copying and accidental instantiation,
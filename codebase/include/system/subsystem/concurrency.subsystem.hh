@@ -26,6 +26,10 @@
 #include "subsystem.hh"
 #include "task.hh"
 #include <QThreadPool>
+#include <QMutex>
+#include <QSet>
+#include <functional>
+#include <cstddef>
 
 
 namespace clockwork {
@@ -40,13 +44,16 @@ class Services;
 class ConcurrencySubsystem : public clockwork::system::Subsystem
 {
 friend class clockwork::system::Services;
+friend class clockwork::concurrency::Task;
 public:
    /**
-    * Remove all tasks from the task queue.
+    * Cancel all tasks. Queued tasks are dropped when they are dequeued, and running
+    * tasks stop at their next cancellation checkpoint.
     */
    void purgeTasks();
    /**
-    * Submit a task to be processed.
+    * Submit a task to be processed. Queued tasks that are superseded by the new task
+    * are cancelled.
     * @param task a pointer to the task to process.
     */
    void submitTask(clockwork::concurrency::Task* const task);
@@ -59,10 +66,36 @@ public:
     * Is multitasking enabled?
     */
    bool isMultitaskingEnabled() const;
+   /**
+    * Return the largest number of threads that tasks are executed on.
+    */
+   int getMaximumThreadCount() const;
+   /**
+    * Set the largest number of threads that tasks are executed on. At least one thread
+    * is always used.
+    * @param count the number of threads.
+    */
+   void setMaximumThreadCount(const int& count);
    /**
     * Wait for all current tasks to complete.
     */
    void wait();
+   /**
+    * Split the range [0, count) into chunks of at most 'grain' elements, and apply a
+    * kernel to each chunk in parallel. The calling thread takes part in the work and
+    * this function returns once every chunk has been processed. Since idle helper
+    * threads simply find no work left, it is safe to call this from within a task.
+    * @param count the number of elements to process.
+    * @param grain the maximum number of elements processed by a single kernel call.
+    * @param kernel the function applied to each chunk, given the chunk's first and
+    * one-past-last element indices.
+    */
+   void parallelFor
+   (
+      const std::size_t& count,
+      const std::size_t& grain,
+      const std::function<void(const std::size_t& begin, const std::size_t& end)>& kernel
+   );
 private:
    /**
     * All subsystems are singletons. As such the default constructor is hidden,
@@ -79,10 +112,23 @@ private:
     * @see Subsystem::destroy.
     */
    clockwork::Error destroy() override final;
+   /**
+    * Stop tracking a task that has finished running.
+    * @param task the task.
+    */
+   void onTaskFinished(const clockwork::concurrency::Task& task);
    /**
     * A reference to the thread pool.
     */
    QThreadPool* const _threadPool;
+   /**
+    * The tasks that have been submitted and have yet to finish.
+    */
+   QSet<clockwork::concurrency::Task*> _tasks;
+   /**
+    * The mutex that guards the set of tasks.
+    */
+   QMutex _taskMutex;
 };
 
 } // namespace system
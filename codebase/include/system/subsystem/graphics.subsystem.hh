@@ -25,9 +25,27 @@
 
 #include "subsystem.hh"
 #include "framebuffer.hh"
+#include "occlusion.buffer.hh"
 #include "image.filter.hh"
 #include "scene.viewer.hh"
 #include "property.appearance.hh"
+#include "bounding.volume.hh"
+#include "render.algorithm.hh"
+#include "primitive.mode.hh"
+#include "line.algorithm.hh"
+#include "pipeline.statistics.hh"
+#include <QHash>
+#include <QRegion>
+#include <QMutex>
+#include <QWaitCondition>
+#include <memory>
+#include <vector>
+
+
+/**
+ * @see scene.hh and scene.snapshot.hh.
+ */
+namespace clockwork { namespace scene { class Scene; class SceneSnapshot; struct ObjectSnapshot; struct ViewerSnapshot; } }
 
 
 namespace clockwork {
@@ -45,17 +63,157 @@ Q_OBJECT
 friend class clockwork::system::Services;
 public:
    /**
-    * Render a scene object and its children.
+    * The result of a pick query.
+    */
+   struct PickResult
+   {
+      /**
+       * The picked object, or nullptr if no object was picked. Like an object snapshot's
+       * key, it identifies the object but may be dangling by the time the result is read,
+       * so the caller must make sure the object still exists before dereferencing it.
+       */
+      const clockwork::scene::Object* object;
+      /**
+       * The index of the picked triangle in the object's 3D model.
+       * @see TriangleHierarchy::Hit::triangle.
+       */
+      uint32_t triangle;
+      /**
+       * The barycentric coordinates of the picked point with respect to the triangle's vertices.
+       */
+      std::array<double, 3> barycentrics;
+      /**
+       * The distance between the viewer's near plane and the picked point, in world units.
+       */
+      double depth;
+      /**
+       * The picked point, in world space.
+       */
+      clockwork::Point3 position;
+   };
+   /**
+    * Return the closest object and triangle that are visible at a given pixel of a
+    * viewer's viewport. A ray is cast from the pixel through the boxes of the objects the
+    * viewer can see, and then, from front to back, through the triangle hierarchy of each
+    * object whose box it hits, until the closest hit lies in front of the remaining boxes.
+    * The query reads the most recently published scene snapshot rather than the live
+    * scene, so it never touches state that the update stage is modifying, and may be
+    * called from any thread without locking. As a result, it sees the scene as of the
+    * last completed update, and returns no object if the viewer isn't in that snapshot.
+    * @param viewer the viewer.
+    * @param x the pixel's horizontal position in the framebuffer.
+    * @param y the pixel's vertical position in the framebuffer.
+    * @see Scene::getSnapshot.
+    */
+   PickResult pick(const clockwork::scene::Viewer& viewer, const uint32_t& x, const uint32_t& y);
+   /**
+    * A frame packet holds everything that is needed to rasterise a frame once its scene
+    * has been processed. It doesn't refer to the scene, so the scene can be updated for
+    * the next frame while the packet is being rasterised.
+    */
+   struct FramePacket
+   {
+      /**
+       * The part of a frame that is drawn from a single viewer's point of view.
+       */
+      struct Pass
+      {
+         /**
+          * The region of the framebuffer that is redrawn.
+          */
+         QRegion damagedRegion;
+         /**
+          * The rectangles that the damaged region is redrawn as.
+          */
+         QVector<QRect> rectangles;
+         /**
+          * The draw commands of the objects that overlap the damaged region.
+          */
+         std::vector<clockwork::graphics::RenderAlgorithm::DrawCommand> commands;
+         /**
+          * The screen bounds of the object that created each draw command.
+          */
+         std::vector<QRect> bounds;
+         /**
+          * The viewer's post-processing filter.
+          */
+         clockwork::graphics::ImageFilter::Type imageFilter;
+         /**
+          * The viewer's viewport.
+          */
+         clockwork::graphics::Viewport viewport;
+      };
+      /**
+       * The packet's position in the order packets are processed, and rasterised.
+       */
+      uint64_t sequence = 0;
+      /**
+       * True if the whole framebuffer is cleared and redrawn, false otherwise.
+       */
+      bool isComplete = false;
+      /**
+       * The frame's passes.
+       */
+      std::vector<Pass> passes;
+      /**
+       * The pipeline statistics of each object that is redrawn in the frame.
+       */
+      QHash<const clockwork::scene::Object*, clockwork::graphics::PipelineStatistics> statistics;
+   };
+   /**
+    * Render the scene from each active viewer. This captures a snapshot of the scene,
+    * then processes it and rasterises the resulting frame packet immediately.
+    * @param scene the scene to render.
+    */
+   void renderScene(clockwork::scene::Scene& scene);
+   /**
+    * Process a snapshot of the scene from each of its viewers, i.e. determine what needs
+    * to be drawn and run the geometry stages of the render algorithms. Only the objects
+    * whose bounds are inside a viewer's view frustum are visited. If occlusion culling
+    * is enabled, the nearest large objects are rasterised into the occlusion buffer, and
+    * the objects that are hidden behind them are skipped.
+    *
+    * Only the parts of the framebuffer that have been damaged since the last frame are
+    * redrawn, i.e. the screen bounds of the objects that have moved, both before and
+    * after they moved. A viewer is redrawn entirely when its view-projection transform
+    * changes, when objects are added to or removed from the scene, or when the frame has
+    * been invalidated.
+    *
+    * Calls to this function must not overlap, and must process the snapshots in the order
+    * they were captured. If a snapshot is skipped, the objects that moved in it can't be
+    * tracked, so the next frame is redrawn entirely. The scene itself is never accessed,
+    * so it may be updated while its snapshot is processed.
+    * @param snapshot the snapshot of the scene to process.
+    * @param packet the frame packet to fill.
+    */
+   void processScene(const clockwork::scene::SceneSnapshot& snapshot, FramePacket& packet);
+   /**
+    * Rasterise and post-process a frame packet. Packets are rasterised in the order they
+    * were processed, so this blocks until the preceding packets have been rasterised or
+    * discarded.
+    * @param packet the frame packet to rasterise.
+    */
+   void rasterise(const FramePacket& packet);
+   /**
+    * Discard a frame packet that will not be rasterised. Since the framebuffer no longer
+    * reflects the scene, the packets that were processed before the next one that
+    * redraws the whole frame are discarded as well.
+    * @param packet the frame packet to discard.
+    */
+   void discard(const FramePacket& packet);
+   /**
+    * Render a scene object from a viewer's point of view.
     * @param object the scene object to render.
+    * @param viewer the viewer from which the object is observed.
     */
-   void renderObject(clockwork::scene::Object& object);
+   void renderObject(clockwork::scene::Object& object, clockwork::scene::Viewer& viewer);
    /**
     * Returns true if a scene object is inside a viewer's view frustum. In other
     * words, this member function performs view frustum culling.
     * @param object the object to check.
     * @param viewer the viewer containing the frustum which the object will be checked against.
     */
-   bool isObjectVisibleFromViewer(const clockwork::scene::Object& object, const clockwork::scene::Viewer& viewer) const;
+   bool isObjectVisibleFromViewer(const clockwork::scene::Object& object, clockwork::scene::Viewer& viewer) const;
    /**
     * Apply post-processing filters to a section of the framebuffer.
     * @param type the type of image filter to apply.
@@ -66,6 +224,31 @@ public:
     * Return the framebuffer.
     */
    clockwork::graphics::Framebuffer& getFramebuffer();
+   /**
+    * Return the occlusion buffer of the viewer that is being rendered.
+    */
+   const clockwork::graphics::OcclusionBuffer& getOcclusionBuffer() const;
+   /**
+    * Returns true if occlusion culling is enabled, false otherwise.
+    */
+   bool isOcclusionCullingEnabled() const;
+   /**
+    * Enable or disable occlusion culling.
+    * @param enable true to enable occlusion culling, false to disable it.
+    */
+   void enableOcclusionCulling(const bool enable);
+   /**
+    * Return the pipeline statistics of the last frame that was rasterised. Since only
+    * the damaged parts of a frame are redrawn, they only count the work that was done
+    * to redraw them.
+    */
+   clockwork::graphics::PipelineStatistics getFrameStatistics() const;
+   /**
+    * Return the pipeline statistics of each object that was redrawn in the last frame
+    * that was rasterised. Objects are only known by their keys, which must not be
+    * dereferenced since the objects may have been removed from the scene since.
+    */
+   QHash<const clockwork::scene::Object*, clockwork::graphics::PipelineStatistics> getObjectStatistics() const;
    /**
     * @see Framebuffer::plot(2).
     */
@@ -100,6 +283,13 @@ public:
     * Returns true if depth testing is enabled, false otherwise.
     */
    bool isDepthTestEnabled() const;
+public slots:
+   /**
+    * Force the next frame to be redrawn entirely. This must be called when a change that
+    * isn't tracked by the transform hierarchy or the viewers, such as a material change or
+    * an object being pruned, affects the rendered image.
+    */
+   void invalidateFrame();
 private:
    /**
     * All subsystems are singletons. As such the default constructor is hidden,
@@ -116,10 +306,159 @@ private:
     * @see Subsystem::destroy.
     */
    clockwork::Error destroy() override final;
+   /**
+    * The largest number of occluders that are rasterised for each viewer.
+    */
+   static constexpr std::size_t MAXIMUM_OCCLUDER_COUNT = 16;
+   /**
+    * The largest number of triangles that an occluder may have.
+    */
+   static constexpr std::size_t MAXIMUM_OCCLUDER_TRIANGLE_COUNT = 4096;
+   /**
+    * The smallest ratio of an occluder's bounding sphere radius to its distance from the viewer.
+    */
+   static constexpr double MINIMUM_OCCLUDER_SIZE = 0.1;
+   /**
+    * Fill the occlusion buffer with the nearest large objects that are visible from a viewer.
+    * @param snapshot the snapshot of the scene that is being rendered.
+    * @param viewer the viewer.
+    */
+   void updateOcclusionBuffer(const clockwork::scene::SceneSnapshot& snapshot, const clockwork::scene::ViewerSnapshot& viewer);
+   /**
+    * The state that is needed to determine which parts of a viewer's image have changed.
+    */
+   struct DamageState
+   {
+      /**
+       * True if the state describes the previous frame, false if the viewer has yet
+       * to be drawn.
+       */
+      bool isValid = false;
+      /**
+       * The viewer's view-projection transform in the previous frame.
+       */
+      clockwork::Matrix4 viewProjection;
+      /**
+       * The transform hierarchy's topology revision in the previous frame.
+       */
+      uint64_t topologyRevision = 0;
+      /**
+       * The viewer's viewport, render algorithm, primitive mode, line algorithm and
+       * image filter in the previous frame.
+       */
+      clockwork::graphics::Viewport viewport;
+      clockwork::graphics::RenderAlgorithm::Identifier renderAlgorithm;
+      clockwork::graphics::PrimitiveMode::Identifier primitiveMode;
+      clockwork::graphics::LineAlgorithm::Identifier lineAlgorithm;
+      clockwork::graphics::ImageFilter::Type imageFilter;
+      /**
+       * The framebuffer's dimensions in the previous frame.
+       */
+      uint32_t framebufferWidth = 0;
+      uint32_t framebufferHeight = 0;
+      /**
+       * The screen bounds of each object in the previous frame.
+       */
+      QHash<const clockwork::scene::Object*, QRect> screenBounds;
+   };
+   /**
+    * The largest number of rectangles a viewer's damaged region is redrawn as. Beyond
+    * this, the region's bounding rectangle is redrawn instead.
+    */
+   static constexpr int MAXIMUM_DAMAGE_RECTANGLE_COUNT = 8;
+   /**
+    * Return the region of the framebuffer that must be redrawn for a viewer, and update
+    * the viewer's damage state.
+    * @param snapshot the snapshot of the scene that is being rendered.
+    * @param viewer the viewer.
+    */
+   QRegion updateDamagedRegion(const clockwork::scene::SceneSnapshot& snapshot, const clockwork::scene::ViewerSnapshot& viewer);
+   /**
+    * Return the rectangle of the framebuffer that is covered by a viewport.
+    * @param viewport the viewport.
+    */
+   QRect getViewportRectangle(const clockwork::graphics::Viewport& viewport) const;
+   /**
+    * Return the rectangle of the framebuffer that a bounding box covers when it is
+    * projected into a viewport. The rectangle is conservative, and is empty if the box is.
+    * @param box the bounding box.
+    * @param VIEWPROJECTION the view-projection transform.
+    * @param viewport the viewport.
+    */
+   QRect getScreenBounds
+   (
+      const clockwork::graphics::BoundingBox& box,
+      const clockwork::Matrix4& VIEWPROJECTION,
+      const clockwork::graphics::Viewport& viewport
+   ) const;
    /**
     * The framebuffer.
     */
    clockwork::graphics::Framebuffer _framebuffer;
+   /**
+    * The occlusion buffer.
+    */
+   clockwork::graphics::OcclusionBuffer _occlusionBuffer;
+   /**
+    * True if occlusion culling is enabled, false otherwise.
+    */
+   bool _isOcclusionCullingEnabled;
+   /**
+    * The damage state of each active viewer.
+    */
+   QHash<const clockwork::scene::Viewer*, DamageState> _damageStates;
+   /**
+    * True if the next frame must be redrawn entirely, false otherwise.
+    */
+   std::atomic<bool> _isFrameInvalidated;
+   /**
+    * The sequence number of the last snapshot that was processed.
+    */
+   uint64_t _lastSnapshotSequence;
+   /**
+    * The level of detail that was last selected for each object, for each viewer. Since
+    * objects are only known by their keys, the selections are forgotten when objects are
+    * added to or removed from the scene.
+    */
+   QHash<const clockwork::scene::Viewer*, QHash<const clockwork::scene::Object*, std::size_t>> _levelsOfDetail;
+   /**
+    * The topology revision of the snapshot that the levels of detail were selected for.
+    */
+   uint64_t _levelOfDetailRevision;
+   /**
+    * The sequence number of the next frame packet to process.
+    */
+   uint64_t _nextPacketSequence;
+   /**
+    * The sequence number of the next frame packet to rasterise.
+    */
+   uint64_t _nextRasterSequence;
+   /**
+    * True if a packet has been discarded since the whole frame was last redrawn, in
+    * which case incomplete packets cannot be rasterised.
+    */
+   bool _isRasterStale;
+   /**
+    * The mutex that serialises rasterisation.
+    */
+   QMutex _rasterMutex;
+   /**
+    * The condition that is signalled when a packet has been rasterised or discarded.
+    */
+   QWaitCondition _rasterTurn;
+   /**
+    * The pipeline statistics of the last frame that was rasterised.
+    */
+   clockwork::graphics::PipelineStatistics _frameStatistics;
+   /**
+    * The pipeline statistics of each object in the last frame that was rasterised.
+    */
+   QHash<const clockwork::scene::Object*, clockwork::graphics::PipelineStatistics> _objectStatistics;
+   /**
+    * The mutex that guards the statistics, which are written by the renderer and read
+    * by the user interface.
+    */
+   mutable QMutex _statisticsMutex;
 };
 
 } // namespace system
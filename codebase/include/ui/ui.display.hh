@@ -53,6 +53,17 @@ private:
     * The custom paint event loads data from a framebuffer and displays it.
     */
    virtual void paintEvent(QPaintEvent* event) override final;
+#ifdef CLOCKWORK_PROFILER
+   /**
+    * Paint the heads-up display, which shows the profiler's frame and stage times,
+    * and a graph of the most recent frames.
+    */
+   void paintHeadsUpDisplay();
+   /**
+    * Return the rectangle that is covered by the heads-up display.
+    */
+   static QRect getHeadsUpDisplayRectangle();
+#endif
    /**
     * The painter.
     */
@@ -64,7 +75,7 @@ private:
    /**
     * A reference to the framebuffer containing the rendered scene.
     */
-   const clockwork::graphics::Framebuffer& _framebuffer;
+   clockwork::graphics::Framebuffer& _framebuffer;
    /**
     * A buffer that stores a copy of the framebuffer's pixels.
     */
@@ -74,7 +85,8 @@ private slots:
     * This slot must be called when a complete frame is available for drawing.
     * It will upload the framebuffer's current pixel buffer into this display
     * device's output buffer, a buffer which will then be used for future
-    * paint events until it gets updated.
+    * paint events until it gets updated. Only the parts of the display that
+    * cover the framebuffer's damaged region are repainted.
     */
    void onFrameReady();
 };
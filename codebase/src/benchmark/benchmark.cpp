@@ -0,0 +1,383 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmark.hh"
+#include "services.hh"
+#include "scene.hh"
+#include "scene.viewer.hh"
+#include "predefs.hh"
+#include "scene.generator.hh"
+#include "property.appearance.hh"
+#include "tostring.hh"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QHash>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+using clockwork::benchmark::Benchmark;
+using clockwork::graphics::Framebuffer;
+using clockwork::graphics::Model3D;
+using clockwork::graphics::RenderAlgorithm;
+using clockwork::graphics::RenderAlgorithmFactory;
+using clockwork::scene::SceneGenerator;
+using clockwork::system::Services;
+
+
+namespace {
+/**
+ * The ratio of a circle's circumference to its diameter.
+ */
+constexpr double PI = 3.14159265358979323846;
+/**
+ * Create a scene object with a given name, that is drawn with a given 3D model.
+ */
+clockwork::scene::Object*
+createObject(const QString& name, const Model3D* const model3D)
+{
+   using clockwork::scene::Appearance;
+   using clockwork::scene::Property;
+
+   auto* const object = new clockwork::scene::Object(name);
+   static_cast<Appearance&>(object->addProperty(Property::Identifier::Appearance)).setModel3D(model3D);
+   return object;
+}
+/**
+ * Return the key that identifies a benchmark case in a set of results.
+ */
+QString
+getKey(const QString& scene, const QString& algorithm, const QString& resolution, const int& threadCount)
+{
+   return QString("%1 / %2 / %3 / %4 threads").arg(scene, algorithm, resolution).arg(threadCount);
+}
+} // namespace
+
+
+Benchmark::Benchmark()
+{
+   auto& graph = clockwork::scene::Scene::getInstance().getGraph();
+
+   // Blender's Suzanne (about a thousand triangles) spins on the spot.
+   auto* const suzanne = &clockwork::scene::predefs::Suzanne::getInstance();
+   _scenes.push_back
+   ({
+      "Suzanne",
+      {suzanne},
+      [suzanne](const double& t) { suzanne->setRotation(-180, 360.0 * t, 0); }
+   });
+
+   // A single dense sphere (about 32 thousand triangles) spins and sways across the screen.
+   _models.push_back(SceneGenerator::createSphere(128, 128));
+   auto* const sphere = createObject("Benchmark Sphere", _models.back().get());
+   sphere->setScale(0.8, 0.8, 0.8);
+   graph.addChild(sphere);
+   _roots.push_back(sphere);
+   _scenes.push_back
+   ({
+      "Sphere",
+      {sphere},
+      [sphere](const double& t)
+      {
+         sphere->setPosition(0.2 * std::sin(2.0 * PI * t), 0.0, 0.0);
+         sphere->setRotation(0, 360.0 * t, 0);
+      }
+   });
+
+   // A grid of small spheres (100 objects of about 200 triangles each) turns as a whole,
+   // which exercises the per-object costs and the transform hierarchy.
+   _models.push_back(SceneGenerator::createSphere(16, 8));
+   auto* const grid = new clockwork::scene::Object("Benchmark Sphere Grid");
+   std::vector<clockwork::scene::Object*> spheres = {grid};
+   constexpr int GRID_SIZE = 10;
+   for (int i = 0; i < GRID_SIZE; ++i)
+   {
+      for (int j = 0; j < GRID_SIZE; ++j)
+      {
+         auto* const object = createObject(QString("Benchmark Sphere %1").arg(i * GRID_SIZE + j), _models.back().get());
+         object->setPosition(-0.8 + 1.6 * i / (GRID_SIZE - 1), -0.8 + 1.6 * j / (GRID_SIZE - 1), 0.0);
+         object->setScale(0.07, 0.07, 0.07);
+         grid->addChild(object);
+         spheres.push_back(object);
+      }
+   }
+   graph.addChild(grid);
+   _roots.push_back(grid);
+   _scenes.push_back
+   ({
+      "Sphere Grid",
+      spheres,
+      [grid](const double& t) { grid->setRotation(0, 0, 360.0 * t); }
+   });
+
+   select(nullptr);
+}
+
+
+Benchmark::~Benchmark()
+{
+   // Suzanne belongs to the application's scene, so she is restored.
+   select(&_scenes.front());
+
+   auto& graph = clockwork::scene::Scene::getInstance().getGraph();
+   for (auto* const root : _roots)
+      graph.removeChild(root);
+}
+
+
+QString
+Benchmark::addScene(const SceneGenerator::Options& options)
+{
+   auto& graph = clockwork::scene::Scene::getInstance().getGraph();
+   _generators.emplace_back(new SceneGenerator(options, graph));
+
+   auto* const generator = _generators.back().get();
+   const auto& name = QString("Generated (%1)").arg(SceneGenerator::toString(generator->getOptions()));
+   _scenes.push_back
+   ({
+      name,
+      generator->getObjects(),
+      [generator](const double& t) { generator->animate(t); }
+   });
+
+   select(nullptr);
+   return name;
+}
+
+
+QStringList
+Benchmark::getSceneNames() const
+{
+   QStringList names;
+   for (const auto& scene : _scenes)
+      names << scene.name;
+
+   return names;
+}
+
+
+std::vector<Benchmark::Result>
+Benchmark::run(const Options& options, std::ostream& progress)
+{
+   const auto& algorithms = options.algorithms.isEmpty() ? RenderAlgorithmFactory::getInstance().getKeys() : options.algorithms;
+   const auto& resolutions = options.resolutions.isEmpty() ? Framebuffer::getAvailableResolutions() : options.resolutions;
+   const auto& threadCounts = options.threadCounts.isEmpty() ? QList<int>({Services::Concurrency.getMaximumThreadCount()}) : options.threadCounts;
+   const auto frameCount = std::max(options.frameCount, 1U);
+
+   auto& framebuffer = Services::Graphics.getFramebuffer();
+   const auto originalResolution = framebuffer.getResolution();
+   const auto originalThreadCount = Services::Concurrency.getMaximumThreadCount();
+
+   std::vector<Result> results;
+   for (const auto& scene : _scenes)
+   {
+      if (!options.scenes.isEmpty() && !options.scenes.contains(scene.name, Qt::CaseInsensitive))
+         continue;
+
+      select(&scene);
+      for (const auto& algorithm : algorithms)
+      {
+         for (auto* const viewer : clockwork::scene::Scene::getInstance().getActiveViewers())
+            viewer->setRenderAlgorithm(algorithm);
+
+         for (const auto& resolution : resolutions)
+         {
+            framebuffer.resize(resolution);
+            const auto& pixelCount = static_cast<double>(framebuffer.getWidth()) * framebuffer.getHeight();
+
+            for (const auto& threadCount : threadCounts)
+            {
+               Services::Concurrency.setMaximumThreadCount(threadCount);
+
+               // The warm-up frames follow the beginning of the path, so that the measured
+               // frames start from the same state in every case.
+               for (unsigned int i = 0; i < options.warmupFrameCount; ++i)
+                  draw(scene, static_cast<double>(i % frameCount) / frameCount);
+
+               uint64_t triangleCount = 0;
+               QElapsedTimer timer;
+               timer.start();
+               for (unsigned int i = 0; i < frameCount; ++i)
+               {
+                  draw(scene, static_cast<double>(i) / frameCount);
+                  triangleCount += Services::Graphics.getFrameStatistics().verticesIn / 3;
+               }
+               const auto& seconds = 1e-9 * timer.nsecsElapsed();
+
+               Result result;
+               result.scene = scene.name;
+               result.algorithm = algorithm;
+               result.resolution = resolution;
+               result.threadCount = threadCount;
+               result.millisecondsPerFrame = 1000.0 * seconds / frameCount;
+               result.trianglesPerSecond = 1e-6 * triangleCount / seconds;
+               result.pixelsPerSecond = 1e-6 * pixelCount * frameCount / seconds;
+               result.scalingEfficiency = 1.0;
+               results.push_back(result);
+
+               progress
+               << std::fixed << std::setprecision(2)
+               << getKey(result.scene, clockwork::toString(algorithm), clockwork::toString(resolution), threadCount).toStdString()
+               << ": " << result.millisecondsPerFrame << " ms/frame, "
+               << result.trianglesPerSecond << " Mtri/s, "
+               << result.pixelsPerSecond << " Mpix/s" << std::endl;
+            }
+         }
+      }
+   }
+   select(nullptr);
+
+   // Compare each case with the same case at the lowest thread count.
+   for (auto& result : results)
+   {
+      const Result* reference = nullptr;
+      for (const auto& other : results)
+      {
+         if
+         (
+            other.scene == result.scene &&
+            other.algorithm == result.algorithm &&
+            other.resolution == result.resolution &&
+            (reference == nullptr || other.threadCount < reference->threadCount)
+         )
+            reference = &other;
+      }
+      if (reference != nullptr && result.millisecondsPerFrame > 0.0)
+      {
+         const auto& speedup = reference->millisecondsPerFrame / result.millisecondsPerFrame;
+         result.scalingEfficiency = speedup * reference->threadCount / result.threadCount;
+      }
+   }
+
+   framebuffer.resize(originalResolution);
+   Services::Concurrency.setMaximumThreadCount(originalThreadCount);
+   Services::Graphics.invalidateFrame();
+
+   return results;
+}
+
+
+QJsonObject
+Benchmark::toJson(const Options& options, const std::vector<Result>& results)
+{
+   QJsonArray array;
+   for (const auto& result : results)
+   {
+      QJsonObject object;
+      object["scene"] = result.scene;
+      object["algorithm"] = clockwork::toString(result.algorithm);
+      object["resolution"] = clockwork::toString(result.resolution);
+      object["threads"] = result.threadCount;
+      object["msPerFrame"] = result.millisecondsPerFrame;
+      object["mtrisPerSecond"] = result.trianglesPerSecond;
+      object["mpixPerSecond"] = result.pixelsPerSecond;
+      object["scalingEfficiency"] = result.scalingEfficiency;
+      array.append(object);
+   }
+
+   QJsonObject output;
+   output["frames"] = static_cast<int>(options.frameCount);
+   output["warmupFrames"] = static_cast<int>(options.warmupFrameCount);
+   output["results"] = array;
+
+   return output;
+}
+
+
+bool
+Benchmark::compare
+(
+   const std::vector<Result>& results,
+   const QJsonObject& baseline,
+   const double& tolerance,
+   std::ostream& report
+)
+{
+   QHash<QString, double> baselineTimes;
+   for (const auto& value : baseline["results"].toArray())
+   {
+      const auto& object = value.toObject();
+      const auto& key = getKey
+      (
+         object["scene"].toString(),
+         object["algorithm"].toString(),
+         object["resolution"].toString(),
+         object["threads"].toInt()
+      );
+      baselineTimes.insert(key, object["msPerFrame"].toDouble());
+   }
+
+   auto passed = true;
+   report << std::fixed << std::setprecision(2);
+   for (const auto& result : results)
+   {
+      const auto& key =
+      getKey(result.scene, clockwork::toString(result.algorithm), clockwork::toString(result.resolution), result.threadCount);
+
+      const auto& it = baselineTimes.constFind(key);
+      if (it == baselineTimes.constEnd() || it.value() <= 0.0)
+      {
+         report << key.toStdString() << ": " << result.millisecondsPerFrame << " ms (no baseline)" << std::endl;
+         continue;
+      }
+
+      const auto& change = result.millisecondsPerFrame / it.value() - 1.0;
+      const auto& isRegression = change > tolerance;
+      report
+      << key.toStdString() << ": " << result.millisecondsPerFrame << " ms (baseline " << it.value() << " ms, "
+      << std::showpos << 100.0 * change << std::noshowpos << "%)" << (isRegression ? " REGRESSION" : "") << std::endl;
+
+      passed = passed && !isRegression;
+   }
+   return passed;
+}
+
+
+void
+Benchmark::select(const Scene* const scene)
+{
+   for (const auto& other : _scenes)
+   {
+      for (auto* const object : other.objects)
+         object->setPruned(&other != scene);
+   }
+}
+
+
+void
+Benchmark::draw(const Scene& scene, const double& t)
+{
+   auto& sceneInstance = clockwork::scene::Scene::getInstance();
+
+   // Frames are drawn one after the other, like the frame loop would with a single frame
+   // in flight, but without pacing.
+   scene.path(t);
+
+   auto& transformHierarchy = sceneInstance.getTransformHierarchy();
+   transformHierarchy.update();
+   sceneInstance.getBoundingVolumeHierarchy().update(transformHierarchy);
+
+   // Every frame is redrawn entirely, so that the cases measure the same amount of work.
+   Services::Graphics.invalidateFrame();
+   Services::Graphics.renderScene(sceneInstance);
+}
@@ -0,0 +1,230 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "micro.benchmark.hh"
+#include <QHash>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QThread>
+#include <QDateTime>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+using clockwork::benchmark::MicroBenchmark;
+
+
+namespace {
+/**
+ * The largest number of iterations a benchmark's loop runs.
+ */
+constexpr uint64_t MAXIMUM_ITERATION_COUNT = 1000000000;
+/**
+ * The largest factor by which the number of iterations grows between two runs.
+ */
+constexpr double MAXIMUM_GROWTH = 10.0;
+} // namespace
+
+
+MicroBenchmark::State::State(const uint64_t& iterationCount) :
+_iterationCount(iterationCount),
+_remainingIterationCount(iterationCount),
+_itemsPerIteration(0),
+_start(0),
+_elapsed(0)
+{}
+
+
+const uint64_t&
+MicroBenchmark::State::getIterationCount() const
+{
+   return _iterationCount;
+}
+
+
+void
+MicroBenchmark::State::setItemsPerIteration(const uint64_t& count)
+{
+   _itemsPerIteration = count;
+}
+
+
+void
+MicroBenchmark::State::pauseTiming()
+{
+   _elapsed += MicroBenchmark::now() - _start;
+}
+
+
+void
+MicroBenchmark::State::resumeTiming()
+{
+   _start = MicroBenchmark::now();
+}
+
+
+bool
+MicroBenchmark::add(const QString& name, const Function& function)
+{
+   getEntries().push_back({name, function});
+   return true;
+}
+
+
+std::vector<MicroBenchmark::Result>
+MicroBenchmark::run(const QString& filter, const double& minimumTime, std::ostream& output)
+{
+   const QRegularExpression expression(filter);
+   const auto& minimumNanoseconds = 1e9 * minimumTime;
+
+   output << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(16) << "Time" << std::setw(16) << "Iterations" << std::setw(20) << "Items/s" << std::endl;
+   output << std::string(100, '-') << std::endl;
+
+   std::vector<Result> results;
+   for (const auto& entry : getEntries())
+   {
+      if (!expression.match(entry.name).hasMatch())
+         continue;
+
+      // Run the benchmark with more and more iterations, until it runs for long enough
+      // to be measured. The next number of iterations is predicted from the last run.
+      uint64_t iterationCount = 1;
+      for (;;)
+      {
+         State state(iterationCount);
+         entry.function(state);
+
+         const auto& elapsed = static_cast<double>(std::max<int64_t>(state._elapsed, 1));
+         if (elapsed >= minimumNanoseconds || iterationCount >= MAXIMUM_ITERATION_COUNT)
+         {
+            Result result;
+            result.name = entry.name;
+            result.iterationCount = iterationCount;
+            result.nanosecondsPerIteration = elapsed / iterationCount;
+            result.itemsPerSecond = 1e9 * state._itemsPerIteration * iterationCount / elapsed;
+            results.push_back(result);
+
+            output
+            << std::left << std::setw(48) << result.name.toStdString() << std::right
+            << std::fixed << std::setprecision(2) << std::setw(13) << result.nanosecondsPerIteration << " ns"
+            << std::setw(16) << result.iterationCount;
+            if (result.itemsPerSecond > 0.0)
+               output << std::setw(18) << 1e-6 * result.itemsPerSecond << " M";
+            output << std::endl;
+            break;
+         }
+
+         const auto growth = std::min(1.4 * minimumNanoseconds / elapsed, MAXIMUM_GROWTH);
+         iterationCount = std::min
+         (
+            std::max(static_cast<uint64_t>(growth * iterationCount), iterationCount + 1),
+            MAXIMUM_ITERATION_COUNT
+         );
+      }
+   }
+   return results;
+}
+
+
+QJsonObject
+MicroBenchmark::toJson(const std::vector<Result>& results)
+{
+   QJsonObject context;
+   context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+   context["num_cpus"] = QThread::idealThreadCount();
+
+   QJsonArray benchmarks;
+   for (const auto& result : results)
+   {
+      QJsonObject object;
+      object["name"] = result.name;
+      object["iterations"] = static_cast<double>(result.iterationCount);
+      object["real_time"] = result.nanosecondsPerIteration;
+      object["time_unit"] = "ns";
+      if (result.itemsPerSecond > 0.0)
+         object["items_per_second"] = result.itemsPerSecond;
+      benchmarks.append(object);
+   }
+
+   QJsonObject output;
+   output["context"] = context;
+   output["benchmarks"] = benchmarks;
+
+   return output;
+}
+
+
+bool
+MicroBenchmark::compare
+(
+   const std::vector<Result>& results,
+   const QJsonObject& baseline,
+   const double& tolerance,
+   std::ostream& report
+)
+{
+   QHash<QString, double> baselineTimes;
+   for (const auto& value : baseline["benchmarks"].toArray())
+   {
+      const auto& object = value.toObject();
+      baselineTimes.insert(object["name"].toString(), object["real_time"].toDouble());
+   }
+
+   auto passed = true;
+   report << std::fixed << std::setprecision(2);
+   for (const auto& result : results)
+   {
+      const auto& it = baselineTimes.constFind(result.name);
+      if (it == baselineTimes.constEnd() || it.value() <= 0.0)
+      {
+         report << result.name.toStdString() << ": " << result.nanosecondsPerIteration << " ns (no baseline)" << std::endl;
+         continue;
+      }
+
+      const auto& change = result.nanosecondsPerIteration / it.value() - 1.0;
+      const auto& isRegression = change > tolerance;
+      report
+      << result.name.toStdString() << ": " << result.nanosecondsPerIteration << " ns (baseline " << it.value() << " ns, "
+      << std::showpos << 100.0 * change << std::noshowpos << "%)" << (isRegression ? " REGRESSION" : "") << std::endl;
+
+      passed = passed && !isRegression;
+   }
+   return passed;
+}
+
+
+std::vector<MicroBenchmark::Entry>&
+MicroBenchmark::getEntries()
+{
+   // The entries are created on first use, since benchmarks are registered during the
+   // static initialisation of other translation units.
+   static std::vector<Entry> entries;
+   return entries;
+}
+
+
+int64_t
+MicroBenchmark::now()
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
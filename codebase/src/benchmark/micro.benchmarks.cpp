@@ -0,0 +1,431 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "micro.benchmark.hh"
+#include "matrix4.hh"
+#include "point3.hh"
+#include "point4.hh"
+#include "vector3.hh"
+#include "vertex.hh"
+#include "fragment.hh"
+#include "color.hh"
+#include "framebuffer.hh"
+#include <array>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using clockwork::benchmark::MicroBenchmark;
+using clockwork::benchmark::doNotOptimize;
+using clockwork::graphics::ColorRGBA;
+using clockwork::graphics::Fragment;
+using clockwork::graphics::Framebuffer;
+using clockwork::graphics::Vertex;
+using clockwork::Matrix4;
+using clockwork::Point3;
+using clockwork::Point4;
+using clockwork::Vector3;
+
+
+namespace {
+/**
+ * The number of elements in a batch.
+ */
+constexpr std::size_t BATCH_SIZE = 1024;
+/**
+ * Return a model transform with a translation, a rotation and a non-uniform scale, so
+ * that none of its elements are trivial.
+ */
+Matrix4
+getTransform()
+{
+   return Matrix4::model(Point3(1.0, -2.0, 3.0), Vector3(30.0, 45.0, 60.0), Vector3(1.0, 2.0, 0.5));
+}
+/**
+ * Return a batch of homogeneous points.
+ */
+std::vector<Point4>
+getPoints()
+{
+   std::vector<Point4> points;
+   points.reserve(BATCH_SIZE);
+   for (std::size_t i = 0; i < BATCH_SIZE; ++i)
+      points.emplace_back(0.001 * i, 1.0 - 0.002 * i, 0.5 + 0.0005 * i, 1.0);
+
+   return points;
+}
+/**
+ * Return a batch of colors, some of which are out of the [0, 1] range.
+ */
+std::vector<ColorRGBA>
+getColors()
+{
+   std::vector<ColorRGBA> colors;
+   colors.reserve(BATCH_SIZE);
+   for (std::size_t i = 0; i < BATCH_SIZE; ++i)
+      colors.emplace_back((i % 300) / 256.0f, (i % 7) / 6.0f, 1.0f - (i % 13) / 12.0f, (i % 2) ? 1.0f : 0.5f);
+
+   return colors;
+}
+/**
+ * A batch of homogeneous points, stored as a structure of arrays.
+ */
+struct PointBatch
+{
+   explicit PointBatch(const std::vector<Point4>& points)
+   {
+      for (const auto& point : points)
+      {
+         x.push_back(point.x);
+         y.push_back(point.y);
+         z.push_back(point.z);
+         w.push_back(point.w);
+      }
+   }
+   std::vector<double> x;
+   std::vector<double> y;
+   std::vector<double> z;
+   std::vector<double> w;
+};
+
+
+void
+multiplyMatrices(MicroBenchmark::State& state)
+{
+   auto A = getTransform();
+   auto B = Matrix4::inverse(A);
+   while (state.keepRunning())
+   {
+      doNotOptimize(A);
+      doNotOptimize(B);
+      const auto& C = A * B;
+      doNotOptimize(C);
+   }
+}
+CLOCKWORK_BENCHMARK(multiplyMatrices, "Matrix4 * Matrix4");
+
+
+void
+multiplyPoint4(MicroBenchmark::State& state)
+{
+   auto M = getTransform();
+   auto p = Point4(0.25, -0.5, 0.75, 1.0);
+   while (state.keepRunning())
+   {
+      doNotOptimize(M);
+      doNotOptimize(p);
+      const auto& q = M * p;
+      doNotOptimize(q);
+   }
+}
+CLOCKWORK_BENCHMARK(multiplyPoint4, "Matrix4 * Point4");
+
+
+void
+multiplyPoint3(MicroBenchmark::State& state)
+{
+   auto M = getTransform();
+   auto p = Point3(0.25, -0.5, 0.75);
+   while (state.keepRunning())
+   {
+      doNotOptimize(M);
+      doNotOptimize(p);
+      const auto& q = M * p;
+      doNotOptimize(q);
+   }
+}
+CLOCKWORK_BENCHMARK(multiplyPoint3, "Matrix4 * Point3");
+
+
+void
+invertMatrix(MicroBenchmark::State& state)
+{
+   auto M = getTransform();
+   while (state.keepRunning())
+   {
+      doNotOptimize(M);
+      const auto& inverse = Matrix4::inverse(M);
+      doNotOptimize(inverse);
+   }
+}
+CLOCKWORK_BENCHMARK(invertMatrix, "Matrix4::inverse");
+
+
+void
+createModelMatrix(MicroBenchmark::State& state)
+{
+   auto position = Point3(1.0, -2.0, 3.0);
+   auto rotation = Vector3(30.0, 45.0, 60.0);
+   auto scale = Vector3(1.0, 2.0, 0.5);
+   while (state.keepRunning())
+   {
+      doNotOptimize(position);
+      doNotOptimize(rotation);
+      doNotOptimize(scale);
+      const auto& M = Matrix4::model(position, rotation, scale);
+      doNotOptimize(M);
+   }
+}
+CLOCKWORK_BENCHMARK(createModelMatrix, "Matrix4::model");
+
+
+void
+interpolateVertices(MicroBenchmark::State& state)
+{
+   auto start = Vertex(Point4(0.0, 0.0, 0.1, 1.0));
+   auto end = Vertex(Point4(640.0, 480.0, 0.9, 1.0));
+   start.color = ColorRGBA(1.0f, 0.0f, 0.0f);
+   end.color = ColorRGBA(0.0f, 0.0f, 1.0f);
+   auto p = 0.375;
+   while (state.keepRunning())
+   {
+      doNotOptimize(start);
+      doNotOptimize(end);
+      doNotOptimize(p);
+      const auto& vertex = Vertex::interpolate(start, end, p);
+      doNotOptimize(vertex);
+   }
+}
+CLOCKWORK_BENCHMARK(interpolateVertices, "Vertex::interpolate");
+
+
+void
+interpolateFragments(MicroBenchmark::State& state)
+{
+   auto start = Fragment(Vertex(Point4(0.0, 0.0, 0.1, 1.0)));
+   auto end = Fragment(Vertex(Point4(640.0, 480.0, 0.9, 1.0)));
+   start.color = ColorRGBA(1.0f, 0.0f, 0.0f);
+   end.color = ColorRGBA(0.0f, 0.0f, 1.0f);
+   auto p = 0.375;
+   while (state.keepRunning())
+   {
+      doNotOptimize(start);
+      doNotOptimize(end);
+      doNotOptimize(p);
+      const auto& fragment = Fragment::interpolate(start, end, p);
+      doNotOptimize(fragment);
+   }
+}
+CLOCKWORK_BENCHMARK(interpolateFragments, "Fragment::interpolate");
+
+
+void
+mergeColor(MicroBenchmark::State& state)
+{
+   auto color = ColorRGBA(0.2f, 0.4f, 0.6f, 1.0f);
+   while (state.keepRunning())
+   {
+      doNotOptimize(color);
+      const auto& ARGB = ColorRGBA::merge(color);
+      doNotOptimize(ARGB);
+   }
+}
+CLOCKWORK_BENCHMARK(mergeColor, "ColorRGBA::merge");
+
+
+void
+splitColor(MicroBenchmark::State& state)
+{
+   auto ARGB = static_cast<uint32_t>(0xff336699);
+   while (state.keepRunning())
+   {
+      doNotOptimize(ARGB);
+      const auto& color = ColorRGBA::split(ARGB);
+      doNotOptimize(color);
+   }
+}
+CLOCKWORK_BENCHMARK(splitColor, "ColorRGBA::split");
+
+
+void
+clearFramebuffer(MicroBenchmark::State& state)
+{
+   Framebuffer framebuffer(Framebuffer::Resolution::XGA);
+   state.setItemsPerIteration(framebuffer.getWidth() * framebuffer.getHeight());
+   while (state.keepRunning())
+   {
+      framebuffer.clear();
+      doNotOptimize(*framebuffer.getPixelBuffer());
+   }
+}
+CLOCKWORK_BENCHMARK(clearFramebuffer, "Framebuffer::clear (XGA)");
+
+
+void
+clearFramebufferRectangle(MicroBenchmark::State& state)
+{
+   Framebuffer framebuffer(Framebuffer::Resolution::XGA);
+   const QRect rectangle(128, 128, 256, 256);
+   state.setItemsPerIteration(rectangle.width() * rectangle.height());
+   while (state.keepRunning())
+   {
+      framebuffer.clear(rectangle);
+      doNotOptimize(*framebuffer.getPixelBuffer());
+   }
+}
+CLOCKWORK_BENCHMARK(clearFramebufferRectangle, "Framebuffer::clear (256x256 rectangle)");
+
+
+// The batch variants transform whole arrays at once. The structure-of-arrays and SSE2
+// kernels are the reference implementations of the proposed batch and SIMD APIs, which
+// a replacement must at least match.
+void
+multiplyPoint4Batch(MicroBenchmark::State& state)
+{
+   const auto& M = getTransform();
+   const auto& points = getPoints();
+   std::vector<Point4> output(points.size());
+   state.setItemsPerIteration(points.size());
+   while (state.keepRunning())
+   {
+      for (std::size_t i = 0; i < points.size(); ++i)
+         output[i] = M * points[i];
+      doNotOptimize(output.front());
+   }
+}
+CLOCKWORK_BENCHMARK(multiplyPoint4Batch, "Matrix4 * Point4 [batch]");
+
+
+void
+multiplyPoint4BatchSoA(MicroBenchmark::State& state)
+{
+   const auto& M = getTransform();
+   std::array<double, 16> m;
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      for (unsigned int j = 0; j < 4; ++j)
+         m[4 * i + j] = M.get(i, j);
+   }
+
+   const PointBatch input(getPoints());
+   PointBatch output(getPoints());
+   state.setItemsPerIteration(BATCH_SIZE);
+   while (state.keepRunning())
+   {
+      for (std::size_t k = 0; k < BATCH_SIZE; ++k)
+      {
+         const auto& x = input.x[k];
+         const auto& y = input.y[k];
+         const auto& z = input.z[k];
+         const auto& w = input.w[k];
+         output.x[k] = m[0] * x + m[1] * y + m[2] * z + m[3] * w;
+         output.y[k] = m[4] * x + m[5] * y + m[6] * z + m[7] * w;
+         output.z[k] = m[8] * x + m[9] * y + m[10] * z + m[11] * w;
+         output.w[k] = m[12] * x + m[13] * y + m[14] * z + m[15] * w;
+      }
+      doNotOptimize(output.x.front());
+   }
+}
+CLOCKWORK_BENCHMARK(multiplyPoint4BatchSoA, "Matrix4 * Point4 [batch, SoA]");
+
+
+void
+mergeColorBatch(MicroBenchmark::State& state)
+{
+   const auto& colors = getColors();
+   std::vector<uint32_t> output(colors.size());
+   state.setItemsPerIteration(colors.size());
+   while (state.keepRunning())
+   {
+      for (std::size_t i = 0; i < colors.size(); ++i)
+         output[i] = ColorRGBA::merge(colors[i]);
+      doNotOptimize(output.front());
+   }
+}
+CLOCKWORK_BENCHMARK(mergeColorBatch, "ColorRGBA::merge [batch]");
+
+
+#ifdef __SSE2__
+void
+multiplyPoint4BatchSSE2(MicroBenchmark::State& state)
+{
+   const auto& M = getTransform();
+   __m128d m[16];
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      for (unsigned int j = 0; j < 4; ++j)
+         m[4 * i + j] = _mm_set1_pd(M.get(i, j));
+   }
+
+   // Two points are transformed at a time.
+   const PointBatch input(getPoints());
+   PointBatch output(getPoints());
+   state.setItemsPerIteration(BATCH_SIZE);
+   while (state.keepRunning())
+   {
+      for (std::size_t k = 0; k < BATCH_SIZE; k += 2)
+      {
+         const auto x = _mm_loadu_pd(&input.x[k]);
+         const auto y = _mm_loadu_pd(&input.y[k]);
+         const auto z = _mm_loadu_pd(&input.z[k]);
+         const auto w = _mm_loadu_pd(&input.w[k]);
+         const std::array<double*, 4> rows = {{&output.x[k], &output.y[k], &output.z[k], &output.w[k]}};
+         for (unsigned int i = 0; i < 4; ++i)
+         {
+            const auto& xy = _mm_add_pd(_mm_mul_pd(m[4 * i], x), _mm_mul_pd(m[4 * i + 1], y));
+            const auto& zw = _mm_add_pd(_mm_mul_pd(m[4 * i + 2], z), _mm_mul_pd(m[4 * i + 3], w));
+            _mm_storeu_pd(rows[i], _mm_add_pd(xy, zw));
+         }
+      }
+      doNotOptimize(output.x.front());
+   }
+}
+CLOCKWORK_BENCHMARK(multiplyPoint4BatchSSE2, "Matrix4 * Point4 [batch, SSE2]");
+
+
+void
+mergeColorBatchSSE2(MicroBenchmark::State& state)
+{
+   const auto& colors = getColors();
+   std::vector<uint32_t> output(colors.size());
+   state.setItemsPerIteration(colors.size());
+
+   // Four colors are merged at a time. Each color's channels are reordered from RGBA to
+   // BGRA, which is the memory layout of an ARGB value, then scaled, rounded half away
+   // from zero like ColorRGBA::merge, and packed into bytes with saturation.
+   const auto& zero = _mm_setzero_ps();
+   const auto& half = _mm_set1_ps(0.5f);
+   const auto& scale = _mm_set1_ps(255.0f);
+   while (state.keepRunning())
+   {
+      for (std::size_t k = 0; k < colors.size(); k += 4)
+      {
+         __m128i channels[4];
+         for (unsigned int i = 0; i < 4; ++i)
+         {
+            auto color = _mm_loadu_ps(&colors[k + i].red);
+            color = _mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 0, 1, 2));
+            color = _mm_add_ps(_mm_mul_ps(_mm_max_ps(color, zero), scale), half);
+            channels[i] = _mm_cvttps_epi32(color);
+         }
+         const auto& low = _mm_packs_epi32(channels[0], channels[1]);
+         const auto& high = _mm_packs_epi32(channels[2], channels[3]);
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[k]), _mm_packus_epi16(low, high));
+      }
+      doNotOptimize(output.front());
+   }
+}
+CLOCKWORK_BENCHMARK(mergeColorBatchSSE2, "ColorRGBA::merge [batch, SSE2]");
+#endif // __SSE2__
+} // namespace
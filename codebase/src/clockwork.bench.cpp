@@ -0,0 +1,177 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "benchmark.hh"
+#include "scene.generator.hh"
+#include "services.hh"
+#include "tostring.hh"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QThread>
+#include <algorithm>
+
+using clockwork::benchmark::Benchmark;
+
+
+namespace {
+/**
+ * Return the elements of a list whose names begin with one of the given names, which
+ * are matched without regard to case. If a name matches no element, the error is
+ * written to the standard error and false is returned.
+ */
+template<class T>
+bool
+select(const QString& names, const QList<T>& available, QList<T>& selected)
+{
+   for (const auto& name : names.split(',', QString::SkipEmptyParts))
+   {
+      const auto& size = selected.size();
+      for (const auto& element : available)
+      {
+         if (clockwork::toString(element).startsWith(name.trimmed(), Qt::CaseInsensitive))
+            selected << element;
+      }
+      if (selected.size() == size)
+      {
+         std::cerr << "Unknown value '" << name.toStdString() << "'." << std::endl;
+         return false;
+      }
+   }
+   return true;
+}
+} // namespace
+
+
+int main(int argc, char** argv)
+{
+   // The benchmark only draws to the framebuffer, so it doesn't need a display.
+   QCoreApplication application(argc, argv);
+   QCoreApplication::setApplicationName("clockwork-bench");
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription
+   (
+      "Render fixed camera paths with every render algorithm, framebuffer resolution and thread count, "
+      "and write the measurements as JSON."
+   );
+   parser.addHelpOption();
+   parser.addOptions
+   ({
+      {"scenes", "The scenes to render, separated by commas.", "names"},
+      {
+         "generate",
+         "Generate a scene from a description such as objects=10000,depth=3,mesh=terrain,motion=orbit. "
+         "The keys are objects, depth, mesh (sphere, grid or terrain), resolution, instancing, lights, "
+         "motion (static, turn, spin, orbit or scatter), moving and seed. The option may be repeated.",
+         "description"
+      },
+      {"algorithms", "The render algorithms to use, separated by commas.", "names"},
+      {"resolutions", "The framebuffer resolutions to use, separated by commas.", "names"},
+      {"threads", "The thread counts to use, separated by commas.", "counts"},
+      {"frames", "The number of frames to measure along each camera path.", "count", "120"},
+      {"warmup", "The number of frames to draw before measuring.", "count", "10"},
+      {"output", "The file to write the results to, instead of the standard output.", "file"},
+      {"baseline", "A file of previous results to compare the results with.", "file"},
+      {"tolerance", "The fraction by which a case may be slower than its baseline.", "fraction", "0.05"}
+   });
+   parser.process(application);
+
+   Benchmark benchmark;
+   Benchmark::Options options;
+   options.frameCount = parser.value("frames").toUInt();
+   options.warmupFrameCount = parser.value("warmup").toUInt();
+
+   // Generated scenes are rendered along with the scenes that are selected by name.
+   QStringList generatedSceneNames;
+   for (const auto& description : parser.values("generate"))
+   {
+      clockwork::scene::SceneGenerator::Options generatorOptions;
+      if (!clockwork::scene::SceneGenerator::parse(description, generatorOptions, std::cerr))
+         return 1;
+
+      generatedSceneNames << benchmark.addScene(generatorOptions);
+   }
+
+   // Each scene, algorithm and resolution is selected by the beginning of its name.
+   for (const auto& name : parser.value("scenes").split(',', QString::SkipEmptyParts))
+   {
+      if (!benchmark.getSceneNames().contains(name.trimmed(), Qt::CaseInsensitive))
+      {
+         std::cerr << "Unknown scene '" << name.toStdString() << "'. Available scenes are: "
+                   << benchmark.getSceneNames().join(", ").toStdString() << "." << std::endl;
+         return 1;
+      }
+      options.scenes << name.trimmed();
+   }
+   if (!options.scenes.isEmpty())
+      options.scenes << generatedSceneNames;
+   if
+   (
+      !select(parser.value("algorithms"), clockwork::graphics::RenderAlgorithmFactory::getInstance().getKeys(), options.algorithms) ||
+      !select(parser.value("resolutions"), clockwork::graphics::Framebuffer::getAvailableResolutions(), options.resolutions)
+   )
+      return 1;
+
+   // By default, the thread count is doubled from one up to the number of hardware threads.
+   for (const auto& count : parser.value("threads").split(',', QString::SkipEmptyParts))
+      options.threadCounts << std::max(count.toInt(), 1);
+   if (options.threadCounts.isEmpty())
+   {
+      const auto idealThreadCount = std::max(QThread::idealThreadCount(), 1);
+      for (auto count = 1; count < idealThreadCount; count *= 2)
+         options.threadCounts << count;
+      options.threadCounts << idealThreadCount;
+   }
+
+   const auto& results = benchmark.run(options, std::cerr);
+   const auto& json = QJsonDocument(Benchmark::toJson(options, results)).toJson();
+   if (parser.isSet("output"))
+   {
+      QFile file(parser.value("output"));
+      if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+      {
+         std::cerr << "Could not write the results to '" << file.fileName().toStdString() << "'." << std::endl;
+         return 1;
+      }
+   }
+   else
+      std::cout << json.constData() << std::flush;
+
+   // A regression fails the run, so that it can be caught before it is deployed.
+   if (parser.isSet("baseline"))
+   {
+      QFile file(parser.value("baseline"));
+      QJsonParseError error;
+      const auto& baseline = file.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(file.readAll(), &error) : QJsonDocument();
+      if (!baseline.isObject())
+      {
+         std::cerr << "Could not read the baseline from '" << file.fileName().toStdString() << "'." << std::endl;
+         return 1;
+      }
+      if (!Benchmark::compare(results, baseline.object(), parser.value("tolerance").toDouble(), std::cerr))
+         return 2;
+   }
+   return 0;
+}
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "micro.benchmark.hh"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <iostream>
+
+using clockwork::benchmark::MicroBenchmark;
+
+
+int main(int argc, char** argv)
+{
+   QCoreApplication application(argc, argv);
+   QCoreApplication::setApplicationName("clockwork-microbench");
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription
+   (
+      "Measure the time taken by the engine's hot paths, such as matrix and color operations, "
+      "and write the measurements as JSON."
+   );
+   parser.addHelpOption();
+   parser.addOptions
+   ({
+      {"filter", "A regular expression that the names of the benchmarks to run must match.", "regex", "."},
+      {"min-time", "The minimum number of seconds to spend measuring each benchmark.", "seconds", "0.5"},
+      {"output", "The file to write the results to as JSON, or - for the standard output.", "file"},
+      {"baseline", "A file of previous results to compare the results with.", "file"},
+      {"tolerance", "The fraction by which a benchmark may be slower than its baseline.", "fraction", "0.05"}
+   });
+   parser.process(application);
+
+   const auto& filter = parser.value("filter");
+   if (!QRegularExpression(filter).isValid())
+   {
+      std::cerr << "Invalid filter '" << filter.toStdString() << "'." << std::endl;
+      return 1;
+   }
+
+   // The results are written as a table, unless they are written as JSON to the standard
+   // output, in which case the table is written to the standard error instead.
+   const auto& writeJsonToStandardOutput = parser.value("output") == "-";
+   auto& table = writeJsonToStandardOutput ? std::cerr : std::cout;
+   const auto& results = MicroBenchmark::run(filter, parser.value("min-time").toDouble(), table);
+   if (results.empty())
+   {
+      std::cerr << "No benchmark matches the filter '" << filter.toStdString() << "'." << std::endl;
+      return 1;
+   }
+
+   if (parser.isSet("output"))
+   {
+      const auto& json = QJsonDocument(MicroBenchmark::toJson(results)).toJson();
+      if (writeJsonToStandardOutput)
+         std::cout << json.constData() << std::flush;
+      else
+      {
+         QFile file(parser.value("output"));
+         if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size())
+         {
+            std::cerr << "Could not write the results to '" << file.fileName().toStdString() << "'." << std::endl;
+            return 1;
+         }
+      }
+   }
+
+   // A regression fails the run, so that it can be caught before it is deployed.
+   if (parser.isSet("baseline"))
+   {
+      QFile file(parser.value("baseline"));
+      QJsonParseError error;
+      const auto& baseline = file.open(QIODevice::ReadOnly) ? QJsonDocument::fromJson(file.readAll(), &error) : QJsonDocument();
+      if (!baseline.isObject())
+      {
+         std::cerr << "Could not read the baseline from '" << file.fileName().toStdString() << "'." << std::endl;
+         return 1;
+      }
+      if (!MicroBenchmark::compare(results, baseline.object(), parser.value("tolerance").toDouble(), std::cerr))
+         return 2;
+   }
+   return 0;
+}
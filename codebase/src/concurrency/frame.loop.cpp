@@ -0,0 +1,221 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "frame.loop.hh"
+#include "task.update.hh"
+#include "services.hh"
+#include "profiler.hh"
+#include <QTimerEvent>
+#include <algorithm>
+#include <cmath>
+
+using clockwork::concurrency::FrameLoop;
+
+
+constexpr unsigned int FrameLoop::MAXIMUM_STEP_COUNT;
+
+
+FrameLoop::FrameLoop(QObject* const parent) :
+QObject(parent),
+_timestep(1.0 / 60.0),
+_targetFrameRate(60.0),
+_accumulator(0),
+_maximumInFlightFrameCount(2),
+_inFlightFrameCount(0),
+_isProcessingFrame(false),
+_coalescedFrameCount(0),
+_isContinuous(false),
+_isFrameRequested(false)
+{}
+
+
+const double&
+FrameLoop::getTimestep() const
+{
+   return _timestep;
+}
+
+
+void
+FrameLoop::setTimestep(const double& timestep)
+{
+   if (timestep > 0.0)
+      _timestep = timestep;
+}
+
+
+const double&
+FrameLoop::getTargetFrameRate() const
+{
+   return _targetFrameRate;
+}
+
+
+void
+FrameLoop::setTargetFrameRate(const double& frameRate)
+{
+   if (frameRate > 0.0 && frameRate != _targetFrameRate)
+   {
+      _targetFrameRate = frameRate;
+      if (_timer.isActive())
+      {
+         _timer.stop();
+         start();
+      }
+   }
+}
+
+
+const unsigned int&
+FrameLoop::getMaximumInFlightFrameCount() const
+{
+   return _maximumInFlightFrameCount;
+}
+
+
+void
+FrameLoop::setMaximumInFlightFrameCount(const unsigned int& count)
+{
+   _maximumInFlightFrameCount = std::max(count, 1U);
+}
+
+
+unsigned int
+FrameLoop::getInFlightFrameCount() const
+{
+   return _inFlightFrameCount;
+}
+
+
+const uint64_t&
+FrameLoop::getCoalescedFrameCount() const
+{
+   return _coalescedFrameCount;
+}
+
+
+bool
+FrameLoop::isContinuous() const
+{
+   return _isContinuous;
+}
+
+
+void
+FrameLoop::setContinuous(const bool& continuous)
+{
+   _isContinuous = continuous;
+   if (_isContinuous)
+      start();
+}
+
+
+void
+FrameLoop::requestFrame()
+{
+   _isFrameRequested = true;
+   start();
+}
+
+
+void
+FrameLoop::onFrameProcessed()
+{
+   _isProcessingFrame = false;
+}
+
+
+void
+FrameLoop::onFrameRetired()
+{
+   --_inFlightFrameCount;
+   CLOCKWORK_PROFILE_FRAME();
+}
+
+
+void
+FrameLoop::onFrameCancelled()
+{
+   --_inFlightFrameCount;
+   QMetaObject::invokeMethod(this, "requestFrame", Qt::QueuedConnection);
+}
+
+
+void
+FrameLoop::start()
+{
+   if (!_timer.isActive())
+   {
+      // The time spent idle is not simulated.
+      _accumulator = 0;
+      _clock.start();
+      _timer.start(static_cast<int>(std::lround(1000.0 / _targetFrameRate)), Qt::PreciseTimer, this);
+   }
+}
+
+
+void
+FrameLoop::tick()
+{
+   _accumulator += 1e-9 * _clock.nsecsElapsed();
+   _clock.restart();
+
+   if (!_isContinuous && !_isFrameRequested)
+   {
+      _timer.stop();
+      return;
+   }
+
+   // Apply backpressure: the frame is skipped, and its time is simulated by the next one.
+   // Frames are processed one at a time, in the order their snapshots were captured.
+   if (_isProcessingFrame || _inFlightFrameCount >= _maximumInFlightFrameCount)
+   {
+      ++_coalescedFrameCount;
+      return;
+   }
+
+   const auto& stepCount =
+   static_cast<unsigned int>(std::min(std::floor(_accumulator / _timestep), static_cast<double>(MAXIMUM_STEP_COUNT)));
+   if (stepCount == MAXIMUM_STEP_COUNT)
+      _accumulator = std::min(_accumulator - stepCount * _timestep, _timestep);
+   else
+      _accumulator -= stepCount * _timestep;
+
+   for (unsigned int i = 0; i < stepCount; ++i)
+      emit stepped(_timestep);
+
+   _isFrameRequested = false;
+   _isProcessingFrame = true;
+   ++_inFlightFrameCount;
+   clockwork::system::Services::Concurrency.submitTask(new clockwork::concurrency::UpdateTask(*this));
+}
+
+
+void
+FrameLoop::timerEvent(QTimerEvent* const e)
+{
+   if (e->timerId() == _timer.timerId())
+      tick();
+   else
+      QObject::timerEvent(e);
+}
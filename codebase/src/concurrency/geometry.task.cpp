@@ -0,0 +1,75 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "task.geometry.hh"
+#include "task.raster.hh"
+#include "frame.loop.hh"
+#include "services.hh"
+#include "scene.hh"
+#include "scene.snapshot.hh"
+#include <cassert>
+
+using clockwork::concurrency::GeometryTask;
+
+
+GeometryTask::GeometryTask(FrameLoop& frameLoop, const int priority) :
+Task(priority),
+_frameLoop(frameLoop)
+{}
+
+
+void
+GeometryTask::execute()
+{
+   using clockwork::system::GraphicsSubsystem;
+   using clockwork::system::Services;
+
+   // The snapshot that was published by the preceding update, or a newer one.
+   const auto& snapshot = clockwork::scene::Scene::getInstance().getSnapshot();
+   assert(snapshot != nullptr);
+
+   auto packet = std::make_shared<GraphicsSubsystem::FramePacket>();
+   Services::Graphics.processScene(*snapshot, *packet);
+
+   // The frame has been processed, so the next one may be updated and processed.
+   _frameLoop.onFrameProcessed();
+
+   if (isCancelled())
+   {
+      Services::Graphics.discard(*packet);
+      _frameLoop.onFrameCancelled();
+   }
+   else
+      Services::Concurrency.submitTask(new clockwork::concurrency::RasterTask(_frameLoop, packet));
+}
+
+
+void
+GeometryTask::onCancelled()
+{
+   // The changes made by the preceding update will never be drawn on their own.
+   clockwork::system::Services::Graphics.invalidateFrame();
+
+   _frameLoop.onFrameProcessed();
+   _frameLoop.onFrameCancelled();
+}
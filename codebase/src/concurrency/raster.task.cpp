@@ -0,0 +1,67 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "task.raster.hh"
+#include "frame.loop.hh"
+#include "services.hh"
+
+using clockwork::concurrency::RasterTask;
+
+
+RasterTask::RasterTask
+(
+   FrameLoop& frameLoop,
+   const std::shared_ptr<const clockwork::system::GraphicsSubsystem::FramePacket>& packet,
+   const int priority
+) :
+Task(priority),
+_packet(packet)
+{
+   connect
+   (
+      this, SIGNAL(completed()),
+      &clockwork::system::Services::Graphics.getFramebuffer(), SIGNAL(frameReady())
+   );
+   connect(this, SIGNAL(completed()), &frameLoop, SLOT(onFrameRetired()), Qt::DirectConnection);
+   connect(this, SIGNAL(cancelled()), &frameLoop, SLOT(onFrameCancelled()), Qt::DirectConnection);
+}
+
+
+void
+RasterTask::execute()
+{
+   clockwork::system::Services::Graphics.rasterise(*_packet);
+
+   emit completed();
+}
+
+
+void
+RasterTask::onCancelled()
+{
+   // The packet must be discarded rather than dropped, so that the packets that follow it
+   // are not left waiting for their turn.
+   clockwork::system::Services::Graphics.discard(*_packet);
+
+   emit cancelled();
+}
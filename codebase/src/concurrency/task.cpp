@@ -28,7 +28,9 @@ using clockwork::concurrency::Task;
 
 
 Task::Task(const int priority) :
-_priority(priority)
+_priority(priority),
+_isCancelled(false),
+_isStarted(false)
 {}
 
 
@@ -37,3 +39,51 @@ Task::getPriority() const
 {
    return _priority;
 }
+
+
+void
+Task::cancel()
+{
+   _isCancelled = true;
+}
+
+
+bool
+Task::isCancelled() const
+{
+   return _isCancelled;
+}
+
+
+bool
+Task::isStarted() const
+{
+   return _isStarted;
+}
+
+
+bool
+Task::isSupersededBy(const Task&) const
+{
+   return false;
+}
+
+
+void
+Task::run()
+{
+   _isStarted = true;
+   if (isCancelled())
+      onCancelled();
+   else
+      execute();
+
+   // The task is deleted by the thread pool once this function returns, so it must no
+   // longer be reachable by the concurrency subsystem.
+   clockwork::system::Services::Concurrency.onTaskFinished(*this);
+}
+
+
+void
+Task::onCancelled()
+{}
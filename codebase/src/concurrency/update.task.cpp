@@ -22,35 +22,65 @@
  * THE SOFTWARE.
  */
 #include "task.update.hh"
-#include "task.render.hh"
+#include "task.geometry.hh"
+#include "frame.loop.hh"
 #include "services.hh"
+#include "profiler.hh"
 #include "scene.hh"
 
 using clockwork::concurrency::UpdateTask;
 
 
-UpdateTask::UpdateTask(const int priority) :
-Task(priority)
+UpdateTask::UpdateTask(FrameLoop& frameLoop, const int priority) :
+Task(priority),
+_frameLoop(frameLoop)
 {}
 
 
+bool
+UpdateTask::isSupersededBy(const Task& task) const
+{
+   return dynamic_cast<const UpdateTask*>(&task) != nullptr;
+}
+
+
 void
-UpdateTask::run()
+UpdateTask::execute()
 {
-   // Update all scene objects.
-   update(clockwork::scene::Scene::getInstance().getGraph());
+   CLOCKWORK_PROFILE(Update);
+
+   auto& scene = clockwork::scene::Scene::getInstance();
 
-   // Render the updated scene.
-   clockwork::system::Services::Concurrency.submitTask(new clockwork::concurrency::RenderTask);
+   // Update the transforms of all scene objects that have moved since the last update.
+   // Each depth level of the hierarchy is split across the thread pool.
+   auto& transformHierarchy = scene.getTransformHierarchy();
+   transformHierarchy.update();
+
+   // Refit the bounds of the objects that have moved.
+   scene.getBoundingVolumeHierarchy().update(transformHierarchy);
+
+   // If the frame has been cancelled, the changes made by this update won't be rendered
+   // on their own, so the next frame must be redrawn entirely.
+   if (isCancelled())
+   {
+      clockwork::system::Services::Graphics.invalidateFrame();
+      onCancelled();
+      return;
+   }
+
+   // Publish a snapshot of the updated scene. From here on, the frame is drawn from the
+   // snapshot alone, and the scene is never read by the renderer.
+   scene.captureSnapshot();
+
+   clockwork::system::Services::Concurrency.submitTask(new clockwork::concurrency::GeometryTask(_frameLoop));
 }
 
 
 void
-UpdateTask::update(clockwork::scene::Object& object) const
+UpdateTask::onCancelled()
 {
-   object.updateCMTM();
-
-   // Update the subgraph.
-   for (auto* const child : object.getChildren())
-      update(*child);
+   // If the update didn't run, its changes are still pending and the next update will
+   // apply them.
+   _frameLoop.onFrameProcessed();
+   _frameLoop.onFrameCancelled();
 }
@@ -0,0 +1,266 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "bounding.volume.hh"
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+using clockwork::graphics::BoundingBox;
+using clockwork::graphics::BoundingSphere;
+using clockwork::graphics::BoundingFrustum;
+
+
+BoundingBox::BoundingBox() :
+minimum
+(
+   std::numeric_limits<double>::max(),
+   std::numeric_limits<double>::max(),
+   std::numeric_limits<double>::max()
+),
+maximum
+(
+   std::numeric_limits<double>::lowest(),
+   std::numeric_limits<double>::lowest(),
+   std::numeric_limits<double>::lowest()
+)
+{}
+
+
+BoundingBox::BoundingBox(const clockwork::Point3& min, const clockwork::Point3& max) :
+minimum(min),
+maximum(max)
+{}
+
+
+void
+BoundingBox::extend(const clockwork::Point3& p)
+{
+   minimum.x = std::min(minimum.x, p.x);
+   minimum.y = std::min(minimum.y, p.y);
+   minimum.z = std::min(minimum.z, p.z);
+   maximum.x = std::max(maximum.x, p.x);
+   maximum.y = std::max(maximum.y, p.y);
+   maximum.z = std::max(maximum.z, p.z);
+}
+
+
+void
+BoundingBox::extend(const BoundingBox& box)
+{
+   if (!box.isEmpty())
+   {
+      extend(box.minimum);
+      extend(box.maximum);
+   }
+}
+
+
+bool
+BoundingBox::isEmpty() const
+{
+   return minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z;
+}
+
+
+clockwork::Point3
+BoundingBox::getCenter() const
+{
+   return clockwork::Point3
+   (
+      0.5 * (minimum.x + maximum.x),
+      0.5 * (minimum.y + maximum.y),
+      0.5 * (minimum.z + maximum.z)
+   );
+}
+
+
+double
+BoundingBox::getSurfaceArea() const
+{
+   if (isEmpty())
+      return 0.0;
+
+   const auto& dx = maximum.x - minimum.x;
+   const auto& dy = maximum.y - minimum.y;
+   const auto& dz = maximum.z - minimum.z;
+
+   return 2.0 * ((dx * dy) + (dy * dz) + (dz * dx));
+}
+
+
+bool
+BoundingBox::contains(const BoundingBox& box) const
+{
+   return
+   minimum.x <= box.minimum.x && minimum.y <= box.minimum.y && minimum.z <= box.minimum.z &&
+   maximum.x >= box.maximum.x && maximum.y >= box.maximum.y && maximum.z >= box.maximum.z;
+}
+
+
+bool
+BoundingBox::intersects(const BoundingBox& box) const
+{
+   return
+   minimum.x <= box.maximum.x && maximum.x >= box.minimum.x &&
+   minimum.y <= box.maximum.y && maximum.y >= box.minimum.y &&
+   minimum.z <= box.maximum.z && maximum.z >= box.minimum.z;
+}
+
+
+bool
+BoundingBox::intersects
+(
+   const clockwork::graphics::Ray& ray,
+   double& minimumDistance,
+   double& maximumDistance
+) const
+{
+   // Clip the distance interval against each pair of slabs.
+   const std::array<double, 3> origin = {{ray.origin.x, ray.origin.y, ray.origin.z}};
+   const std::array<double, 3> inverseDirection =
+   {{ray.inverseDirection.i, ray.inverseDirection.j, ray.inverseDirection.k}};
+   const std::array<double, 3> lower = {{minimum.x, minimum.y, minimum.z}};
+   const std::array<double, 3> upper = {{maximum.x, maximum.y, maximum.z}};
+
+   auto tmin = minimumDistance;
+   auto tmax = maximumDistance;
+   for (unsigned int axis = 0; axis < 3; ++axis)
+   {
+      auto t0 = (lower[axis] - origin[axis]) * inverseDirection[axis];
+      auto t1 = (upper[axis] - origin[axis]) * inverseDirection[axis];
+      if (t0 > t1)
+         std::swap(t0, t1);
+
+      tmin = std::max(tmin, t0);
+      tmax = std::min(tmax, t1);
+      if (tmin > tmax)
+         return false;
+   }
+   minimumDistance = tmin;
+   maximumDistance = tmax;
+
+   return true;
+}
+
+
+BoundingBox
+BoundingBox::transform(const BoundingBox& box, const clockwork::Matrix4& M)
+{
+   BoundingBox output;
+   if (!box.isEmpty())
+   {
+      for (unsigned int corner = 0; corner < 8; ++corner)
+      {
+         const clockwork::Point3 p
+         (
+            corner & 1 ? box.maximum.x : box.minimum.x,
+            corner & 2 ? box.maximum.y : box.minimum.y,
+            corner & 4 ? box.maximum.z : box.minimum.z
+         );
+         output.extend(M * p);
+      }
+   }
+   return output;
+}
+
+
+BoundingSphere::BoundingSphere(const clockwork::Point3& c, const double& r) :
+center(c),
+radius(r)
+{}
+
+
+BoundingSphere
+BoundingSphere::transform(const BoundingSphere& sphere, const clockwork::Matrix4& M)
+{
+   return BoundingSphere(M * sphere.center, sphere.radius * clockwork::graphics::getMaximumScale(M));
+}
+
+
+BoundingFrustum::BoundingFrustum(const clockwork::Matrix4& M)
+{
+   // Extract the planes from the rows of the transformation matrix (Gribb & Hartmann).
+   // A point is inside the canonical view volume if -w <= x, y, z <= w, so each plane is
+   // the sum or difference of the fourth row and one of the first three rows.
+   for (unsigned int i = 0; i < 3; ++i)
+   {
+      auto& negative = planes[2 * i];
+      auto& positive = planes[(2 * i) + 1];
+      for (unsigned int j = 0; j < 4; ++j)
+      {
+         negative[j] = M.get(3, j) + M.get(i, j);
+         positive[j] = M.get(3, j) - M.get(i, j);
+      }
+   }
+   for (auto& plane : planes)
+   {
+      const auto& length = std::sqrt((plane[0] * plane[0]) + (plane[1] * plane[1]) + (plane[2] * plane[2]));
+      if (length > 0.0)
+         for (auto& coefficient : plane)
+            coefficient /= length;
+   }
+}
+
+
+BoundingFrustum::Containment
+BoundingFrustum::contains(const BoundingBox& box) const
+{
+   if (box.isEmpty())
+      return Containment::Outside;
+
+   auto output = Containment::Inside;
+   for (const auto& plane : planes)
+   {
+      // The box is outside the frustum if its corner that is furthest along the plane's
+      // normal is behind the plane. If its nearest corner is behind the plane, then the
+      // box straddles the plane.
+      const auto& px = plane[0] >= 0.0 ? box.maximum.x : box.minimum.x;
+      const auto& py = plane[1] >= 0.0 ? box.maximum.y : box.minimum.y;
+      const auto& pz = plane[2] >= 0.0 ? box.maximum.z : box.minimum.z;
+      if ((plane[0] * px) + (plane[1] * py) + (plane[2] * pz) + plane[3] < 0.0)
+         return Containment::Outside;
+
+      const auto& nx = plane[0] >= 0.0 ? box.minimum.x : box.maximum.x;
+      const auto& ny = plane[1] >= 0.0 ? box.minimum.y : box.maximum.y;
+      const auto& nz = plane[2] >= 0.0 ? box.minimum.z : box.maximum.z;
+      if ((plane[0] * nx) + (plane[1] * ny) + (plane[2] * nz) + plane[3] < 0.0)
+         output = Containment::Intersecting;
+   }
+   return output;
+}
+
+
+double
+clockwork::graphics::getMaximumScale(const clockwork::Matrix4& M)
+{
+   double output = 0.0;
+   for (unsigned int j = 0; j < 3; ++j)
+   {
+      const auto& x = M.get(0, j);
+      const auto& y = M.get(1, j);
+      const auto& z = M.get(2, j);
+      output = std::max(output, std::sqrt((x * x) + (y * y) + (z * z)));
+   }
+   return output;
+}
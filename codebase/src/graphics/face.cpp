@@ -33,9 +33,21 @@ Face::Face
    const std::array<const clockwork::Vector3, 3>& normals,
    const std::array<const Texture::Coordinates, 3>& texcoords
 ) :
+Face(indices, normals, texcoords, {Tangent(), Tangent(), Tangent()})
+{}
+
+
+Face::Face
+(
+   const std::array<const uint32_t, 3>& indices,
+   const std::array<const clockwork::Vector3, 3>& normals,
+   const std::array<const Texture::Coordinates, 3>& texcoords,
+   const std::array<const Tangent, 3>& tangents
+) :
 _indices(indices),
 _normals(normals),
-_textureMappingCoordinates(texcoords)
+_textureMappingCoordinates(texcoords),
+_tangents(tangents)
 {}
 
 
@@ -68,3 +80,10 @@ Face::getTextureMappingCoordinates() const
 {
    return _textureMappingCoordinates;
 }
+
+
+const std::array<const clockwork::graphics::Tangent, 3>&
+Face::getTangents() const
+{
+   return _tangents;
+}
@@ -30,6 +30,7 @@ using clockwork::graphics::Fragment;
 Fragment::Fragment() :
 x(0), y(0), z(0.0),
 normal(),
+tangent(),
 u(0.0), v(0.0),
 color(1.0, 1.0, 1.0),
 stencil(0)
@@ -41,6 +42,7 @@ x(static_cast<uint32_t>(vertex.x)),
 y(static_cast<uint32_t>(vertex.y)),
 z(vertex.z),
 normal(vertex.normal),
+tangent(vertex.tangent),
 u(vertex.uvmap.u),
 v(vertex.uvmap.v),
 color(vertex.color),
@@ -65,6 +67,11 @@ Fragment::interpolate(const Fragment& start, const Fragment& end, const double&
    output.normal.j = (pp * start.normal.j) + (p * end.normal.j);
    output.normal.k = (pp * start.normal.k) + (p * end.normal.k);
 
+   output.tangent.direction.i = (pp * start.tangent.direction.i) + (p * end.tangent.direction.i);
+   output.tangent.direction.j = (pp * start.tangent.direction.j) + (p * end.tangent.direction.j);
+   output.tangent.direction.k = (pp * start.tangent.direction.k) + (p * end.tangent.direction.k);
+   output.tangent.handedness = p < 0.5 ? start.tangent.handedness : end.tangent.handedness;
+
    output.color.alpha = (pp * start.color.alpha) + (p * end.color.alpha);
    output.color.red = (pp * start.color.red) + (p * end.color.red);
    output.color.green = (pp * start.color.green) + (p * end.color.green);
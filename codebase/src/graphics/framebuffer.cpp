@@ -23,6 +23,8 @@
  */
 #include "framebuffer.hh"
 #include "services.hh"
+#include "profiler.hh"
+#include <algorithm>
 #include <limits>
 
 using clockwork::graphics::Framebuffer;
@@ -39,7 +41,8 @@ _stencilBuffer(nullptr),
 _stencilBufferClearValue(0),
 _accumulationBuffer(nullptr),
 _accumulationBufferClearValue(0xff000000),
-_ignoreWrites(true)
+_ignoreWrites(true),
+_statistics(nullptr)
 {
    // Resize all buffers and initialise them for use.
    resize(resolution, true);
@@ -139,16 +142,28 @@ Framebuffer::setAccumulationBufferClearValue(const uint32_t& value)
 void
 Framebuffer::plot(const Fragment& fragment, const std::function<uint32_t(const Fragment&)>& fop)
 {
-   if (_ignoreWrites)
+   if (_statistics != nullptr)
+      ++_statistics->fragmentsGenerated;
+
+   if (_ignoreWrites || !_clipRectangle.contains(fragment.x, fragment.y))
       return;
 
    const auto offset = fragmentPasses(fragment);
    if (offset >= 0)
    {
-      _pixelBuffer[offset] = fop(fragment);
+      {
+         CLOCKWORK_PROFILE_ACCUMULATE(Fragment);
+         _pixelBuffer[offset] = fop(fragment);
+      }
       _depthBuffer[offset] = fragment.z;
       _accumulationBuffer[offset] = _accumulationBufferClearValue;
       _stencilBuffer[offset] = fragment.stencil;
+
+      if (_statistics != nullptr)
+      {
+         ++_statistics->fragmentsShaded;
+         ++_statistics->fragmentsWritten;
+      }
    }
 }
 
@@ -156,7 +171,7 @@ Framebuffer::plot(const Fragment& fragment, const std::function<uint32_t(const F
 void
 Framebuffer::plot(const uint32_t& x, const uint32_t& y, const double& z, const uint32_t& pixel)
 {
-   if (_ignoreWrites)
+   if (_ignoreWrites || !_clipRectangle.contains(x, y))
       return;
 
    const auto offset = getOffset(x, y);
@@ -166,6 +181,9 @@ Framebuffer::plot(const uint32_t& x, const uint32_t& y, const double& z, const u
       _depthBuffer[offset] = z;
       _stencilBuffer[offset] = _stencilBufferClearValue;
       _accumulationBuffer[offset] = _accumulationBufferClearValue;
+
+      if (_statistics != nullptr)
+         ++_statistics->fragmentsWritten;
    }
 }
 
@@ -204,6 +222,65 @@ Framebuffer::clear()
 }
 
 
+void
+Framebuffer::clear(const QRect& rectangle)
+{
+   const auto& r = rectangle.intersected(QRect(0, 0, _width, _height));
+   if (r.isEmpty())
+      return;
+
+   const std::size_t width = r.width();
+   for (auto y = r.top(); y <= r.bottom(); ++y)
+   {
+      const auto offset = getOffset(r.left(), y);
+      std::fill_n(_pixelBuffer + offset, width, _pixelBufferClearValue);
+      std::fill_n(_depthBuffer + offset, width, _depthBufferClearValue);
+      std::fill_n(_stencilBuffer + offset, width, _stencilBufferClearValue);
+      std::fill_n(_accumulationBuffer + offset, width, _accumulationBufferClearValue);
+   }
+}
+
+
+const QRect&
+Framebuffer::getClipRectangle() const
+{
+   return _clipRectangle;
+}
+
+
+void
+Framebuffer::setClipRectangle(const QRect& rectangle)
+{
+   _clipRectangle = rectangle.intersected(QRect(0, 0, _width, _height));
+}
+
+
+void
+Framebuffer::resetClipRectangle()
+{
+   _clipRectangle = QRect(0, 0, _width, _height);
+}
+
+
+void
+Framebuffer::addDamagedRegion(const QRegion& region)
+{
+   QMutexLocker locker(&_damagedRegionMutex);
+   _damagedRegion += region;
+}
+
+
+QRegion
+Framebuffer::takeDamagedRegion()
+{
+   QMutexLocker locker(&_damagedRegionMutex);
+   QRegion region;
+   region.swap(_damagedRegion);
+
+   return region;
+}
+
+
 void
 Framebuffer::resize(const Framebuffer::Resolution& resolution, const bool& force)
 {
@@ -261,11 +338,15 @@ Framebuffer::resize(const Framebuffer::Resolution& resolution, const bool& force
       _accumulationBuffer = new uint32_t[length];
    }
 
-   // Initialise the buffers.
+   // Initialise the buffers. The whole framebuffer needs to be presented again.
    clear();
+   resetClipRectangle();
+   addDamagedRegion(QRect(0, 0, _width, _height));
 
    // Make the framebuffer writable.
    _ignoreWrites = false;
+
+   emit resized();
 }
 
 
@@ -283,6 +364,13 @@ Framebuffer::discard(const uint32_t& x, const uint32_t& y)
 }
 
 
+void
+Framebuffer::setStatistics(clockwork::graphics::PipelineStatistics* const statistics)
+{
+   _statistics = statistics;
+}
+
+
 int
 Framebuffer::getOffset(const uint32_t& x, const uint32_t& y) const
 {
@@ -308,7 +396,11 @@ Framebuffer::fragmentPasses(const Fragment& fragment) const
          return -1;
 
       if (Services::Graphics.isDepthTestEnabled() && !(fragment.z < _depthBuffer[offset]))
+      {
+         if (_statistics != nullptr)
+            ++_statistics->fragmentsDepthRejected;
          return -1;
+      }
    }
    return offset;
 }
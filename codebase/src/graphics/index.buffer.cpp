@@ -0,0 +1,87 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "index.buffer.hh"
+#include <limits>
+
+using clockwork::graphics::IndexBuffer;
+
+
+IndexBuffer::IndexBuffer() :
+_type(IndexBuffer::Type::UInt16)
+{}
+
+
+IndexBuffer::IndexBuffer(const std::vector<uint32_t>& indices, const std::size_t& vertexCount) :
+_type(vertexCount <= std::numeric_limits<uint16_t>::max() + 1u ? IndexBuffer::Type::UInt16 : IndexBuffer::Type::UInt32)
+{
+   if (_type == IndexBuffer::Type::UInt16)
+      _indices16.assign(indices.begin(), indices.end());
+   else
+      _indices32 = indices;
+}
+
+
+IndexBuffer::Type
+IndexBuffer::getType() const
+{
+   return _type;
+}
+
+
+uint32_t
+IndexBuffer::get(const std::size_t& i) const
+{
+   return _type == IndexBuffer::Type::UInt16 ? _indices16[i] : _indices32[i];
+}
+
+
+std::vector<uint32_t>
+IndexBuffer::toVector() const
+{
+   if (_type == IndexBuffer::Type::UInt16)
+      return std::vector<uint32_t>(_indices16.begin(), _indices16.end());
+   else
+      return _indices32;
+}
+
+
+std::size_t
+IndexBuffer::size() const
+{
+   return _type == IndexBuffer::Type::UInt16 ? _indices16.size() : _indices32.size();
+}
+
+
+std::size_t
+IndexBuffer::getSizeInBytes() const
+{
+   return _type == IndexBuffer::Type::UInt16 ? _indices16.size() * sizeof(uint16_t) : _indices32.size() * sizeof(uint32_t);
+}
+
+
+bool
+IndexBuffer::isEmpty() const
+{
+   return size() == 0;
+}
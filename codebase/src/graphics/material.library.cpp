@@ -21,34 +21,39 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-#pragma once
+#include "material.library.hh"
 
-#include <QObject>
-#include "task.hh"
+using clockwork::graphics::MaterialLibrary;
 
 
-namespace clockwork {
-namespace concurrency {
+MaterialLibrary::MaterialLibrary()
+{}
 
-class RenderTask : public QObject, public Task
+
+const clockwork::graphics::Material*
+MaterialLibrary::getMaterial(const QString& name) const
+{
+   const auto it = _materials.constFind(name);
+   return it != _materials.constEnd() ? &it.value() : nullptr;
+}
+
+
+void
+MaterialLibrary::addMaterial(const QString& name, const Material& material)
+{
+   _materials.insert(name, material);
+}
+
+
+int
+MaterialLibrary::getMaterialCount() const
+{
+   return _materials.size();
+}
+
+
+bool
+MaterialLibrary::isEmpty() const
 {
-Q_OBJECT
-public:
-   /**
-    * Instantiate a RenderTask with a given priority.
-    * @param priority the task's priority.
-    */
-   explicit RenderTask(const int priority = 0);
-   /**
-    * @see QRunnable::run.
-    */
-   void run() override final;
-signals:
-   /**
-    * This signal is emitted when the task completes its execution successfully.
-    */
-   void completed();
-};
-
-} // namespace concurrency
-} // namespace clockwork
+   return _materials.isEmpty();
+}
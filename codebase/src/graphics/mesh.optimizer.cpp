@@ -0,0 +1,352 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "mesh.optimizer.hh"
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+
+namespace {
+/**
+ * Tipsify clusters are split further once their average cache miss ratio drops to
+ * this fraction of the whole mesh's ratio. Larger values create smaller clusters,
+ * which reduces overdraw at the expense of vertex locality.
+ */
+constexpr double CLUSTER_THRESHOLD = 1.05;
+/**
+ * A simulated FIFO vertex cache, in the same form as the one Tipsify uses: a vertex
+ * is cached if it was (re)inserted less than 'size' insertions ago.
+ */
+class VertexCacheSimulator
+{
+public:
+   VertexCacheSimulator(const std::size_t& vertexCount, const std::size_t& size) :
+   _size(size),
+   _time(size + 1),
+   _timestamps(vertexCount, 0)
+   {}
+   /**
+    * Reference a vertex and return true if it was not in the cache.
+    */
+   bool reference(const uint32_t& v)
+   {
+      if (_time - _timestamps[v] > _size)
+      {
+         _timestamps[v] = _time++;
+         return true;
+      }
+      return false;
+   }
+   /**
+    * Evict every vertex from the cache.
+    */
+   void flush()
+   {
+      _time += _size + 1;
+   }
+private:
+   const std::size_t _size;
+   std::size_t _time;
+   std::vector<std::size_t> _timestamps;
+};
+/**
+ * Return a triangle's centroid and its normal scaled by twice its area.
+ */
+void
+getTriangleGeometry
+(
+   const uint32_t* const triangle,
+   const std::vector<std::array<float, 3>>& positions,
+   std::array<double, 3>& centroid,
+   std::array<double, 3>& normal
+)
+{
+   const auto& p0 = positions[triangle[0]];
+   const auto& p1 = positions[triangle[1]];
+   const auto& p2 = positions[triangle[2]];
+   const std::array<double, 3> e1 = {{p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]}};
+   const std::array<double, 3> e2 = {{p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]}};
+
+   for (unsigned int i = 0; i < 3; ++i)
+      centroid[i] = (p0[i] + p1[i] + p2[i]) / 3.0;
+
+   normal[0] = (e1[1] * e2[2]) - (e1[2] * e2[1]);
+   normal[1] = (e1[2] * e2[0]) - (e1[0] * e2[2]);
+   normal[2] = (e1[0] * e2[1]) - (e1[1] * e2[0]);
+}
+} // namespace
+
+
+void
+clockwork::graphics::optimizeVertexCache
+(
+   uint32_t* const indices,
+   const std::size_t& indexCount,
+   const std::size_t& vertexCount,
+   std::vector<std::size_t>& clusters,
+   const std::size_t& cacheSize
+)
+{
+   clusters.clear();
+   const auto& triangleCount = indexCount / 3;
+   if (triangleCount == 0)
+      return;
+
+   // Build the vertex-triangle adjacency in compressed form: the triangles that reference
+   // vertex V are adjacency[offsets[V]] to adjacency[offsets[V + 1] - 1].
+   std::vector<uint32_t> offsets(vertexCount + 1, 0);
+   for (std::size_t i = 0; i < 3 * triangleCount; ++i)
+      ++offsets[indices[i] + 1];
+   std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+   std::vector<uint32_t> adjacency(3 * triangleCount);
+   {
+      auto cursors = offsets;
+      for (std::size_t i = 0; i < 3 * triangleCount; ++i)
+         adjacency[cursors[indices[i]]++] = i / 3;
+   }
+
+   // The number of triangles that reference each vertex and have not been emitted yet.
+   std::vector<uint32_t> live(vertexCount);
+   for (std::size_t v = 0; v < vertexCount; ++v)
+      live[v] = offsets[v + 1] - offsets[v];
+
+   std::vector<std::size_t> cacheTimestamps(vertexCount, 0);
+   std::vector<bool> emitted(triangleCount, false);
+   std::vector<uint32_t> deadEnds;
+   std::vector<uint32_t> candidates;
+   std::vector<uint32_t> output;
+   std::vector<std::size_t> hardBoundaries;
+   output.reserve(3 * triangleCount);
+
+   std::size_t time = cacheSize + 1;
+   std::size_t nextVertex = 0;
+   int64_t fanningVertex = indices[0];
+   bool isBoundary = true;
+   while (fanningVertex >= 0)
+   {
+      // A hard boundary occurs whenever the fanning vertex could not be chosen from the
+      // previous fan's vertices.
+      if (isBoundary)
+      {
+         hardBoundaries.push_back(output.size() / 3);
+         isBoundary = false;
+      }
+
+      // Emit every remaining triangle around the fanning vertex.
+      candidates.clear();
+      for (auto a = offsets[fanningVertex]; a < offsets[fanningVertex + 1]; ++a)
+      {
+         const auto& t = adjacency[a];
+         if (!emitted[t])
+         {
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+               const auto& v = indices[3 * t + c];
+               output.push_back(v);
+               deadEnds.push_back(v);
+               candidates.push_back(v);
+               --live[v];
+               if (time - cacheTimestamps[v] > cacheSize)
+                  cacheTimestamps[v] = time++;
+            }
+            emitted[t] = true;
+         }
+      }
+
+      // Choose the next fanning vertex among the fan's vertices, preferring the oldest
+      // vertex that will still be in the cache once all of its triangles are emitted.
+      fanningVertex = -1;
+      int64_t bestPriority = -1;
+      for (const auto& v : candidates)
+      {
+         if (live[v] > 0)
+         {
+            int64_t priority = 0;
+            if (time - cacheTimestamps[v] + 2 * live[v] <= cacheSize)
+               priority = time - cacheTimestamps[v];
+            if (priority > bestPriority)
+            {
+               bestPriority = priority;
+               fanningVertex = v;
+            }
+         }
+      }
+
+      // If the fan has no usable vertices, backtrack through the recently used vertices
+      // and, failing that, continue with the next vertex in input order.
+      if (fanningVertex < 0)
+      {
+         isBoundary = true;
+         while (!deadEnds.empty() && fanningVertex < 0)
+         {
+            const auto v = deadEnds.back();
+            deadEnds.pop_back();
+            if (live[v] > 0)
+               fanningVertex = v;
+         }
+         for (; nextVertex < vertexCount && fanningVertex < 0; ++nextVertex)
+         {
+            if (live[nextVertex] > 0)
+               fanningVertex = nextVertex;
+         }
+      }
+   }
+   std::copy(output.begin(), output.end(), indices);
+   hardBoundaries.push_back(triangleCount);
+
+   // Split the clusters further at soft boundaries, i.e. as soon as a cluster's average
+   // cache miss ratio is about as good as the whole mesh's.
+   VertexCacheSimulator cache(vertexCount, cacheSize);
+   std::size_t totalMisses = 0;
+   for (std::size_t b = 0; b + 1 < hardBoundaries.size(); ++b)
+   {
+      cache.flush();
+      for (auto i = 3 * hardBoundaries[b]; i < 3 * hardBoundaries[b + 1]; ++i)
+         totalMisses += cache.reference(indices[i]);
+   }
+   const auto& targetRatio = CLUSTER_THRESHOLD * totalMisses / static_cast<double>(triangleCount);
+
+   for (std::size_t b = 0; b + 1 < hardBoundaries.size(); ++b)
+   {
+      auto start = hardBoundaries[b];
+      const auto& end = hardBoundaries[b + 1];
+      std::size_t misses = 0;
+
+      clusters.push_back(start);
+      cache.flush();
+      for (auto t = start; t < end; ++t)
+      {
+         for (unsigned int c = 0; c < 3; ++c)
+            misses += cache.reference(indices[3 * t + c]);
+
+         if (t + 1 < end && misses <= targetRatio * (t + 1 - start))
+         {
+            start = t + 1;
+            misses = 0;
+            clusters.push_back(start);
+            cache.flush();
+         }
+      }
+   }
+}
+
+
+void
+clockwork::graphics::optimizeOverdraw
+(
+   uint32_t* const indices,
+   const std::size_t& indexCount,
+   const std::vector<std::array<float, 3>>& positions,
+   const std::vector<std::size_t>& clusters
+)
+{
+   const auto& triangleCount = indexCount / 3;
+   const auto& clusterCount = clusters.size();
+   if (clusterCount < 2)
+      return;
+
+   // Calculate each cluster's area-weighted centroid and normal, as well as the mesh's centroid.
+   std::vector<std::array<double, 3>> clusterCentroids(clusterCount, {{0.0, 0.0, 0.0}});
+   std::vector<std::array<double, 3>> clusterNormals(clusterCount, {{0.0, 0.0, 0.0}});
+   std::array<double, 3> meshCentroid = {{0.0, 0.0, 0.0}};
+   double meshArea = 0.0;
+   for (std::size_t c = 0; c < clusterCount; ++c)
+   {
+      const auto& end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+      double clusterArea = 0.0;
+      for (auto t = clusters[c]; t < end; ++t)
+      {
+         std::array<double, 3> centroid, normal;
+         getTriangleGeometry(indices + 3 * t, positions, centroid, normal);
+
+         const auto& area = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+         for (unsigned int i = 0; i < 3; ++i)
+         {
+            clusterCentroids[c][i] += area * centroid[i];
+            clusterNormals[c][i] += normal[i];
+            meshCentroid[i] += area * centroid[i];
+         }
+         clusterArea += area;
+      }
+      if (clusterArea > 0.0)
+      {
+         for (auto& x : clusterCentroids[c])
+            x /= clusterArea;
+      }
+      meshArea += clusterArea;
+   }
+   if (meshArea > 0.0)
+   {
+      for (auto& x : meshCentroid)
+         x /= meshArea;
+   }
+
+   // Clusters that face away from the centroid are more likely to occlude others, so they
+   // should be drawn first.
+   std::vector<double> sortKeys(clusterCount);
+   for (std::size_t c = 0; c < clusterCount; ++c)
+   {
+      const auto& N = clusterNormals[c];
+      const auto& magnitude = std::sqrt((N[0] * N[0]) + (N[1] * N[1]) + (N[2] * N[2]));
+      double key = 0.0;
+      if (magnitude > 0.0)
+      {
+         for (unsigned int i = 0; i < 3; ++i)
+            key += (clusterCentroids[c][i] - meshCentroid[i]) * N[i] / magnitude;
+      }
+      sortKeys[c] = key;
+   }
+   std::vector<std::size_t> order(clusterCount);
+   std::iota(order.begin(), order.end(), 0);
+   std::stable_sort(order.begin(), order.end(), [&sortKeys](const std::size_t& a, const std::size_t& b)
+   {
+      return sortKeys[a] > sortKeys[b];
+   });
+
+   std::vector<uint32_t> output;
+   output.reserve(3 * triangleCount);
+   for (const auto& c : order)
+   {
+      const auto& end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+      output.insert(output.end(), indices + 3 * clusters[c], indices + 3 * end);
+   }
+   std::copy(output.begin(), output.end(), indices);
+}
+
+
+std::vector<int64_t>
+clockwork::graphics::optimizeVertexFetch(std::vector<uint32_t>& indices, const std::size_t& vertexCount)
+{
+   std::vector<int64_t> remap(vertexCount, -1);
+   int64_t next = 0;
+   for (auto& index : indices)
+   {
+      auto& newIndex = remap[index];
+      if (newIndex < 0)
+         newIndex = next++;
+      index = newIndex;
+   }
+   return remap;
+}
@@ -0,0 +1,355 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "mesh.simplifier.hh"
+#include <unordered_map>
+#include <queue>
+#include <limits>
+#include <cstring>
+#include <cmath>
+
+
+namespace {
+/**
+ * A symmetric 4x4 matrix that measures the sum of squared distances from a point to a
+ * set of planes, stored as its ten unique coefficients.
+ */
+struct Quadric
+{
+   Quadric() :
+   q{0, 0, 0, 0, 0, 0, 0, 0, 0, 0}
+   {}
+   /**
+    * Instantiate the quadric of the plane ax + by + cz + d = 0.
+    */
+   Quadric(const double& a, const double& b, const double& c, const double& d) :
+   q{a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d}
+   {}
+   void add(const Quadric& other)
+   {
+      for (unsigned int i = 0; i < 10; ++i)
+         q[i] += other.q[i];
+   }
+   /**
+    * Return the sum of squared distances from a point to the quadric's planes.
+    */
+   double evaluate(const std::array<float, 3>& p) const
+   {
+      const double x = p[0], y = p[1], z = p[2];
+      return
+      (q[0] * x * x) + (2 * q[1] * x * y) + (2 * q[2] * x * z) + (2 * q[3] * x) +
+      (q[4] * y * y) + (2 * q[5] * y * z) + (2 * q[6] * y) +
+      (q[7] * z * z) + (2 * q[8] * z) +
+      q[9];
+   }
+   double q[10];
+};
+/**
+ * A candidate edge collapse that moves a source vertex onto a target vertex. A collapse
+ * is outdated if either vertex has changed since the collapse was evaluated.
+ */
+struct Collapse
+{
+   double cost;
+   uint32_t source;
+   uint32_t target;
+   uint32_t sourceVersion;
+   uint32_t targetVersion;
+
+   bool operator>(const Collapse& other) const
+   {
+      return cost > other.cost;
+   }
+};
+/**
+ * Return a triangle's (non-normalised) normal.
+ */
+std::array<double, 3>
+getNormal(const std::array<float, 3>& p0, const std::array<float, 3>& p1, const std::array<float, 3>& p2)
+{
+   const double e1[] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+   const double e2[] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+   return
+   {{
+      (e1[1] * e2[2]) - (e1[2] * e2[1]),
+      (e1[2] * e2[0]) - (e1[0] * e2[2]),
+      (e1[0] * e2[1]) - (e1[1] * e2[0])
+   }};
+}
+/**
+ * A hash for positions, which are compared bitwise.
+ */
+struct PositionHash
+{
+   std::size_t operator()(const std::array<float, 3>& p) const
+   {
+      uint32_t bits[3];
+      std::memcpy(bits, p.data(), sizeof(bits));
+      return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+   }
+};
+} // namespace
+
+
+double
+clockwork::graphics::simplifyMesh
+(
+   const std::vector<std::array<float, 3>>& positions,
+   const std::vector<uint32_t>& indices,
+   const std::vector<Model3D::Submesh>& submeshes,
+   const std::size_t& targetTriangleCount,
+   std::vector<uint32_t>& outputIndices,
+   std::vector<Model3D::Submesh>& outputSubmeshes
+)
+{
+   const auto& vertexCount = positions.size();
+   const auto& triangleCount = indices.size() / 3;
+
+   std::vector<uint32_t> triangles(indices.begin(), indices.begin() + 3 * triangleCount);
+   std::vector<uint32_t> triangleSubmesh(triangleCount, 0);
+   for (std::size_t s = 0; s < submeshes.size(); ++s)
+   {
+      const auto& submesh = submeshes[s];
+      for (auto t = submesh.offset / 3; t < (submesh.offset + submesh.count) / 3 && t < triangleCount; ++t)
+         triangleSubmesh[t] = s;
+   }
+
+   // Find the triangles that reference each vertex, and lock the vertices that must not
+   // move: those shared by several submeshes, those on a border (an edge that belongs
+   // to a single triangle), and those that share their position with another vertex,
+   // i.e. vertices on a normal, tangent or texture seam.
+   std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+   std::vector<bool> isLocked(vertexCount, false);
+   {
+      std::vector<int64_t> vertexSubmesh(vertexCount, -1);
+      std::unordered_map<uint64_t, uint32_t> edges;
+      edges.reserve(3 * triangleCount);
+      for (std::size_t t = 0; t < triangleCount; ++t)
+      {
+         for (unsigned int c = 0; c < 3; ++c)
+         {
+            const auto& a = triangles[3 * t + c];
+            const auto& b = triangles[3 * t + (c + 1) % 3];
+            vertexTriangles[a].push_back(t);
+
+            if (vertexSubmesh[a] < 0)
+               vertexSubmesh[a] = triangleSubmesh[t];
+            else if (vertexSubmesh[a] != triangleSubmesh[t])
+               isLocked[a] = true;
+
+            const auto& key = (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+            ++edges[key];
+         }
+      }
+      for (const auto& edge : edges)
+      {
+         if (edge.second == 1)
+         {
+            isLocked[edge.first >> 32] = true;
+            isLocked[edge.first & 0xFFFFFFFF] = true;
+         }
+      }
+
+      std::unordered_map<std::array<float, 3>, uint32_t, PositionHash> positionCounts;
+      for (std::size_t v = 0; v < vertexCount; ++v)
+      {
+         if (!vertexTriangles[v].empty())
+            ++positionCounts[positions[v]];
+      }
+      for (std::size_t v = 0; v < vertexCount; ++v)
+      {
+         if (!vertexTriangles[v].empty() && positionCounts[positions[v]] > 1)
+            isLocked[v] = true;
+      }
+   }
+
+   // Each vertex's quadric is the sum of the quadrics of its triangles' planes.
+   std::vector<Quadric> quadrics(vertexCount);
+   for (std::size_t t = 0; t < triangleCount; ++t)
+   {
+      const auto& p0 = positions[triangles[3 * t + 0]];
+      const auto& N = getNormal(p0, positions[triangles[3 * t + 1]], positions[triangles[3 * t + 2]]);
+      const auto& length = std::sqrt((N[0] * N[0]) + (N[1] * N[1]) + (N[2] * N[2]));
+      if (length > 0.0)
+      {
+         const auto& nx = N[0] / length;
+         const auto& ny = N[1] / length;
+         const auto& nz = N[2] / length;
+         const Quadric plane(nx, ny, nz, -((nx * p0[0]) + (ny * p0[1]) + (nz * p0[2])));
+         for (unsigned int c = 0; c < 3; ++c)
+            quadrics[triangles[3 * t + c]].add(plane);
+      }
+   }
+
+   std::vector<uint32_t> versions(vertexCount, 0);
+   std::vector<bool> isRemoved(vertexCount, false);
+   std::vector<bool> isTriangleRemoved(triangleCount, false);
+   std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+
+   // Evaluate the cheapest way to collapse an edge, i.e. moving either of its vertices
+   // onto the other.
+   const auto evaluateEdge = [&](const uint32_t& a, const uint32_t& b)
+   {
+      Quadric Q = quadrics[a];
+      Q.add(quadrics[b]);
+
+      Collapse collapse{std::numeric_limits<double>::max(), a, b, versions[a], versions[b]};
+      if (!isLocked[a])
+         collapse.cost = Q.evaluate(positions[b]);
+      if (!isLocked[b])
+      {
+         const auto& cost = Q.evaluate(positions[a]);
+         if (cost < collapse.cost)
+            collapse = Collapse{cost, b, a, versions[b], versions[a]};
+      }
+      if (collapse.cost < std::numeric_limits<double>::max())
+         collapses.push(collapse);
+   };
+   for (std::size_t t = 0; t < triangleCount; ++t)
+   {
+      for (unsigned int c = 0; c < 3; ++c)
+      {
+         const auto& a = triangles[3 * t + c];
+         const auto& b = triangles[3 * t + (c + 1) % 3];
+         if (a < b)
+            evaluateEdge(a, b);
+      }
+   }
+
+   auto liveTriangleCount = triangleCount;
+   double maximumCost = 0.0;
+   while (liveTriangleCount > targetTriangleCount && !collapses.empty())
+   {
+      const auto collapse = collapses.top();
+      collapses.pop();
+
+      const auto& source = collapse.source;
+      const auto& target = collapse.target;
+      if
+      (
+         isRemoved[source] || isRemoved[target] ||
+         versions[source] != collapse.sourceVersion || versions[target] != collapse.targetVersion
+      )
+         continue;
+
+      // Make sure the edge still exists, and that moving the source vertex does not flip
+      // any of the triangles that will remain.
+      auto isEdge = false;
+      auto isValid = true;
+      for (const auto& t : vertexTriangles[source])
+      {
+         if (isTriangleRemoved[t])
+            continue;
+
+         auto* const triangle = &triangles[3 * t];
+         if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+         {
+            isEdge = true;
+            continue;
+         }
+
+         std::array<std::array<float, 3>, 3> p;
+         for (unsigned int c = 0; c < 3; ++c)
+            p[c] = positions[triangle[c]];
+         const auto& before = getNormal(p[0], p[1], p[2]);
+         for (unsigned int c = 0; c < 3; ++c)
+         {
+            if (triangle[c] == source)
+               p[c] = positions[target];
+         }
+         const auto& after = getNormal(p[0], p[1], p[2]);
+         if ((before[0] * after[0]) + (before[1] * after[1]) + (before[2] * after[2]) <= 0.0)
+         {
+            isValid = false;
+            break;
+         }
+      }
+      if (!isEdge || !isValid)
+         continue;
+
+      // Collapse the edge: triangles that contain both vertices degenerate and are
+      // removed, and the others now reference the target vertex.
+      for (const auto& t : vertexTriangles[source])
+      {
+         if (isTriangleRemoved[t])
+            continue;
+
+         auto* const triangle = &triangles[3 * t];
+         if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+         {
+            isTriangleRemoved[t] = true;
+            --liveTriangleCount;
+         }
+         else
+         {
+            for (unsigned int c = 0; c < 3; ++c)
+            {
+               if (triangle[c] == source)
+                  triangle[c] = target;
+            }
+            vertexTriangles[target].push_back(t);
+         }
+      }
+      vertexTriangles[source].clear();
+      isRemoved[source] = true;
+      quadrics[target].add(quadrics[source]);
+      ++versions[target];
+      maximumCost = std::max(maximumCost, collapse.cost);
+
+      // Forget removed triangles, then re-evaluate the edges around the target vertex.
+      auto& targetTriangles = vertexTriangles[target];
+      std::size_t n = 0;
+      for (const auto& t : targetTriangles)
+      {
+         if (!isTriangleRemoved[t])
+            targetTriangles[n++] = t;
+      }
+      targetTriangles.resize(n);
+      for (const auto& t : targetTriangles)
+      {
+         for (unsigned int c = 0; c < 3; ++c)
+         {
+            const auto& v = triangles[3 * t + c];
+            if (v != target)
+               evaluateEdge(v, target);
+         }
+      }
+   }
+
+   // Gather the remaining triangles, which are still grouped by submesh.
+   outputIndices.clear();
+   outputIndices.reserve(3 * liveTriangleCount);
+   outputSubmeshes = submeshes;
+   for (std::size_t s = 0; s < submeshes.size(); ++s)
+   {
+      const auto& submesh = submeshes[s];
+      outputSubmeshes[s].offset = outputIndices.size();
+      for (auto t = submesh.offset / 3; t < (submesh.offset + submesh.count) / 3 && t < triangleCount; ++t)
+      {
+         if (!isTriangleRemoved[t])
+            outputIndices.insert(outputIndices.end(), triangles.begin() + 3 * t, triangles.begin() + 3 * (t + 1));
+      }
+      outputSubmeshes[s].count = outputIndices.size() - outputSubmeshes[s].offset;
+   }
+   return std::sqrt(maximumCost);
+}
@@ -22,56 +22,395 @@
  * THE SOFTWARE.
  */
 #include "model3d.hh"
+#include "mesh.optimizer.hh"
+#include "mesh.simplifier.hh"
+#include <unordered_map>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
 
 using clockwork::graphics::Model3D;
 
 
-Model3D::Model3D()
+namespace {
+/**
+ * A vertex's identity when welding: its position index and its single-precision
+ * normal, texture mapping coordinates and tangent. Attributes are compared bitwise.
+ */
+struct VertexKey
+{
+   uint32_t position;
+   std::array<float, 9> attributes;
+
+   bool operator==(const VertexKey& other) const
+   {
+      return position == other.position &&
+             std::memcmp(attributes.data(), other.attributes.data(), sizeof(attributes)) == 0;
+   }
+};
+/**
+ * An FNV-1a hash of a vertex key.
+ */
+struct VertexKeyHash
+{
+   std::size_t operator()(const VertexKey& key) const
+   {
+      uint64_t hash = 14695981039346656037ull;
+      const auto* const position = reinterpret_cast<const uint8_t*>(&key.position);
+      for (std::size_t i = 0; i < sizeof(key.position); ++i)
+         hash = (hash ^ position[i]) * 1099511628211ull;
+
+      const auto* const attributes = reinterpret_cast<const uint8_t*>(key.attributes.data());
+      for (std::size_t i = 0; i < sizeof(key.attributes); ++i)
+         hash = (hash ^ attributes[i]) * 1099511628211ull;
+
+      return static_cast<std::size_t>(hash);
+   }
+};
+} // namespace
+
+
+Model3D::Submesh::Submesh(const uint32_t o, const uint32_t c, const Material& m) :
+offset(o),
+count(c),
+material(m)
 {}
 
 
-Model3D::Model3D(const std::vector<clockwork::Point3>& positions, const std::vector<Face>& faces, const Material& material) :
-_positions(positions),
-_faces(faces),
-_material(material)
+Model3D::LevelOfDetail::LevelOfDetail(const IndexBuffer& i, const std::vector<Submesh>& s, const double& e) :
+indices(i),
+submeshes(s),
+error(e)
 {}
 
 
-const std::vector<clockwork::Point3>&
-Model3D::getVertexPositions() const
+Model3D::Model3D()
+{}
+
+
+Model3D::Model3D(const std::vector<clockwork::Point3>& positions, const std::vector<Face>& faces, const Material& material)
+{
+   setMesh(positions, faces, {Submesh(0, 3 * faces.size(), material)});
+}
+
+
+const std::vector<std::array<float, 3>>&
+Model3D::getPositions() const
 {
    return _positions;
 }
 
 
-const std::vector<clockwork::graphics::Face>&
-Model3D::getFaces() const
+const std::vector<std::array<float, 3>>&
+Model3D::getNormals() const
+{
+   return _normals;
+}
+
+
+const std::vector<std::array<float, 2>>&
+Model3D::getTextureMappingCoordinates() const
+{
+   return _texcoords;
+}
+
+
+const std::vector<std::array<float, 4>>&
+Model3D::getTangents() const
+{
+   return _tangents;
+}
+
+
+const clockwork::graphics::IndexBuffer&
+Model3D::getIndices(const std::size_t& level) const
+{
+   return _levelsOfDetail[level].indices;
+}
+
+
+const std::vector<Model3D::Submesh>&
+Model3D::getSubmeshes(const std::size_t& level) const
+{
+   return _levelsOfDetail[level].submeshes;
+}
+
+
+std::size_t
+Model3D::getVertexCount() const
 {
-   return _faces;
+   return _positions.size();
+}
+
+
+std::size_t
+Model3D::getTriangleCount(const std::size_t& level) const
+{
+   return level < _levelsOfDetail.size() ? _levelsOfDetail[level].indices.size() / 3 : 0;
+}
+
+
+const std::vector<Model3D::LevelOfDetail>&
+Model3D::getLevelsOfDetail() const
+{
+   return _levelsOfDetail;
 }
 
 
 void
-Model3D::addFace
+Model3D::addLevelOfDetail(const std::vector<uint32_t>& indices, const std::vector<Submesh>& submeshes, const double& error)
+{
+   _levelsOfDetail.push_back(LevelOfDetail(IndexBuffer(indices, _positions.size()), submeshes, error));
+}
+
+
+void
+Model3D::generateLevelsOfDetail
 (
-   const std::array<const uint32_t, 3>& indices,
-   const std::array<const clockwork::Vector3, 3>& normals,
-   const std::array<const Texture::Coordinates, 3>& texcoords
+   const std::size_t& maximumLevelCount,
+   const double& reduction,
+   const std::size_t& minimumTriangleCount
 )
 {
-   _faces.push_back(Face(indices, normals, texcoords));
+   if (isEmpty())
+      return;
+
+   _levelsOfDetail.resize(1);
+   while (_levelsOfDetail.size() < maximumLevelCount)
+   {
+      // Each level is simplified from the previous one, which is faster than simplifying
+      // the original mesh and keeps the levels nested. Since the errors are measured
+      // against the previous level, they are accumulated to bound the error against the
+      // original mesh.
+      const auto& previous = _levelsOfDetail.back();
+      const auto& previousTriangleCount = previous.indices.size() / 3;
+      if (previousTriangleCount <= minimumTriangleCount)
+         break;
+
+      const auto& target = static_cast<std::size_t>(reduction * previousTriangleCount);
+      std::vector<uint32_t> indices;
+      std::vector<Submesh> submeshes;
+      const auto& error = clockwork::graphics::simplifyMesh
+      (
+         _positions,
+         previous.indices.toVector(),
+         previous.submeshes,
+         std::max(target, minimumTriangleCount),
+         indices,
+         submeshes
+      );
+
+      // Stop if the mesh could not be simplified much further, e.g. if most of its
+      // vertices are locked.
+      if (indices.size() / 3 > 0.9 * previousTriangleCount)
+         break;
+
+      addLevelOfDetail(indices, submeshes, previous.error + error);
+   }
+}
+
+
+const clockwork::graphics::BoundingBox&
+Model3D::getBoundingBox() const
+{
+   return _boundingBox;
+}
+
+
+const clockwork::graphics::BoundingSphere&
+Model3D::getBoundingSphere() const
+{
+   return _boundingSphere;
 }
 
 
-const clockwork::graphics::Material&
-Model3D::getMaterial() const
+const clockwork::graphics::TriangleHierarchy&
+Model3D::getTriangleHierarchy() const
 {
-   return _material;
+   // The hierarchy may be requested from several threads at once. In the worst case it is
+   // built more than once, and only the first copy to be stored is kept.
+   auto hierarchy = std::atomic_load(&_triangleHierarchy);
+   if (hierarchy == nullptr)
+   {
+      std::shared_ptr<const TriangleHierarchy> expected;
+      hierarchy = std::make_shared<const TriangleHierarchy>(*this);
+      if (!std::atomic_compare_exchange_strong(&_triangleHierarchy, &expected, hierarchy))
+         hierarchy = expected;
+   }
+   return *hierarchy;
+}
+
+
+void
+Model3D::setMesh
+(
+   const std::vector<clockwork::Point3>& positions,
+   const std::vector<Face>& faces,
+   const std::vector<Submesh>& submeshes
+)
+{
+   _positions.clear();
+   _normals.clear();
+   _texcoords.clear();
+   _tangents.clear();
+
+   // Weld the faces' corners into unique vertices. Corners that share a position and
+   // have identical attributes (in single precision) become the same vertex.
+   std::unordered_map<VertexKey, uint32_t, VertexKeyHash> vertices;
+   vertices.reserve(faces.size() * 3);
+
+   std::vector<uint32_t> indices;
+   indices.reserve(faces.size() * 3);
+   for (const auto& face : faces)
+   {
+      const auto& faceIndices = face.getIndices();
+      const auto& normals = face.getNormals();
+      const auto& uvmaps = face.getTextureMappingCoordinates();
+      const auto& tangents = face.getTangents();
+      for (unsigned int c = 0; c < 3; ++c)
+      {
+         const auto& normal = normals[c];
+         const auto& uvmap = uvmaps[c];
+         const auto& tangent = tangents[c];
+
+         const VertexKey key =
+         {
+            faceIndices[c],
+            {{
+               static_cast<float>(normal.i), static_cast<float>(normal.j), static_cast<float>(normal.k),
+               static_cast<float>(uvmap.u), static_cast<float>(uvmap.v),
+               static_cast<float>(tangent.direction.i),
+               static_cast<float>(tangent.direction.j),
+               static_cast<float>(tangent.direction.k),
+               static_cast<float>(tangent.handedness)
+            }}
+         };
+         const auto& result = vertices.insert(std::make_pair(key, static_cast<uint32_t>(_positions.size())));
+         if (result.second)
+         {
+            const auto& position = positions[faceIndices[c]];
+            const auto& a = key.attributes;
+
+            _positions.push_back({{static_cast<float>(position.x), static_cast<float>(position.y), static_cast<float>(position.z)}});
+            _normals.push_back({{a[0], a[1], a[2]}});
+            _texcoords.push_back({{a[3], a[4]}});
+            _tangents.push_back({{a[5], a[6], a[7], a[8]}});
+         }
+         indices.push_back(result.first->second);
+      }
+   }
+
+   _positions.shrink_to_fit();
+   _normals.shrink_to_fit();
+   _texcoords.shrink_to_fit();
+   _tangents.shrink_to_fit();
+
+   _levelsOfDetail.assign(1, LevelOfDetail(IndexBuffer(indices, _positions.size()), submeshes, 0.0));
+   updateBoundingVolumes();
+}
+
+
+void
+Model3D::setMesh
+(
+   const std::vector<std::array<float, 3>>& positions,
+   const std::vector<std::array<float, 3>>& normals,
+   const std::vector<std::array<float, 2>>& texcoords,
+   const std::vector<std::array<float, 4>>& tangents,
+   const std::vector<uint32_t>& indices,
+   const std::vector<Submesh>& submeshes
+)
+{
+   _positions = positions;
+   _normals = normals;
+   _texcoords = texcoords;
+   _tangents = tangents;
+   _levelsOfDetail.assign(1, LevelOfDetail(IndexBuffer(indices, _positions.size()), submeshes, 0.0));
+   updateBoundingVolumes();
+}
+
+
+void
+Model3D::optimize()
+{
+   if (isEmpty())
+      return;
+
+   const auto& vertexCount = getVertexCount();
+   std::vector<std::vector<uint32_t>> levelIndices;
+   for (const auto& level : _levelsOfDetail)
+   {
+      // Triangles are only reordered within their submesh so that material ranges are preserved.
+      auto indices = level.indices.toVector();
+      std::vector<std::size_t> clusters;
+      for (const auto& submesh : level.submeshes)
+      {
+         auto* const first = indices.data() + submesh.offset;
+         clockwork::graphics::optimizeVertexCache(first, submesh.count, vertexCount, clusters);
+         clockwork::graphics::optimizeOverdraw(first, submesh.count, _positions, clusters);
+      }
+      levelIndices.push_back(indices);
+   }
+
+   // Renumber the vertices in the order they are first used by the original mesh. The
+   // other levels only use a subset of the original mesh's vertices.
+   const auto& remap = clockwork::graphics::optimizeVertexFetch(levelIndices[0], vertexCount);
+   const auto& usedVertexCount = static_cast<std::size_t>(*std::max_element(remap.begin(), remap.end()) + 1);
+   for (std::size_t l = 1; l < levelIndices.size(); ++l)
+   {
+      for (auto& index : levelIndices[l])
+         index = remap[index];
+   }
+
+   std::vector<std::array<float, 3>> positions(usedVertexCount);
+   std::vector<std::array<float, 3>> normals(usedVertexCount);
+   std::vector<std::array<float, 2>> texcoords(usedVertexCount);
+   std::vector<std::array<float, 4>> tangents(usedVertexCount);
+   for (std::size_t v = 0; v < vertexCount; ++v)
+   {
+      const auto& newIndex = remap[v];
+      if (newIndex >= 0)
+      {
+         positions[newIndex] = _positions[v];
+         normals[newIndex] = _normals[v];
+         texcoords[newIndex] = _texcoords[v];
+         tangents[newIndex] = _tangents[v];
+      }
+   }
+
+   const auto levels = _levelsOfDetail;
+   setMesh(positions, normals, texcoords, tangents, levelIndices[0], levels[0].submeshes);
+   for (std::size_t l = 1; l < levels.size(); ++l)
+      addLevelOfDetail(levelIndices[l], levels[l].submeshes, levels[l].error);
+}
+
+
+void
+Model3D::updateBoundingVolumes()
+{
+   std::atomic_store(&_triangleHierarchy, std::shared_ptr<const TriangleHierarchy>());
+
+   _boundingBox = BoundingBox();
+   for (const auto& p : _positions)
+      _boundingBox.extend(clockwork::Point3(p[0], p[1], p[2]));
+
+   // The sphere is centered on the box, which is not the tightest fit but is cheap
+   // and stable.
+   double radiusSquared = 0.0;
+   const auto& center = _boundingBox.getCenter();
+   for (const auto& p : _positions)
+   {
+      const auto& dx = p[0] - center.x;
+      const auto& dy = p[1] - center.y;
+      const auto& dz = p[2] - center.z;
+      radiusSquared = std::max(radiusSquared, (dx * dx) + (dy * dy) + (dz * dz));
+   }
+   _boundingSphere = BoundingSphere(_positions.empty() ? clockwork::Point3() : center, std::sqrt(radiusSquared));
 }
 
 
 bool
 Model3D::isEmpty() const
 {
-   return _positions.empty() || _faces.empty();
+   return _positions.empty() || _levelsOfDetail.empty() || _levelsOfDetail[0].indices.isEmpty();
 }
@@ -0,0 +1,252 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "occlusion.buffer.hh"
+#include "model3d.hh"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <array>
+
+using clockwork::graphics::OcclusionBuffer;
+
+
+constexpr uint32_t OcclusionBuffer::WIDTH;
+constexpr uint32_t OcclusionBuffer::HEIGHT;
+
+
+namespace {
+/**
+ * Vertices whose W coordinate is below this value are considered to be behind the viewer.
+ */
+constexpr double MINIMUM_W = 1e-6;
+/**
+ * A vertex in the buffer's coordinate space.
+ */
+struct BufferVertex
+{
+   double x;
+   double y;
+   double z;
+};
+/**
+ * Convert a clip-space position into the buffer's coordinate space.
+ */
+BufferVertex
+toBufferSpace(const clockwork::Point4& p)
+{
+   return
+   {
+      ((0.5 * p.x / p.w) + 0.5) * OcclusionBuffer::WIDTH,
+      ((0.5 * p.y / p.w) + 0.5) * OcclusionBuffer::HEIGHT,
+      p.z / p.w
+   };
+}
+} // namespace
+
+
+OcclusionBuffer::OcclusionBuffer() :
+_depths(WIDTH * HEIGHT, std::numeric_limits<float>::infinity()),
+_isEmpty(true)
+{}
+
+
+void
+OcclusionBuffer::clear()
+{
+   if (!_isEmpty)
+   {
+      std::fill(_depths.begin(), _depths.end(), std::numeric_limits<float>::infinity());
+      _isEmpty = true;
+   }
+}
+
+
+bool
+OcclusionBuffer::isEmpty() const
+{
+   return _isEmpty;
+}
+
+
+void
+OcclusionBuffer::addOccluder(const Model3D& model3D, const clockwork::Matrix4& transform)
+{
+   const auto& positions = model3D.getPositions();
+   const auto& indices = model3D.getIndices();
+
+   std::vector<clockwork::Point4> vertices;
+   vertices.reserve(positions.size());
+   for (const auto& p : positions)
+      vertices.push_back(transform * clockwork::Point4(p[0], p[1], p[2], 1.0));
+
+   for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+      addOccluder(vertices[indices.get(i)], vertices[indices.get(i + 1)], vertices[indices.get(i + 2)]);
+}
+
+
+void
+OcclusionBuffer::addOccluder(const clockwork::Point4& p0, const clockwork::Point4& p1, const clockwork::Point4& p2)
+{
+   if (p0.w < MINIMUM_W || p1.w < MINIMUM_W || p2.w < MINIMUM_W)
+      return;
+
+   auto a = toBufferSpace(p0);
+   auto b = toBufferSpace(p1);
+   auto c = toBufferSpace(p2);
+
+   // Make sure the triangle is counter-clockwise so that its interior is on the positive
+   // side of each edge.
+   const auto& area = ((b.x - a.x) * (c.y - a.y)) - ((b.y - a.y) * (c.x - a.x));
+   if (std::abs(area) < 1e-12)
+      return;
+   if (area < 0.0)
+      std::swap(b, c);
+
+   const auto xmin = std::max(0.0, std::floor(std::min({a.x, b.x, c.x})));
+   const auto ymin = std::max(0.0, std::floor(std::min({a.y, b.y, c.y})));
+   const auto xmax = std::min(WIDTH - 1.0, std::ceil(std::max({a.x, b.x, c.x})) - 1.0);
+   const auto ymax = std::min(HEIGHT - 1.0, std::ceil(std::max({a.y, b.y, c.y})) - 1.0);
+   if (xmin > xmax || ymin > ymax)
+      return;
+
+   // Each edge function E(x, y) = Ax + By + C is positive inside the triangle. A texel is
+   // completely covered if each edge function is positive at the texel's corner that is
+   // nearest to the edge, i.e. at its center minus half of |A| + |B|.
+   struct Edge { double A, B, C, margin; };
+   const auto& createEdge = [](const BufferVertex& p, const BufferVertex& q)
+   {
+      const auto& A = p.y - q.y;
+      const auto& B = q.x - p.x;
+      return Edge{A, B, -((A * p.x) + (B * p.y)), 0.5 * (std::abs(A) + std::abs(B))};
+   };
+   const std::array<Edge, 3> edges = {{createEdge(a, b), createEdge(b, c), createEdge(c, a)}};
+
+   // The triangle's farthest depth is written to every texel it covers, which never
+   // brings an occluder nearer than it really is.
+   const auto& depth = static_cast<float>(std::max({a.z, b.z, c.z}));
+   for (auto y = static_cast<uint32_t>(ymin); y <= static_cast<uint32_t>(ymax); ++y)
+   {
+      const auto& cy = y + 0.5;
+      for (auto x = static_cast<uint32_t>(xmin); x <= static_cast<uint32_t>(xmax); ++x)
+      {
+         const auto& cx = x + 0.5;
+         auto isCovered = true;
+         for (const auto& edge : edges)
+            isCovered = isCovered && (edge.A * cx) + (edge.B * cy) + edge.C - edge.margin >= 0.0;
+
+         if (isCovered)
+         {
+            auto& texel = _depths[(y * WIDTH) + x];
+            texel = std::min(texel, depth);
+            _isEmpty = false;
+         }
+      }
+   }
+}
+
+
+bool
+OcclusionBuffer::isVisible(const BoundingBox& box, const clockwork::Matrix4& transform) const
+{
+   if (_isEmpty || box.isEmpty())
+      return true;
+
+   std::array<clockwork::Point4, 8> corners;
+   for (unsigned int i = 0; i < 8; ++i)
+   {
+      corners[i] = transform * clockwork::Point4
+      (
+         i & 1 ? box.maximum.x : box.minimum.x,
+         i & 2 ? box.maximum.y : box.minimum.y,
+         i & 4 ? box.maximum.z : box.minimum.z,
+         1.0
+      );
+   }
+   return isVisible(corners.data(), corners.size());
+}
+
+
+bool
+OcclusionBuffer::isVisible(const clockwork::Point4* const points, const std::size_t& count) const
+{
+   if (_isEmpty)
+      return true;
+
+   auto xmin = std::numeric_limits<double>::max();
+   auto ymin = std::numeric_limits<double>::max();
+   auto zmin = std::numeric_limits<double>::max();
+   auto xmax = std::numeric_limits<double>::lowest();
+   auto ymax = std::numeric_limits<double>::lowest();
+   for (std::size_t i = 0; i < count; ++i)
+   {
+      // Points behind the viewer cannot be projected, so the bounds are assumed to be visible.
+      const auto& p = points[i];
+      if (p.w < MINIMUM_W)
+         return true;
+
+      const auto& x = p.x / p.w;
+      const auto& y = p.y / p.w;
+      xmin = std::min(xmin, x);
+      ymin = std::min(ymin, y);
+      zmin = std::min(zmin, p.z / p.w);
+      xmax = std::max(xmax, x);
+      ymax = std::max(ymax, y);
+   }
+   return isVisible(xmin, ymin, xmax, ymax, zmin);
+}
+
+
+bool
+OcclusionBuffer::isVisible(const double& xmin, const double& ymin, const double& xmax, const double& ymax, const double& depth) const
+{
+   if (_isEmpty)
+      return true;
+
+   // Find the texels that the rectangle overlaps. A rectangle that is not on the screen
+   // is left for frustum culling to decide.
+   const auto& x0 = std::floor(((0.5 * xmin) + 0.5) * WIDTH);
+   const auto& y0 = std::floor(((0.5 * ymin) + 0.5) * HEIGHT);
+   const auto& x1 = std::ceil(((0.5 * xmax) + 0.5) * WIDTH) - 1.0;
+   const auto& y1 = std::ceil(((0.5 * ymax) + 0.5) * HEIGHT) - 1.0;
+   if (x1 < 0.0 || y1 < 0.0 || x0 > WIDTH - 1.0 || y0 > HEIGHT - 1.0)
+      return true;
+
+   const auto& left = static_cast<uint32_t>(std::max(0.0, x0));
+   const auto& bottom = static_cast<uint32_t>(std::max(0.0, y0));
+   const auto& right = static_cast<uint32_t>(std::min(WIDTH - 1.0, std::max(x0, x1)));
+   const auto& top = static_cast<uint32_t>(std::min(HEIGHT - 1.0, std::max(y0, y1)));
+
+   // The rectangle is visible if it is in front of the occluders in at least one texel.
+   const auto& z = static_cast<float>(depth);
+   for (auto y = bottom; y <= top; ++y)
+   {
+      const auto* const row = _depths.data() + (y * WIDTH);
+      for (auto x = left; x <= right; ++x)
+      {
+         if (z <= row[x])
+            return true;
+      }
+   }
+   return false;
+}
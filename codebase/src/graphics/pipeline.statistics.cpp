@@ -1,9 +1,8 @@
 /*
- * This file is part of Clockwork.
+ * The MIT License (MIT)
  *
- * Copyright (c) 2014-2016 Jeremy Othieno.
+ * Copyright (c) 2014 Jeremy Othieno.
  *
- * The MIT License (MIT)
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
  * in the Software without restriction, including without limitation the rights
@@ -22,28 +21,25 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-#include "FramebufferProvider.hh"
-#include "Framebuffer.hh"
-
-using clockwork::FramebufferProvider;
-
+#include "pipeline.statistics.hh"
 
-FramebufferProvider::FramebufferProvider(const Framebuffer& framebuffer) :
-QQuickImageProvider(QQmlImageProviderBase::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading),
-framebuffer_(framebuffer)
-{}
+using clockwork::graphics::PipelineStatistics;
 
 
-QImage
-FramebufferProvider::requestImage(const QString& id, QSize* const size, const QSize&)
+PipelineStatistics&
+PipelineStatistics::operator+=(const PipelineStatistics& statistics)
 {
-    if (size != nullptr)
-        *size = framebuffer_.getResolution();
+   verticesIn += statistics.verticesIn;
+   vertexCacheHits += statistics.vertexCacheHits;
+   primitivesAssembled += statistics.primitivesAssembled;
+   backfaceCulled += statistics.backfaceCulled;
+   frustumCulled += statistics.frustumCulled;
+   occlusionCulled += statistics.occlusionCulled;
+   primitivesClipped += statistics.primitivesClipped;
+   fragmentsGenerated += statistics.fragmentsGenerated;
+   fragmentsDepthRejected += statistics.fragmentsDepthRejected;
+   fragmentsShaded += statistics.fragmentsShaded;
+   fragmentsWritten += statistics.fragmentsWritten;
 
-    if (id == "depth")
-        return framebuffer_.getDepthBufferImage();
-    else if (id == "stencil")
-        return framebuffer_.getStencilBufferImage();
-    else
-        return framebuffer_.getPixelBufferImage();
+   return *this;
 }
@@ -1,9 +1,8 @@
 /*
- * This file is part of Clockwork.
+ * The MIT License (MIT)
  *
- * Copyright (c) 2014-2016 Jeremy Othieno.
+ * Copyright (c) 2014 Jeremy Othieno.
  *
- * The MIT License (MIT)
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
  * in the Software without restriction, including without limitation the rights
@@ -22,26 +21,39 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-#ifndef CLOCKWORK_FRAMEBUFFER_PROVIDER_HH
-#define CLOCKWORK_FRAMEBUFFER_PROVIDER_HH
-
-#include <QQuickImageProvider>
-
+#include "ray.hh"
+#include <limits>
 
-namespace clockwork {
+using clockwork::graphics::Ray;
 
-class Framebuffer;
 
-class FramebufferProvider final : public QQuickImageProvider
+namespace {
+/**
+ * Return the reciprocal of a value. Zero is mapped to the largest double so that
+ * axis-parallel rays produce slabs that extend to infinity.
+ */
+double
+reciprocal(const double& value)
 {
-public:
-	explicit FramebufferProvider(const Framebuffer& framebuffer);
+   return value != 0.0 ? 1.0 / value : std::numeric_limits<double>::max();
+}
+} // namespace
+
 
-	QImage requestImage(const QString& id, QSize* const size, const QSize&) override;
-private:
-	const Framebuffer& framebuffer_;
-};
+Ray::Ray(const clockwork::Point3& o, const clockwork::Vector3& d) :
+origin(o),
+direction(clockwork::Vector3::normalise(d)),
+inverseDirection(reciprocal(direction.i), reciprocal(direction.j), reciprocal(direction.k))
+{}
 
-} // namespace clockwork
 
-#endif // CLOCKWORK_FRAMEBUFFER_PROVIDER_HH
+clockwork::Point3
+Ray::getPoint(const double& distance) const
+{
+   return clockwork::Point3
+   (
+      origin.x + (distance * direction.i),
+      origin.y + (distance * direction.j),
+      origin.z + (distance * direction.k)
+   );
+}
@@ -22,3 +22,29 @@
  * THE SOFTWARE.
  */
 #include "bump.map.render.algorithm.hh"
+
+using clockwork::graphics::BumpMapRenderAlgorithm;
+
+
+BumpMapRenderAlgorithm::BumpMapRenderAlgorithm() :
+PolygonRenderAlgorithm(RenderAlgorithm::Identifier::Bump)
+{}
+
+
+clockwork::graphics::Vertex
+BumpMapRenderAlgorithm::vertexProgram
+(
+   const RenderAlgorithm::Parameters& parameters,
+   const clockwork::Point3& position,
+   const clockwork::Vector3& normal,
+   const Tangent& tangent,
+   const Texture::Coordinates& uvmap
+) const
+{
+   Vertex output = RenderAlgorithm::vertexProgram(parameters, position, normal, tangent, uvmap);
+   output.normal = clockwork::Vector3::normalise(parameters.NORMAL * normal);
+   output.tangent.direction = clockwork::Vector3::normalise(parameters.MODELVIEW * tangent.direction);
+   output.tangent.handedness = tangent.handedness;
+
+   return output;
+}
@@ -37,10 +37,11 @@ NormalMapRenderAlgorithm::vertexProgram
    const RenderAlgorithm::Parameters& parameters,
    const clockwork::Point3& position,
    const clockwork::Vector3& normal,
+   const Tangent& tangent,
    const Texture::Coordinates& uvmap
 ) const
 {
-   Vertex output = RenderAlgorithm::vertexProgram(parameters, position, normal, uvmap);
+   Vertex output = RenderAlgorithm::vertexProgram(parameters, position, normal, tangent, uvmap);
    output.normal = clockwork::Vector3::normalise(parameters.NORMAL * normal);
 
    return output;
@@ -39,6 +39,13 @@ PointRenderAlgorithm::primitiveAssembly(const clockwork::graphics::PrimitiveMode
 }
 
 
+std::size_t
+PointRenderAlgorithm::getPrimitiveVertexCount() const
+{
+   return 1;
+}
+
+
 clockwork::graphics::VertexArray&
 PointRenderAlgorithm::clip(VertexArray& vertices) const
 {
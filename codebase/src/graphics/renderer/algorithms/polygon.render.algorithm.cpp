@@ -23,7 +23,9 @@
  */
 #include "polygon.render.algorithm.hh"
 #include "numerical.hh"
+#include "services.hh"
 #include <algorithm>
+#include <array>
 
 using clockwork::graphics::PolygonRenderAlgorithm;
 
@@ -96,6 +98,38 @@ PolygonRenderAlgorithm::backfaceCulling(VertexArray& vertices) const
 }
 
 
+clockwork::graphics::VertexArray&
+PolygonRenderAlgorithm::occlusionCulling(VertexArray& vertices) const
+{
+   const auto& occlusionBuffer = clockwork::system::Services::Graphics.getOcclusionBuffer();
+   if (occlusionBuffer.isEmpty())
+      return vertices;
+
+   // Compact the visible triangles to the front of the array, then remove the rest.
+   std::size_t visibleCount = 0;
+   for (std::size_t i = 0; i + 2 < vertices.size(); i += 3)
+   {
+      const std::array<clockwork::Point4, 3> triangle = {{vertices[i], vertices[i + 1], vertices[i + 2]}};
+      if (occlusionBuffer.isVisible(triangle.data(), triangle.size()))
+      {
+         if (visibleCount != i)
+            std::copy(vertices.begin() + i, vertices.begin() + i + 3, vertices.begin() + visibleCount);
+         visibleCount += 3;
+      }
+   }
+   vertices.erase(vertices.begin() + visibleCount, vertices.end());
+
+   return vertices;
+}
+
+
+std::size_t
+PolygonRenderAlgorithm::getPrimitiveVertexCount() const
+{
+   return 3;
+}
+
+
 clockwork::graphics::VertexArray&
 PolygonRenderAlgorithm::clip(VertexArray& vertices) const
 {
@@ -33,39 +33,126 @@
 #include "bump.map.render.algorithm.hh"
 #include "deferred.render.algorithm.hh"
 #include "services.hh"
+#include "profiler.hh"
 #include "scene.viewer.hh"
+#include "scene.snapshot.hh"
 #include "property.appearance.hh"
 #include "primitive.mode.hh"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 
 
 using clockwork::graphics::RenderAlgorithm;
 using clockwork::graphics::RenderAlgorithmFactory;
 
 
+namespace {
+/**
+ * The VertexCache maps a vertex to the position of its processed copy. Each entry is
+ * stamped with the generation in which it was written, so the cache is emptied by
+ * starting a new generation rather than by clearing its entries.
+ */
+class VertexCache
+{
+public:
+   /**
+    * Empty the cache, and make room for a given number of vertices.
+    * @param vertexCount the number of vertices.
+    */
+   void reset(const std::size_t& vertexCount)
+   {
+      if (_stamps.size() < vertexCount)
+      {
+         _stamps.resize(vertexCount, 0);
+         _slots.resize(vertexCount);
+      }
+
+      // The stamps only need to be cleared when the generation wraps around.
+      if (++_generation == 0)
+      {
+         std::fill(_stamps.begin(), _stamps.end(), 0);
+         _generation = 1;
+      }
+   }
+   /**
+    * Return the position of a vertex's processed copy, or nullptr if the vertex hasn't
+    * been processed since the cache was last reset.
+    * @param index the vertex's index.
+    */
+   const uint32_t* find(const uint32_t& index) const
+   {
+      return _stamps[index] == _generation ? &_slots[index] : nullptr;
+   }
+   /**
+    * Store the position of a vertex's processed copy.
+    * @param index the vertex's index.
+    * @param slot the position of the processed copy.
+    */
+   void insert(const uint32_t& index, const uint32_t& slot)
+   {
+      _stamps[index] = _generation;
+      _slots[index] = slot;
+   }
+private:
+   /**
+    * The generation in which each entry was written.
+    */
+   std::vector<uint32_t> _stamps;
+   /**
+    * The position of each vertex's processed copy.
+    */
+   std::vector<uint32_t> _slots;
+   /**
+    * The current generation.
+    */
+   uint32_t _generation = 0;
+};
+} // namespace
+
+
 RenderAlgorithm::Parameters::Parameters
 (
    const clockwork::graphics::Model3D& mod3d,
    const clockwork::graphics::Material& mat,
    const clockwork::Matrix4& modelTransform,
-   clockwork::scene::Viewer& viewer
+   const clockwork::scene::ViewerSnapshot& viewer
 ) :
 model3D(mod3d),
 material(mat),
-viewpoint(viewer.getPosition()),
-viewport(viewer.getViewport()),
-primitiveMode(*clockwork::graphics::PrimitiveModeFactory::getInstance().get(viewer.getPrimitiveMode())),
-lineAlgorithm(*clockwork::graphics::LineAlgorithmFactory::getInstance().get(viewer.getLineAlgorithm())),
+viewpoint(viewer.position),
+viewport(viewer.viewport),
+primitiveMode(*clockwork::graphics::PrimitiveModeFactory::getInstance().get(viewer.primitiveMode)),
+lineAlgorithm(*clockwork::graphics::LineAlgorithmFactory::getInstance().get(viewer.lineAlgorithm)),
 MODEL(modelTransform),
 INVERSE_MODEL(clockwork::Matrix4::inverse(MODEL)),
-VIEW(viewer.getViewTransform()),
+VIEW(viewer.VIEW),
 MODELVIEW(VIEW * MODEL),
-PROJECTION(viewer.getProjectionTransform()),
-VIEWPROJECTION(viewer.getViewProjectionTransform()),
+PROJECTION(viewer.PROJECTION),
+VIEWPROJECTION(viewer.VIEWPROJECTION),
 MODELVIEWPROJECTION(VIEWPROJECTION * MODEL),
 NORMAL(clockwork::Matrix4::transpose(clockwork::Matrix4::inverse(MODELVIEW)))
 {}
 
 
+RenderAlgorithm::Parameters::Parameters(const RenderAlgorithm::Parameters& other, const clockwork::graphics::Material& mat) :
+model3D(other.model3D),
+material(mat),
+viewpoint(other.viewpoint),
+viewport(other.viewport),
+primitiveMode(other.primitiveMode),
+lineAlgorithm(other.lineAlgorithm),
+MODEL(other.MODEL),
+INVERSE_MODEL(other.INVERSE_MODEL),
+VIEW(other.VIEW),
+MODELVIEW(other.MODELVIEW),
+PROJECTION(other.PROJECTION),
+VIEWPROJECTION(other.VIEWPROJECTION),
+MODELVIEWPROJECTION(other.MODELVIEWPROJECTION),
+NORMAL(other.NORMAL)
+{}
+
+
 RenderAlgorithm::RenderAlgorithm(const RenderAlgorithm::Identifier& identifier) :
 _identifier(identifier)
 {}
@@ -88,46 +175,217 @@ RenderAlgorithm::apply(clockwork::scene::Object& object, clockwork::scene::Viewe
    static_cast<const Appearance*>(object.getProperty(Property::Identifier::Appearance));
    assert(appearance != nullptr);
 
-   const auto* model3D = appearance->getModel3D();
+   // Objects that are rendered immediately are captured on the spot, and their level
+   // of detail is remembered by their appearance.
+   const clockwork::scene::ObjectSnapshot objectSnapshot =
+   {
+      &object,
+      appearance->getModel3D(),
+      appearance->getMaterial(),
+      object.getCMTM(),
+      clockwork::graphics::BoundingBox()
+   };
+   clockwork::scene::ViewerSnapshot viewerSnapshot;
+   viewerSnapshot.capture(viewer);
+
+   auto level = appearance->getLevelOfDetail(viewer);
+   std::vector<RenderAlgorithm::DrawCommand> commands;
+   PipelineStatistics statistics;
+   process(objectSnapshot, viewerSnapshot, level, commands, statistics);
+   appearance->setLevelOfDetail(viewer, level);
+
+   for (const auto& command : commands)
+      draw(command);
+}
+
+
+void
+RenderAlgorithm::process
+(
+   const clockwork::scene::ObjectSnapshot& object,
+   const clockwork::scene::ViewerSnapshot& viewer,
+   std::size_t& levelOfDetail,
+   std::vector<RenderAlgorithm::DrawCommand>& commands,
+   PipelineStatistics& statistics
+) const
+{
+   const auto* model3D = object.model3D;
    assert(model3D != nullptr && !model3D->isEmpty());
 
-   const auto& material = appearance->getMaterial();
-   const auto& MODEL = object.getModelTransform();
+   // The transforms are shared by every submesh, so they are only computed once.
+   const RenderAlgorithm::Parameters parameters(*model3D, object.material, object.MODEL, viewer);
+
+   const auto& level = selectLevelOfDetail(levelOfDetail, parameters);
+   levelOfDetail = level;
+   const auto& positions = model3D->getPositions();
+   const auto& normals = model3D->getNormals();
+   const auto& uvmaps = model3D->getTextureMappingCoordinates();
+   const auto& tangents = model3D->getTangents();
+   const auto& indices = model3D->getIndices(level);
+
+   // The vertex program is applied once to each unique vertex in a submesh. The vertex
+   // cache maps a vertex to the position of its processed copy in 'processed'. Each
+   // thread keeps its cache across objects and frames, so it is only grown when a model
+   // with more vertices is drawn, and never cleared.
+   thread_local VertexCache vertexCache;
+   VertexArray processed;
+
+   // Faces are grouped by material, so the material state only needs to be set up once
+   // for each submesh.
+   for (const auto& submesh : model3D->getSubmeshes(level))
+   {
+      const RenderAlgorithm::Parameters submeshParameters(parameters, submesh.material);
+      const auto& first = submesh.offset;
+      const auto& last = submesh.offset + submesh.count;
+
+      VertexArray vertices;
+      vertices.reserve(submesh.count);
+      processed.clear();
+
+      // The vertex program's output may depend on the submesh's material, so each
+      // submesh starts with an empty cache.
+      vertexCache.reset(model3D->getVertexCount());
+
+      {
+         CLOCKWORK_PROFILE(Vertex);
+
+         // Apply the vertex program to each position, normal, tangent and mapping coordinate
+         // attribute, then store the resulting vertex.
+         for (auto i = first; i < last; ++i)
+         {
+            const auto& index = indices.get(i);
+            const auto* const cached = vertexCache.find(index);
+            if (cached != nullptr)
+               vertices.push_back(processed[*cached]);
+            else
+            {
+               const auto& p = positions[index];
+               const auto& n = normals[index];
+               const auto& t = tangents[index];
+               const auto& uv = uvmaps[index];
+
+               vertexCache.insert(index, static_cast<uint32_t>(processed.size()));
+               processed.push_back
+               (
+                  vertexProgram
+                  (
+                     submeshParameters,
+                     clockwork::Point3(p[0], p[1], p[2]),
+                     clockwork::Vector3(n[0], n[1], n[2]),
+                     Tangent(clockwork::Vector3(t[0], t[1], t[2]), t[3]),
+                     Texture::Coordinates(uv[0], uv[1])
+                  )
+               );
+               vertices.push_back(processed.back());
+            }
+         }
+         statistics.verticesIn += submesh.count;
+         statistics.vertexCacheHits += submesh.count - processed.size();
+      }
+
+      if (prepare(submeshParameters, vertices, statistics))
+         commands.push_back({this, object.key, submeshParameters, std::move(vertices)});
+   }
+}
 
-   const RenderAlgorithm::Parameters parameters(*model3D, material, MODEL, viewer);
 
-   VertexArray vertices;
+void
+RenderAlgorithm::draw(const RenderAlgorithm::DrawCommand& command) const
+{
+   assert(command.algorithm == this);
 
-   // Apply the vertex program to each position, normal and mapping coordinate attribute,
-   // then store the resulting vertex.
-   const auto& positions = model3D->getVertexPositions();
-   for (const auto& face : model3D->getFaces())
+   CLOCKWORK_PROFILE(Raster);
+   rasterise(command.parameters, command.vertices);
+}
+
+
+std::size_t
+RenderAlgorithm::selectLevelOfDetail(const std::size_t& last, const RenderAlgorithm::Parameters& parameters) const
+{
+   const auto& model3D = parameters.model3D;
+   const auto& levels = model3D.getLevelsOfDetail();
+   if (levels.size() < 2)
+      return 0;
+
+   const auto current = std::min(last, levels.size() - 1);
+
+   // Calculate the factor that converts an object-space error into pixels. For
+   // perspective projections, the error shrinks with the distance between the viewer
+   // and the nearest point of the model's bounding sphere.
+   const auto& framebuffer = clockwork::system::Services::Graphics.getFramebuffer();
+   const auto& sphere = BoundingSphere::transform(model3D.getBoundingSphere(), parameters.MODEL);
+   const auto& PROJECTION = parameters.PROJECTION;
+
+   auto pixelsPerUnit =
+   0.5 * parameters.viewport.height * framebuffer.getHeight() * std::abs(PROJECTION.get(1, 1)) *
+   getMaximumScale(parameters.MODEL);
+
+   const auto& isPerspective = PROJECTION.get(3, 2) != 0.0 && PROJECTION.get(3, 3) == 0.0;
+   if (isPerspective)
    {
-      const auto& indices = face.getIndices();
-      const auto& normals = face.getNormals();
-      const auto& uvmaps  = face.getTextureMappingCoordinates();
+      const auto& distance = (sphere.center - parameters.viewpoint).getMagnitude() - sphere.radius;
+      if (distance <= 0.0)
+         return 0;
+      pixelsPerUnit /= distance;
+   }
 
-      for (unsigned int i = 0; i < 3; ++i)
-      {
-         const auto& index = indices[i];
-         const auto& position = positions[index];
-         const auto& normal = normals[i];
-         const auto& uvmap = uvmaps[i];
+   // Find the coarsest level whose projected error is below the threshold.
+   std::size_t candidate = 0;
+   while (candidate + 1 < levels.size() && levels[candidate + 1].error * pixelsPerUnit <= LEVEL_OF_DETAIL_THRESHOLD)
+      ++candidate;
 
-         vertices.push_back(vertexProgram(parameters, position, normal, uvmap));
-      }
+   // Only switch to a coarser level if its error is well below the threshold, and only
+   // switch to a finer level if the current level's error is well above it.
+   auto selected = current;
+   if (candidate > current)
+   {
+      while (candidate > current && levels[candidate].error * pixelsPerUnit > LEVEL_OF_DETAIL_THRESHOLD * (1.0 - LEVEL_OF_DETAIL_HYSTERESIS))
+         --candidate;
+      selected = candidate;
    }
+   else if (candidate < current && levels[current].error * pixelsPerUnit > LEVEL_OF_DETAIL_THRESHOLD * (1.0 + LEVEL_OF_DETAIL_HYSTERESIS))
+      selected = candidate;
+
+   return selected;
+}
+
+
+bool
+RenderAlgorithm::prepare(const RenderAlgorithm::Parameters& parameters, VertexArray& vertices, PipelineStatistics& statistics) const
+{
+   CLOCKWORK_PROFILE(Setup);
+
+   // The number of primitives that a stage removed, which is calculated from the number
+   // of vertices that remain after it.
+   const auto& k = getPrimitiveVertexCount();
+   auto count = vertices.size() / k;
+   const auto& removed = [&vertices, &k, &count]()
+   {
+      const auto before = count;
+      count = vertices.size() / k;
+      return before - count;
+   };
 
    // Create primitives and apply the geometry program to possibly generate more. Once
    // the geometry program completes, remove any hidden surfaces and continue down the
    // pipeline.
    if (!geometryProgram(parameters, primitiveAssembly(parameters.primitiveMode, vertices)).empty())
    {
-      // Remove hidden surfaces.
-      occlusionCulling(backfaceCulling(vertices));
+      count = vertices.size() / k;
+      statistics.primitivesAssembled += count;
+
+      // Remove hidden surfaces. Primitives that are trivially outside of the view frustum
+      // are removed before the (more expensive) occlusion test.
+      backfaceCulling(vertices);
+      statistics.backfaceCulled += removed();
+      frustumCulling(vertices);
+      statistics.frustumCulled += removed();
+      occlusionCulling(vertices);
+      statistics.occlusionCulled += removed();
 
       // Clip (remove) vertices that are not visible on the screen.
       clip(vertices);
+      statistics.primitivesClipped += removed();
 
       // Perform perspective-divide on the visible vertices. This will convert vertex
       // positions from clipping coordinate space to normalised device coordinate space.
@@ -155,8 +413,9 @@ RenderAlgorithm::apply(clockwork::scene::Object& object, clockwork::scene::Viewe
          vertex.y = std::round((vph * vertex.y) + (viewport.y + vph));
          vertex.z = ((viewport.far - viewport.near) * vertex.z * 0.5f) + (viewport.far + viewport.near) * 0.5;
       }
-      rasterise(parameters, vertices);
+      return !vertices.empty();
    }
+   return false;
 }
 
 
@@ -166,6 +425,7 @@ RenderAlgorithm::vertexProgram
    const RenderAlgorithm::Parameters& parameters,
    const clockwork::Point3& position,
    const clockwork::Vector3&,
+   const Tangent&,
    const Texture::Coordinates& uvmap
 ) const
 {
@@ -184,6 +444,41 @@ RenderAlgorithm::backfaceCulling(VertexArray& vertices) const
 }
 
 
+clockwork::graphics::VertexArray&
+RenderAlgorithm::frustumCulling(VertexArray& vertices) const
+{
+   // A vertex's outcode has a bit set for each clipping plane that the vertex is outside
+   // of. A primitive is outside the frustum if its vertices share at least one such bit.
+   const auto& outcode = [](const Vertex& v)
+   {
+      return
+      (v.x < -v.w ? 0x01 : 0) | (v.x > v.w ? 0x02 : 0) |
+      (v.y < -v.w ? 0x04 : 0) | (v.y > v.w ? 0x08 : 0) |
+      (v.z < -v.w ? 0x10 : 0) | (v.z > v.w ? 0x20 : 0);
+   };
+
+   // Compact the primitives that may be visible to the front of the array, then remove the rest.
+   const auto& k = getPrimitiveVertexCount();
+   std::size_t visibleCount = 0;
+   for (std::size_t i = 0; i + k <= vertices.size(); i += k)
+   {
+      auto code = 0x3f;
+      for (std::size_t j = 0; j < k; ++j)
+         code &= outcode(vertices[i + j]);
+
+      if (code == 0)
+      {
+         if (visibleCount != i)
+            std::copy(vertices.begin() + i, vertices.begin() + i + k, vertices.begin() + visibleCount);
+         visibleCount += k;
+      }
+   }
+   vertices.erase(vertices.begin() + visibleCount, vertices.end());
+
+   return vertices;
+}
+
+
 clockwork::graphics::VertexArray&
 RenderAlgorithm::occlusionCulling(VertexArray& vertices) const
 {
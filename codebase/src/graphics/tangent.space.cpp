@@ -0,0 +1,261 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "tangent.space.hh"
+#include "services.hh"
+#include <cmath>
+
+
+namespace {
+/**
+ * The number of triangles processed by a single parallel work item.
+ */
+constexpr std::size_t TRIANGLE_GRAIN = 1024;
+/**
+ * Return the dot product of two vectors.
+ */
+inline double
+dot(const clockwork::Vector3& a, const clockwork::Vector3& b)
+{
+   return (a.i * b.i) + (a.j * b.j) + (a.k * b.k);
+}
+/**
+ * Add a weighted vector to a sum.
+ */
+inline void
+accumulate(clockwork::Vector3& sum, const clockwork::Vector3& v, const double& weight = 1.0)
+{
+   sum.i += weight * v.i;
+   sum.j += weight * v.j;
+   sum.k += weight * v.k;
+}
+/**
+ * Return an arbitrary unit vector that is perpendicular to a given unit vector.
+ */
+clockwork::Vector3
+perpendicular(const clockwork::Vector3& n)
+{
+   // Cross the vector with the axis it is least aligned with.
+   const auto& ai = std::abs(n.i);
+   const auto& aj = std::abs(n.j);
+   const auto& ak = std::abs(n.k);
+   const clockwork::Vector3 axis
+   (
+      ai <= aj && ai <= ak ? 1.0 : 0.0,
+      aj < ai && aj <= ak ? 1.0 : 0.0,
+      ak < ai && ak < aj ? 1.0 : 0.0
+   );
+   return clockwork::Vector3::normalise(clockwork::Vector3::cross(n, axis));
+}
+/**
+ * The triangle corners that reference each vertex, stored in compressed form: the
+ * corners that reference vertex V are in corners[offsets[V]] to corners[offsets[V + 1] - 1],
+ * where each corner is encoded as (3 * triangle + corner).
+ */
+struct VertexAdjacency
+{
+   VertexAdjacency(const std::size_t& vertexCount, const std::vector<clockwork::graphics::TriangleIndices>& triangles) :
+   offsets(vertexCount + 1, 0),
+   corners(3 * triangles.size())
+   {
+      for (const auto& triangle : triangles)
+      {
+         for (const auto& index : triangle)
+            ++offsets[index + 1];
+      }
+      for (std::size_t v = 0; v < vertexCount; ++v)
+         offsets[v + 1] += offsets[v];
+
+      auto cursors = offsets;
+      for (std::size_t t = 0; t < triangles.size(); ++t)
+      {
+         for (uint32_t c = 0; c < 3; ++c)
+            corners[cursors[triangles[t][c]]++] = 3 * t + c;
+      }
+   }
+   std::vector<uint32_t> offsets;
+   std::vector<uint32_t> corners;
+};
+/**
+ * Return each triangle's face normal, scaled by twice the triangle's area.
+ */
+std::vector<clockwork::Vector3>
+computeFaceNormals
+(
+   const std::vector<clockwork::Point3>& positions,
+   const std::vector<clockwork::graphics::TriangleIndices>& triangles
+)
+{
+   std::vector<clockwork::Vector3> output(triangles.size());
+   clockwork::system::Services::Concurrency.parallelFor(triangles.size(), TRIANGLE_GRAIN,
+   [&](const std::size_t& begin, const std::size_t& end)
+   {
+      for (auto t = begin; t < end; ++t)
+      {
+         const auto& p0 = positions[triangles[t][0]];
+         const auto& p1 = positions[triangles[t][1]];
+         const auto& p2 = positions[triangles[t][2]];
+
+         output[t] = clockwork::Vector3::cross(p1 - p0, p2 - p0);
+      }
+   });
+   return output;
+}
+} // namespace
+
+
+void
+clockwork::graphics::computeVertexNormals
+(
+   const std::vector<clockwork::Point3>& positions,
+   const std::vector<TriangleIndices>& triangles,
+   std::vector<std::array<clockwork::Vector3, 3>>& normals,
+   const double& creaseAngle
+)
+{
+   const auto& faceNormals = computeFaceNormals(positions, triangles);
+   std::vector<clockwork::Vector3> unitFaceNormals(faceNormals.size());
+   for (std::size_t t = 0; t < faceNormals.size(); ++t)
+      unitFaceNormals[t] = clockwork::Vector3::normalise(faceNormals[t]);
+
+   const VertexAdjacency adjacency(positions.size(), triangles);
+   const auto& cosCreaseAngle = std::cos(creaseAngle);
+
+   normals.resize(triangles.size());
+   clockwork::system::Services::Concurrency.parallelFor(triangles.size(), TRIANGLE_GRAIN,
+   [&](const std::size_t& begin, const std::size_t& end)
+   {
+      for (auto t = begin; t < end; ++t)
+      {
+         const auto& faceNormal = unitFaceNormals[t];
+         for (uint32_t c = 0; c < 3; ++c)
+         {
+            // Average the normals of the faces that share the corner's vertex and are
+            // within the crease angle. Larger faces contribute more to the average.
+            const auto& v = triangles[t][c];
+            clockwork::Vector3 sum;
+            for (auto a = adjacency.offsets[v]; a < adjacency.offsets[v + 1]; ++a)
+            {
+               const auto& other = adjacency.corners[a] / 3;
+               if (other == t || dot(faceNormal, unitFaceNormals[other]) >= cosCreaseAngle)
+                  accumulate(sum, faceNormals[other]);
+            }
+            normals[t][c] = sum.getMagnitude() > 0.0 ? clockwork::Vector3::normalise(sum) : faceNormal;
+         }
+      }
+   });
+}
+
+
+void
+clockwork::graphics::computeVertexTangents
+(
+   const std::vector<clockwork::Point3>& positions,
+   const std::vector<TriangleIndices>& triangles,
+   const std::vector<std::array<clockwork::Vector3, 3>>& normals,
+   const std::vector<std::array<Texture::Coordinates, 3>>& texcoords,
+   std::vector<std::array<Tangent, 3>>& tangents
+)
+{
+   // Calculate each face's tangent from its edges and texture mapping coordinates, as
+   // well as the handedness of its tangent space. Faces with degenerate mapping
+   // coordinates do not contribute to their vertices' tangents.
+   const auto& faceNormals = computeFaceNormals(positions, triangles);
+   std::vector<clockwork::Vector3> faceTangents(triangles.size());
+   std::vector<double> faceHandedness(triangles.size(), 1.0);
+   clockwork::system::Services::Concurrency.parallelFor(triangles.size(), TRIANGLE_GRAIN,
+   [&](const std::size_t& begin, const std::size_t& end)
+   {
+      for (auto t = begin; t < end; ++t)
+      {
+         const auto& e1 = positions[triangles[t][1]] - positions[triangles[t][0]];
+         const auto& e2 = positions[triangles[t][2]] - positions[triangles[t][0]];
+         const auto& du1 = texcoords[t][1].u - texcoords[t][0].u;
+         const auto& dv1 = texcoords[t][1].v - texcoords[t][0].v;
+         const auto& du2 = texcoords[t][2].u - texcoords[t][0].u;
+         const auto& dv2 = texcoords[t][2].v - texcoords[t][0].v;
+
+         const auto& determinant = (du1 * dv2) - (du2 * dv1);
+         if (std::abs(determinant) > 1e-12)
+         {
+            const auto& r = 1.0 / determinant;
+            const clockwork::Vector3 T
+            (
+               ((e1.i * dv2) - (e2.i * dv1)) * r,
+               ((e1.j * dv2) - (e2.j * dv1)) * r,
+               ((e1.k * dv2) - (e2.k * dv1)) * r
+            );
+            const clockwork::Vector3 B
+            (
+               ((e2.i * du1) - (e1.i * du2)) * r,
+               ((e2.j * du1) - (e1.j * du2)) * r,
+               ((e2.k * du1) - (e1.k * du2)) * r
+            );
+            // Weight the unit tangent by the face's area.
+            accumulate(faceTangents[t], clockwork::Vector3::normalise(T), faceNormals[t].getMagnitude());
+            faceHandedness[t] = dot(clockwork::Vector3::cross(faceNormals[t], T), B) < 0.0 ? -1.0 : 1.0;
+         }
+      }
+   });
+
+   const VertexAdjacency adjacency(positions.size(), triangles);
+
+   tangents.resize(triangles.size());
+   clockwork::system::Services::Concurrency.parallelFor(triangles.size(), TRIANGLE_GRAIN,
+   [&](const std::size_t& begin, const std::size_t& end)
+   {
+      for (auto t = begin; t < end; ++t)
+      {
+         const auto& handedness = faceHandedness[t];
+         for (uint32_t c = 0; c < 3; ++c)
+         {
+            const auto& N = normals[t][c];
+            const auto& uv = texcoords[t][c];
+
+            // Only corners that share the same vertex, normal, mapping coordinates and
+            // handedness are smoothed together, so seams in the texture mapping or
+            // mirrored mappings keep their own tangents.
+            const auto& v = triangles[t][c];
+            clockwork::Vector3 sum;
+            for (auto a = adjacency.offsets[v]; a < adjacency.offsets[v + 1]; ++a)
+            {
+               const auto& other = adjacency.corners[a] / 3;
+               const auto& corner = adjacency.corners[a] % 3;
+               const auto& otherUV = texcoords[other][corner];
+               if
+               (
+                  faceHandedness[other] == handedness &&
+                  otherUV.u == uv.u && otherUV.v == uv.v &&
+                  dot(N, normals[other][corner]) > 0.9999
+               )
+                  accumulate(sum, faceTangents[other]);
+            }
+
+            // Gram-Schmidt orthogonalise the tangent against the normal.
+            accumulate(sum, N, -dot(N, sum));
+            const auto& direction = sum.getMagnitude() > 1e-12 ? clockwork::Vector3::normalise(sum) : perpendicular(N);
+            tangents[t][c] = Tangent(direction, handedness);
+         }
+      }
+   });
+}
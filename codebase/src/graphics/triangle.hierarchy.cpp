@@ -0,0 +1,501 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "triangle.hierarchy.hh"
+#include "model3d.hh"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cassert>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using clockwork::graphics::TriangleHierarchy;
+
+
+constexpr unsigned int TriangleHierarchy::LEAF_SIZE;
+constexpr unsigned int TriangleHierarchy::SAH_BIN_COUNT;
+constexpr unsigned int TriangleHierarchy::SAH_MAXIMUM_DEPTH;
+constexpr unsigned int TriangleHierarchy::STACK_SIZE;
+
+
+namespace {
+/**
+ * A ray in single precision. Each vector is padded to four components, and the fourth
+ * components are chosen so that they never restrict a ray-box intersection interval.
+ */
+struct RayData
+{
+   std::array<float, 4> origin;
+   std::array<float, 4> direction;
+   std::array<float, 4> inverseDirection;
+};
+/**
+ * Return the distance at which a ray enters a box, if it intersects the box between
+ * zero and the given maximum distance.
+ */
+template<class Node> bool
+intersectBox(const RayData& ray, const Node& node, const float& maximumDistance, float& distance)
+{
+#if defined(__SSE2__)
+   const auto& origin = _mm_loadu_ps(ray.origin.data());
+   const auto& inverseDirection = _mm_loadu_ps(ray.inverseDirection.data());
+   const auto& t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.minimum.data()), origin), inverseDirection);
+   const auto& t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.maximum.data()), origin), inverseDirection);
+
+   // Reduce the slab intervals to the largest entry and smallest exit distances.
+   auto tmin = _mm_min_ps(t0, t1);
+   auto tmax = _mm_max_ps(t0, t1);
+   tmin = _mm_max_ps(tmin, _mm_shuffle_ps(tmin, tmin, _MM_SHUFFLE(1, 0, 3, 2)));
+   tmin = _mm_max_ps(tmin, _mm_shuffle_ps(tmin, tmin, _MM_SHUFFLE(2, 3, 0, 1)));
+   tmax = _mm_min_ps(tmax, _mm_shuffle_ps(tmax, tmax, _MM_SHUFFLE(1, 0, 3, 2)));
+   tmax = _mm_min_ps(tmax, _mm_shuffle_ps(tmax, tmax, _MM_SHUFFLE(2, 3, 0, 1)));
+
+   const auto entry = std::max(_mm_cvtss_f32(tmin), 0.0f);
+   const auto exit = std::min(_mm_cvtss_f32(tmax), maximumDistance);
+#else
+   auto entry = 0.0f;
+   auto exit = maximumDistance;
+   for (unsigned int axis = 0; axis < 3; ++axis)
+   {
+      const auto& t0 = (node.minimum[axis] - ray.origin[axis]) * ray.inverseDirection[axis];
+      const auto& t1 = (node.maximum[axis] - ray.origin[axis]) * ray.inverseDirection[axis];
+      entry = std::max(entry, std::min(t0, t1));
+      exit = std::min(exit, std::max(t0, t1));
+   }
+#endif
+   distance = entry;
+   return entry <= exit;
+}
+/**
+ * Intersect a ray with the four triangles of a packet using the Moller-Trumbore algorithm,
+ * and return the lane of the closest triangle that is intersected before the given distance,
+ * or -1 if no triangle is intersected.
+ */
+template<class Packet> int
+intersectPacket(const RayData& ray, const Packet& packet, const float& maximumDistance, float& t, float& u, float& v)
+{
+   constexpr float EPSILON = 1e-12f;
+   std::array<float, 4> distances;
+   std::array<float, 4> us;
+   std::array<float, 4> vs;
+   int mask = 0;
+#if defined(__SSE2__)
+   const auto& ox = _mm_set1_ps(ray.origin[0]);
+   const auto& oy = _mm_set1_ps(ray.origin[1]);
+   const auto& oz = _mm_set1_ps(ray.origin[2]);
+   const auto& dx = _mm_set1_ps(ray.direction[0]);
+   const auto& dy = _mm_set1_ps(ray.direction[1]);
+   const auto& dz = _mm_set1_ps(ray.direction[2]);
+   const auto& e1x = _mm_loadu_ps(packet.edge1[0].data());
+   const auto& e1y = _mm_loadu_ps(packet.edge1[1].data());
+   const auto& e1z = _mm_loadu_ps(packet.edge1[2].data());
+   const auto& e2x = _mm_loadu_ps(packet.edge2[0].data());
+   const auto& e2y = _mm_loadu_ps(packet.edge2[1].data());
+   const auto& e2z = _mm_loadu_ps(packet.edge2[2].data());
+
+   // P = D x E2, det = E1 . P
+   const auto& px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+   const auto& py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+   const auto& pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+   const auto& det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+   const auto& inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+   // T = O - V0, u = (T . P) / det
+   const auto& tx = _mm_sub_ps(ox, _mm_loadu_ps(packet.vertex[0].data()));
+   const auto& ty = _mm_sub_ps(oy, _mm_loadu_ps(packet.vertex[1].data()));
+   const auto& tz = _mm_sub_ps(oz, _mm_loadu_ps(packet.vertex[2].data()));
+   const auto& U = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inverseDet);
+
+   // Q = T x E1, v = (D . Q) / det, t = (E2 . Q) / det
+   const auto& qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+   const auto& qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+   const auto& qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+   const auto& V = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+   const auto& T = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+   const auto& zero = _mm_setzero_ps();
+   const auto& absoluteDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+   auto isHit = _mm_cmpgt_ps(absoluteDet, _mm_set1_ps(EPSILON));
+   isHit = _mm_and_ps(isHit, _mm_cmpge_ps(U, zero));
+   isHit = _mm_and_ps(isHit, _mm_cmpge_ps(V, zero));
+   isHit = _mm_and_ps(isHit, _mm_cmple_ps(_mm_add_ps(U, V), _mm_set1_ps(1.0f)));
+   isHit = _mm_and_ps(isHit, _mm_cmpge_ps(T, zero));
+   isHit = _mm_and_ps(isHit, _mm_cmplt_ps(T, _mm_set1_ps(maximumDistance)));
+
+   mask = _mm_movemask_ps(isHit);
+   if (mask == 0)
+      return -1;
+
+   _mm_storeu_ps(distances.data(), T);
+   _mm_storeu_ps(us.data(), U);
+   _mm_storeu_ps(vs.data(), V);
+#else
+   for (unsigned int lane = 0; lane < 4; ++lane)
+   {
+      const auto& e1x = packet.edge1[0][lane];
+      const auto& e1y = packet.edge1[1][lane];
+      const auto& e1z = packet.edge1[2][lane];
+      const auto& e2x = packet.edge2[0][lane];
+      const auto& e2y = packet.edge2[1][lane];
+      const auto& e2z = packet.edge2[2][lane];
+      const auto& dx = ray.direction[0];
+      const auto& dy = ray.direction[1];
+      const auto& dz = ray.direction[2];
+
+      const auto& px = (dy * e2z) - (dz * e2y);
+      const auto& py = (dz * e2x) - (dx * e2z);
+      const auto& pz = (dx * e2y) - (dy * e2x);
+      const auto& det = (e1x * px) + (e1y * py) + (e1z * pz);
+      if (std::abs(det) <= EPSILON)
+         continue;
+
+      const auto& inverseDet = 1.0f / det;
+      const auto& tx = ray.origin[0] - packet.vertex[0][lane];
+      const auto& ty = ray.origin[1] - packet.vertex[1][lane];
+      const auto& tz = ray.origin[2] - packet.vertex[2][lane];
+      us[lane] = ((tx * px) + (ty * py) + (tz * pz)) * inverseDet;
+
+      const auto& qx = (ty * e1z) - (tz * e1y);
+      const auto& qy = (tz * e1x) - (tx * e1z);
+      const auto& qz = (tx * e1y) - (ty * e1x);
+      vs[lane] = ((dx * qx) + (dy * qy) + (dz * qz)) * inverseDet;
+      distances[lane] = ((e2x * qx) + (e2y * qy) + (e2z * qz)) * inverseDet;
+
+      if (us[lane] >= 0.0f && vs[lane] >= 0.0f && us[lane] + vs[lane] <= 1.0f &&
+          distances[lane] >= 0.0f && distances[lane] < maximumDistance)
+         mask |= 1 << lane;
+   }
+   if (mask == 0)
+      return -1;
+#endif
+   int output = -1;
+   for (int lane = 0; lane < 4; ++lane)
+   {
+      if ((mask & (1 << lane)) && (output < 0 || distances[lane] < t))
+      {
+         output = lane;
+         t = distances[lane];
+         u = us[lane];
+         v = vs[lane];
+      }
+   }
+   return output;
+}
+} // namespace
+
+
+TriangleHierarchy::TriangleHierarchy(const Model3D& model3D)
+{
+   const auto& positions = model3D.getPositions();
+   const auto& indices = model3D.getIndices();
+   const auto& triangleCount = indices.size() / 3;
+   if (triangleCount == 0)
+      return;
+
+   std::vector<BuildEntry> entries(triangleCount);
+   for (std::size_t t = 0; t < triangleCount; ++t)
+   {
+      auto& entry = entries[t];
+      entry.triangle = static_cast<uint32_t>(t);
+      for (unsigned int k = 0; k < 3; ++k)
+         entry.vertices[k] = positions[indices.get((3 * t) + k)];
+
+      for (unsigned int axis = 0; axis < 3; ++axis)
+      {
+         entry.minimum[axis] = std::min({entry.vertices[0][axis], entry.vertices[1][axis], entry.vertices[2][axis]});
+         entry.maximum[axis] = std::max({entry.vertices[0][axis], entry.vertices[1][axis], entry.vertices[2][axis]});
+         entry.centroid[axis] = 0.5f * (entry.minimum[axis] + entry.maximum[axis]);
+      }
+   }
+
+   _nodes.reserve((2 * ((triangleCount + LEAF_SIZE - 1) / LEAF_SIZE)) + 1);
+   _nodes.emplace_back();
+   build(0, entries, 0, triangleCount, 0);
+}
+
+
+std::size_t
+TriangleHierarchy::getNodeCount() const
+{
+   return _nodes.size();
+}
+
+
+void
+TriangleHierarchy::build
+(
+   const uint32_t& node,
+   std::vector<BuildEntry>& entries,
+   const std::size_t& begin,
+   const std::size_t& end,
+   const unsigned int& depth
+)
+{
+   // Calculate the node's bounds. The fourth component is set so that it never restricts
+   // the interval of a ray-box intersection.
+   std::array<float, 4> minimum = {{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()}};
+   std::array<float, 4> maximum = {{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max()}};
+   std::array<float, 3> centroidMinimum = {{minimum[0], minimum[1], minimum[2]}};
+   std::array<float, 3> centroidMaximum = {{maximum[0], maximum[1], maximum[2]}};
+   for (auto i = begin; i < end; ++i)
+   {
+      const auto& entry = entries[i];
+      for (unsigned int axis = 0; axis < 3; ++axis)
+      {
+         minimum[axis] = std::min(minimum[axis], entry.minimum[axis]);
+         maximum[axis] = std::max(maximum[axis], entry.maximum[axis]);
+         centroidMinimum[axis] = std::min(centroidMinimum[axis], entry.centroid[axis]);
+         centroidMaximum[axis] = std::max(centroidMaximum[axis], entry.centroid[axis]);
+      }
+   }
+   _nodes[node].minimum = minimum;
+   _nodes[node].maximum = maximum;
+
+   const auto& count = end - begin;
+   if (count <= LEAF_SIZE)
+   {
+      createLeaf(node, entries, begin, end);
+      return;
+   }
+
+   unsigned int axis = 0;
+   for (unsigned int a = 1; a < 3; ++a)
+   {
+      if (centroidMaximum[a] - centroidMinimum[a] > centroidMaximum[axis] - centroidMinimum[axis])
+         axis = a;
+   }
+   const auto& extent = centroidMaximum[axis] - centroidMinimum[axis];
+
+   auto split = begin;
+   if (extent > 0.0f && depth < SAH_MAXIMUM_DEPTH)
+   {
+      // Distribute the triangles into bins along the axis, then choose the split between
+      // two bins that minimises the surface area heuristic.
+      const auto& offset = centroidMinimum[axis];
+      const auto& getBin = [&](const BuildEntry& entry)
+      {
+         const auto& t = (entry.centroid[axis] - offset) / extent;
+         return std::min(static_cast<unsigned int>(t * SAH_BIN_COUNT), SAH_BIN_COUNT - 1);
+      };
+      const auto& getArea = [](const std::array<float, 3>& lower, const std::array<float, 3>& upper)
+      {
+         if (lower[0] > upper[0])
+            return 0.0f;
+
+         const auto& dx = upper[0] - lower[0];
+         const auto& dy = upper[1] - lower[1];
+         const auto& dz = upper[2] - lower[2];
+         return (dx * dy) + (dy * dz) + (dz * dx);
+      };
+      const auto& extend = [](std::array<float, 3>& lower, std::array<float, 3>& upper, const std::array<float, 3>& otherLower, const std::array<float, 3>& otherUpper)
+      {
+         for (unsigned int a = 0; a < 3; ++a)
+         {
+            lower[a] = std::min(lower[a], otherLower[a]);
+            upper[a] = std::max(upper[a], otherUpper[a]);
+         }
+      };
+      const auto& infinity = std::numeric_limits<float>::max();
+      std::array<std::array<float, 3>, SAH_BIN_COUNT> binMinimum;
+      std::array<std::array<float, 3>, SAH_BIN_COUNT> binMaximum;
+      std::array<std::size_t, SAH_BIN_COUNT> binCounts = {};
+      binMinimum.fill({{infinity, infinity, infinity}});
+      binMaximum.fill({{-infinity, -infinity, -infinity}});
+      for (auto i = begin; i < end; ++i)
+      {
+         const auto& bin = getBin(entries[i]);
+         extend(binMinimum[bin], binMaximum[bin], entries[i].minimum, entries[i].maximum);
+         ++binCounts[bin];
+      }
+
+      std::array<float, SAH_BIN_COUNT> rightCosts = {};
+      std::array<float, 3> lower = {{infinity, infinity, infinity}};
+      std::array<float, 3> upper = {{-infinity, -infinity, -infinity}};
+      std::size_t rightCount = 0;
+      for (auto bin = SAH_BIN_COUNT - 1; bin > 0; --bin)
+      {
+         extend(lower, upper, binMinimum[bin], binMaximum[bin]);
+         rightCount += binCounts[bin];
+         rightCosts[bin - 1] = rightCount * getArea(lower, upper);
+      }
+
+      lower = {{infinity, infinity, infinity}};
+      upper = {{-infinity, -infinity, -infinity}};
+      std::size_t leftCount = 0;
+      auto bestCost = std::numeric_limits<float>::max();
+      unsigned int bestBin = 0;
+      for (unsigned int bin = 0; bin + 1 < SAH_BIN_COUNT; ++bin)
+      {
+         extend(lower, upper, binMinimum[bin], binMaximum[bin]);
+         leftCount += binCounts[bin];
+
+         const auto& cost = (leftCount * getArea(lower, upper)) + rightCosts[bin];
+         if (leftCount > 0 && leftCount < count && cost < bestCost)
+         {
+            bestCost = cost;
+            bestBin = bin;
+         }
+      }
+
+      const auto& middle = std::partition
+      (
+         entries.begin() + begin, entries.begin() + end,
+         [&](const BuildEntry& entry) { return getBin(entry) <= bestBin; }
+      );
+      split = static_cast<std::size_t>(middle - entries.begin());
+   }
+
+   // Split at the median if the surface area heuristic was not used or failed to split the triangles.
+   if (split == begin || split == end)
+   {
+      split = begin + (count / 2);
+      std::nth_element
+      (
+         entries.begin() + begin, entries.begin() + split, entries.begin() + end,
+         [&axis](const BuildEntry& a, const BuildEntry& b) { return a.centroid[axis] < b.centroid[axis]; }
+      );
+   }
+
+   // The children are stored next to each other.
+   const auto left = static_cast<uint32_t>(_nodes.size());
+   _nodes.emplace_back();
+   _nodes.emplace_back();
+   _nodes[node].index = left;
+   _nodes[node].count = 0;
+
+   build(left, entries, begin, split, depth + 1);
+   build(left + 1, entries, split, end, depth + 1);
+}
+
+
+void
+TriangleHierarchy::createLeaf
+(
+   const uint32_t& node,
+   const std::vector<BuildEntry>& entries,
+   const std::size_t& begin,
+   const std::size_t& end
+)
+{
+   TrianglePacket packet = {};
+   for (auto i = begin; i < end; ++i)
+   {
+      const auto& lane = i - begin;
+      const auto& entry = entries[i];
+      const auto& v0 = entry.vertices[0];
+      const auto& v1 = entry.vertices[1];
+      const auto& v2 = entry.vertices[2];
+      for (unsigned int axis = 0; axis < 3; ++axis)
+      {
+         packet.vertex[axis][lane] = v0[axis];
+         packet.edge1[axis][lane] = v1[axis] - v0[axis];
+         packet.edge2[axis][lane] = v2[axis] - v0[axis];
+      }
+      packet.triangles[lane] = entry.triangle;
+   }
+
+   _nodes[node].index = static_cast<uint32_t>(_packets.size());
+   _nodes[node].count = static_cast<uint32_t>(end - begin);
+   _packets.push_back(packet);
+}
+
+
+bool
+TriangleHierarchy::intersect(const Ray& ray, const double& maximumDistance, Hit& hit) const
+{
+   if (_nodes.empty())
+      return false;
+
+   const RayData data =
+   {
+      {{static_cast<float>(ray.origin.x), static_cast<float>(ray.origin.y), static_cast<float>(ray.origin.z), 0.0f}},
+      {{static_cast<float>(ray.direction.i), static_cast<float>(ray.direction.j), static_cast<float>(ray.direction.k), 0.0f}},
+      {{static_cast<float>(ray.inverseDirection.i), static_cast<float>(ray.inverseDirection.j), static_cast<float>(ray.inverseDirection.k), 1.0f}}
+   };
+
+   auto closest = static_cast<float>(std::min<double>(maximumDistance, std::numeric_limits<float>::max()));
+   auto distance = 0.0f;
+   if (!intersectBox(data, _nodes[0], closest, distance))
+      return false;
+
+   // Traverse the hierarchy front to back. Each stack entry records the distance at which
+   // the ray enters its node, so that nodes behind the closest hit so far can be skipped.
+   std::array<uint32_t, STACK_SIZE> stack;
+   std::array<float, STACK_SIZE> distances;
+   unsigned int top = 0;
+   stack[top] = 0;
+   distances[top++] = distance;
+
+   auto isHit = false;
+   while (top > 0)
+   {
+      --top;
+      if (distances[top] > closest)
+         continue;
+
+      const auto& node = _nodes[stack[top]];
+      if (node.isLeaf())
+      {
+         const auto& packet = _packets[node.index];
+         float t, u, v;
+         const auto& lane = intersectPacket(data, packet, closest, t, u, v);
+         if (lane >= 0)
+         {
+            closest = t;
+            hit.triangle = packet.triangles[lane];
+            hit.u = u;
+            hit.v = v;
+            hit.distance = t;
+            isHit = true;
+         }
+         continue;
+      }
+
+      float leftDistance, rightDistance;
+      const auto& isLeftHit = intersectBox(data, _nodes[node.index], closest, leftDistance);
+      const auto& isRightHit = intersectBox(data, _nodes[node.index + 1], closest, rightDistance);
+      assert(top + 2 <= STACK_SIZE);
+
+      if (isLeftHit && isRightHit)
+      {
+         const auto& isLeftNearer = leftDistance <= rightDistance;
+         stack[top] = isLeftNearer ? node.index + 1 : node.index;
+         distances[top++] = isLeftNearer ? rightDistance : leftDistance;
+         stack[top] = isLeftNearer ? node.index : node.index + 1;
+         distances[top++] = isLeftNearer ? leftDistance : rightDistance;
+      }
+      else if (isLeftHit)
+      {
+         stack[top] = node.index;
+         distances[top++] = leftDistance;
+      }
+      else if (isRightHit)
+      {
+         stack[top] = node.index + 1;
+         distances[top++] = rightDistance;
+      }
+   }
+   return isHit;
+}
@@ -23,9 +23,16 @@
  */
 #include "vertex.hh"
 
+using clockwork::graphics::Tangent;
 using clockwork::graphics::Vertex;
 
 
+Tangent::Tangent(const clockwork::Vector3& d, const double& h) :
+direction(d),
+handedness(h)
+{}
+
+
 Vertex::Vertex(const double& x, const double& y, const double& z, const double& w) :
 Point4(x, y, z, w),
 color(1.0, 1.0, 1.0)
@@ -51,6 +58,11 @@ Vertex::interpolate(const Vertex& start, const Vertex& end, const double& p)
    output.normal.j = (pp * start.normal.j) + (p * end.normal.j);
    output.normal.k = (pp * start.normal.k) + (p * end.normal.k);
 
+   output.tangent.direction.i = (pp * start.tangent.direction.i) + (p * end.tangent.direction.i);
+   output.tangent.direction.j = (pp * start.tangent.direction.j) + (p * end.tangent.direction.j);
+   output.tangent.direction.k = (pp * start.tangent.direction.k) + (p * end.tangent.direction.k);
+   output.tangent.handedness = p < 0.5 ? start.tangent.handedness : end.tangent.handedness;
+
    output.color.red   = (pp * start.color.red)   + (p * end.color.red);
    output.color.green = (pp * start.color.green) + (p * end.color.green);
    output.color.blue  = (pp * start.color.blue)  + (p * end.color.blue);
@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "file.reader.hh"
+#include <QTextStream>
+#include <QStringList>
+
+
+clockwork::Error
+clockwork::io::loadMTL(QFile& file, clockwork::graphics::MaterialLibrary& library)
+{
+   // If the file was opened in this method, then it should be closed by it.
+   bool closeFileOnFinish = false;
+   if (!file.isOpen())
+   {
+      closeFileOnFinish = file.open(QIODevice::ReadOnly);
+      if (!closeFileOnFinish)
+         return clockwork::Error::FileNotAccessible;
+   }
+
+   // The name and data of the material section that is currently being processed.
+   // A section is only added to the library once the next one begins, or when the
+   // end of the file is reached.
+   QString materialName;
+   clockwork::graphics::Material material;
+
+   QTextStream stream(&file);
+   stream.skipWhiteSpace();
+   while (!stream.atEnd())
+   {
+      // Read a line and remove any leading and trailing spaces.
+      const auto& line = stream.readLine().simplified();
+
+      // Skip comments and empty lines.
+      if (!line.isEmpty() && line[0] != '#')
+      {
+         auto tokens = line.split(" ");
+         if (!tokens.isEmpty())
+         {
+            const auto& command = tokens.takeFirst();
+
+            // We've reached a new material section so the previous one is complete.
+            if (command == "newmtl")
+            {
+               if (!materialName.isEmpty())
+                  library.addMaterial(materialName, material);
+
+               materialName = tokens.isEmpty() ? QString() : tokens.takeFirst();
+               material = clockwork::graphics::Material();
+            }
+            else if (!materialName.isEmpty())
+            {
+               if (!QString::compare(command, "Ka", Qt::CaseInsensitive) && tokens.size() >= 3)
+               {
+                  material.Ka.red = tokens.takeFirst().toDouble();
+                  material.Ka.green = tokens.takeFirst().toDouble();
+                  material.Ka.blue = tokens.takeFirst().toDouble();
+               }
+               else if (!QString::compare(command, "Kd", Qt::CaseInsensitive) && tokens.size() >= 3)
+               {
+                  material.Kd.red = tokens.takeFirst().toDouble();
+                  material.Kd.green = tokens.takeFirst().toDouble();
+                  material.Kd.blue = tokens.takeFirst().toDouble();
+               }
+               else if (!QString::compare(command, "Ks", Qt::CaseInsensitive) && tokens.size() >= 3)
+               {
+                  material.Ks.red = tokens.takeFirst().toDouble();
+                  material.Ks.green = tokens.takeFirst().toDouble();
+                  material.Ks.blue = tokens.takeFirst().toDouble();
+               }
+               else if (!QString::compare(command, "Tr", Qt::CaseInsensitive) && !tokens.isEmpty())
+                  material.transparency = tokens.takeFirst().toDouble();
+               else if (!QString::compare(command, "Ns", Qt::CaseInsensitive) && !tokens.isEmpty())
+                  material.shininess = tokens.takeFirst().toDouble();
+
+               // TODO Load textures.
+            }
+         }
+      }
+   }
+
+   // Store the last material section.
+   if (!materialName.isEmpty())
+      library.addMaterial(materialName, material);
+
+   if (closeFileOnFinish)
+      file.close();
+
+   return clockwork::Error::None;
+}
@@ -22,16 +22,12 @@
  * THE SOFTWARE.
  */
 #include "file.reader.hh"
+#include "services.hh"
+#include "tangent.space.hh"
 #include <QTextStream>
 #include <QStringList>
 #include <QFileInfo>
-
-
-/**
- * Load the material with the given name, from a given text stream and store it in a
- * Material object. If any errors occur, an appropriate error value is returned.
- */
-clockwork::Error loadMaterial(const QString& name, QTextStream& from, clockwork::graphics::Material& to);
+#include <QHash>
 
 
 clockwork::Error
@@ -47,10 +43,25 @@ clockwork::io::loadOBJ(QFile& file, clockwork::graphics::Model3D& model)
    }
 
    // Begin parsing the file.
-   auto& positions = const_cast<std::vector<clockwork::Point3>&>(model.getVertexPositions());
+   std::vector<clockwork::Point3> positions;
    std::vector<clockwork::Vector3> normals;
    std::vector<clockwork::graphics::Texture::Coordinates> texcoords;
-   QString materialFilename;
+   const clockwork::graphics::MaterialLibrary* materialLibrary = nullptr;
+
+   // Faces are grouped by material so that each material is used by exactly one
+   // contiguous submesh, regardless of how often 'usemtl' switches between them.
+   // Faces that precede the first 'usemtl' command use the default material.
+   using FaceGroup = std::pair<clockwork::graphics::Material, std::vector<std::size_t>>;
+   std::vector<FaceGroup> faceGroups(1);
+   QHash<const clockwork::graphics::Material*, std::size_t> faceGroupIndices;
+   std::size_t currentFaceGroup = 0;
+
+   // Triangle data, indexed by the triangle numbers stored in the face groups. Vertex
+   // normals that are not specified by the file are calculated once parsing completes.
+   std::vector<clockwork::graphics::TriangleIndices> triangles;
+   std::vector<std::array<clockwork::Vector3, 3>> triangleNormals;
+   std::vector<std::array<clockwork::graphics::Texture::Coordinates, 3>> triangleTexcoords;
+   std::vector<bool> hasNormals;
 
    QTextStream stream(&file);
    stream.skipWhiteSpace();
@@ -137,75 +148,64 @@ clockwork::io::loadOBJ(QFile& file, clockwork::graphics::Model3D& model)
                   }
                }
 
-               // Fill the normal and texture coordinate buffers with dummy data to match
-               // the size of the index buffer.
-               const auto* const dummyNormal = new clockwork::Vector3;
-               const auto* const dummyCoordinates = new clockwork::graphics::Texture::Coordinates;
-
+               // Create triangles from the vertices and mapping coordinates we obtained.
+               // If there're more than three vertices, triangulate. Missing mapping
+               // coordinates default to (0, 0) and missing normals are calculated later.
                const auto& N = faceIndices.size();
-               const auto& M = faceNormals.size();
-               if (N != M)
-               {
-                  for (unsigned int i = 0; i < std::abs(N - M); ++i)
-                     faceNormals.push_back(dummyNormal);
-               }
-               const auto& K = faceTexcoords.size();
-               if (N != K)
+               const auto& faceHasNormals = faceNormals.size() == N;
+               const auto& faceHasTexcoords = faceTexcoords.size() == N;
+               for (std::size_t i = 1; i + 1 < N; ++i)
                {
-                  for (unsigned int i = 0; i < std::abs(N - K); ++i)
-                     faceTexcoords.push_back(dummyCoordinates);
-               }
+                  const std::array<std::size_t, 3> corners = {{0, i, i + 1}};
 
-               // Create polygonal faces from the vertices and mapping coordinates we obtained.
-               // If there're more than three vertices, triangulate.
-               for (unsigned int i = 0; i < N - 2; ++i)
-               {
-                  // FIXME This will break if there're no normals or mapping coordinates.
-                  model.addFace
-                  (
-                     {
-                        faceIndices[0],
-                        faceIndices[i + 1],
-                        faceIndices[i + 2]
-                     },
-                     {
-                        *faceNormals[0],
-                        *faceNormals[i + 1],
-                        *faceNormals[i + 2]
-                     },
-                     {
-                        *faceTexcoords[0],
-                        *faceTexcoords[i + 1],
-                        *faceTexcoords[i + 2]
-                     }
-                  );
+                  faceGroups[currentFaceGroup].second.push_back(triangles.size());
+                  triangles.push_back({{faceIndices[0], faceIndices[i], faceIndices[i + 1]}});
+                  triangleNormals.push_back({});
+                  triangleTexcoords.push_back({});
+                  hasNormals.push_back(faceHasNormals);
+                  for (unsigned int c = 0; c < 3; ++c)
+                  {
+                     if (faceHasNormals)
+                        triangleNormals.back()[c] = *faceNormals[corners[c]];
+                     if (faceHasTexcoords)
+                        triangleTexcoords.back()[c] = *faceTexcoords[corners[c]];
+                  }
                }
             }
             else if (command == "mtllib")
             {
+               // The material library is parsed once and shared by every model that
+               // references it, so subsequent 'usemtl' commands are simple lookups.
                // TODO See QDir::separator() and QDir::toNativeSeparators.
-               materialFilename =
+               const auto& filename =
                QFileInfo(file).canonicalPath().append("/").append(tokens.takeFirst());
+
+               materialLibrary = clockwork::system::Services::Resource.loadMaterialLibrary(filename);
+               if (materialLibrary == nullptr)
+                  std::cout << "Warning! Could not load the material library '" << filename.toStdString() << "'." << std::endl;
             }
             else if (command == "usemtl")
             {
-               if (!materialFilename.isEmpty())
+               if (materialLibrary != nullptr && !tokens.isEmpty())
                {
-                  QFileInfo info(materialFilename);
-                  if (info.exists() && info.isFile() && info.isReadable() && info.size())
+                  const auto& materialName = tokens.takeFirst();
+                  const auto* const material = materialLibrary->getMaterial(materialName);
+                  if (material != nullptr)
                   {
-                     QFile materialFile(info.canonicalFilePath());
-                     if (materialFile.open(QIODevice::ReadOnly))
+                     // Subsequent faces are appended to the material's group, which is
+                     // created the first time the material is used.
+                     const auto& it = faceGroupIndices.constFind(material);
+                     if (it == faceGroupIndices.constEnd())
                      {
-                        const QString materialName(tokens.takeFirst());
-                        QTextStream materialFileStream(&materialFile);
-                        auto& material(const_cast<clockwork::graphics::Material&>(model.getMaterial()));
-
-                        auto error = loadMaterial(materialName, materialFileStream, material);
-                        if (error != clockwork::Error::None)
-                           std::cout << "Warning! Could not load the material data." << error << std::endl;
+                        currentFaceGroup = faceGroups.size();
+                        faceGroupIndices.insert(material, currentFaceGroup);
+                        faceGroups.push_back(FaceGroup(*material, std::vector<std::size_t>()));
                      }
+                     else
+                        currentFaceGroup = it.value();
                   }
+                  else
+                     std::cout << "Warning! Undefined material '" << materialName.toStdString() << "'." << std::endl;
                }
             }
             else
@@ -216,72 +216,79 @@ clockwork::io::loadOBJ(QFile& file, clockwork::graphics::Model3D& model)
       }
    }
 
-   if (closeFileOnFinish)
-      file.close();
-
-   return clockwork::Error::None;
-}
-
+   // Concatenate the face groups to create the model's submeshes.
+   std::vector<clockwork::graphics::TriangleIndices> orderedTriangles;
+   std::vector<std::array<clockwork::Vector3, 3>> fileNormals;
+   std::vector<std::array<clockwork::graphics::Texture::Coordinates, 3>> texcoordsPerCorner;
+   std::vector<bool> hasFileNormals;
+   std::vector<clockwork::graphics::Model3D::Submesh> submeshes;
 
-clockwork::Error
-loadMaterial(const QString& name, QTextStream& stream, clockwork::graphics::Material& material)
-{
-   auto error = clockwork::Error::None;
-   auto processingMaterial = false;
-
-   stream.skipWhiteSpace();
-   while (!stream.atEnd())
+   orderedTriangles.reserve(triangles.size());
+   fileNormals.reserve(triangles.size());
+   texcoordsPerCorner.reserve(triangles.size());
+   hasFileNormals.reserve(triangles.size());
+   for (const auto& group : faceGroups)
    {
-      // Read a line and remove any leading and trailing spaces.
-      const auto& line = stream.readLine().simplified();
-
-      // Skip comments and empty lines.
-      if (!line.isEmpty() && line[0] != '#')
+      if (!group.second.empty())
       {
-         auto tokens = line.split(" ");
-         if (!tokens.isEmpty())
+         const auto& offset = 3 * orderedTriangles.size();
+         const auto& count = 3 * group.second.size();
+         submeshes.push_back(clockwork::graphics::Model3D::Submesh(offset, count, group.first));
+         for (const auto& t : group.second)
          {
-            const auto& command = tokens.takeFirst();
-
-            // We've reached a material section. Process or ignore it.
-            if (command == "newmtl")
-            {
-               // If a material is currently being processed and a new section is
-               // reached, then we know we've reached the end of the target material.
-               if (processingMaterial)
-                  break;
-               else if (!processingMaterial && name == tokens.takeFirst())
-                  processingMaterial = true;
-            }
-            else if (processingMaterial)
-            {
-               if (!QString::compare(command, "Ka", Qt::CaseInsensitive))
-               {
-                  material.Ka.red = tokens.takeFirst().toDouble();
-                  material.Ka.green = tokens.takeFirst().toDouble();
-                  material.Ka.blue = tokens.takeFirst().toDouble();
-               }
-               else if (!QString::compare(command, "Kd", Qt::CaseInsensitive))
-               {
-                  material.Kd.red = tokens.takeFirst().toDouble();
-                  material.Kd.green = tokens.takeFirst().toDouble();
-                  material.Kd.blue = tokens.takeFirst().toDouble();
-               }
-               else if (!QString::compare(command, "Ks", Qt::CaseInsensitive))
-               {
-                  material.Ks.red = tokens.takeFirst().toDouble();
-                  material.Ks.green = tokens.takeFirst().toDouble();
-                  material.Ks.blue = tokens.takeFirst().toDouble();
-               }
-               else if (!QString::compare(command, "Tr", Qt::CaseInsensitive))
-                  material.transparency = tokens.takeFirst().toDouble();
-               else if (!QString::compare(command, "Ns", Qt::CaseInsensitive))
-                  material.shininess = tokens.takeFirst().toDouble();
-
-               // TODO Load textures.
-            }
+            orderedTriangles.push_back(triangles[t]);
+            fileNormals.push_back(triangleNormals[t]);
+            texcoordsPerCorner.push_back(triangleTexcoords[t]);
+            hasFileNormals.push_back(hasNormals[t]);
          }
       }
    }
-   return error;
+
+   // Calculate smooth vertex normals for faces that do not specify their own, then
+   // derive the tangents from the final normals. This is done once at load time so
+   // that shading never needs to recompute them.
+   std::vector<std::array<clockwork::Vector3, 3>> normalsPerCorner;
+   std::vector<std::array<clockwork::graphics::Tangent, 3>> tangentsPerCorner;
+   clockwork::graphics::computeVertexNormals(positions, orderedTriangles, normalsPerCorner);
+   for (std::size_t t = 0; t < orderedTriangles.size(); ++t)
+   {
+      if (hasFileNormals[t])
+         normalsPerCorner[t] = fileNormals[t];
+   }
+   clockwork::graphics::computeVertexTangents
+   (
+      positions,
+      orderedTriangles,
+      normalsPerCorner,
+      texcoordsPerCorner,
+      tangentsPerCorner
+   );
+
+   std::vector<clockwork::graphics::Face> faces;
+   faces.reserve(orderedTriangles.size());
+   for (std::size_t t = 0; t < orderedTriangles.size(); ++t)
+   {
+      const auto& indices = orderedTriangles[t];
+      const auto& normals = normalsPerCorner[t];
+      const auto& uvmaps = texcoordsPerCorner[t];
+      const auto& tangents = tangentsPerCorner[t];
+
+      faces.push_back
+      (
+         clockwork::graphics::Face
+         (
+            {indices[0], indices[1], indices[2]},
+            {normals[0], normals[1], normals[2]},
+            {uvmaps[0], uvmaps[1], uvmaps[2]},
+            {tangents[0], tangents[1], tangents[2]}
+         )
+      );
+   }
+   model.setMesh(positions, faces, submeshes);
+
+   if (closeFileOnFinish)
+      file.close();
+
+   return clockwork::Error::None;
 }
+
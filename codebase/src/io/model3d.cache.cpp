@@ -0,0 +1,261 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "model3d.cache.hh"
+#include <QDataStream>
+
+
+namespace {
+/**
+ * The model cache file's magic number ('CWMC').
+ */
+constexpr quint32 MAGIC_NUMBER = 0x43574D43;
+/**
+ * A value that is stored in native byte order, which makes sure that the raw attribute
+ * arrays were written by a machine with the same byte order.
+ */
+constexpr quint32 BYTE_ORDER_MARK = 0x01020304;
+/**
+ * Write a vector's content to a stream, as raw data.
+ */
+template<typename T> void
+writeRawArray(QDataStream& stream, const std::vector<T>& array)
+{
+   stream << static_cast<quint32>(array.size());
+   stream.writeRawData(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+}
+/**
+ * Read a vector's content from a stream. Return false if the data could not be read.
+ */
+template<typename T> bool
+readRawArray(QDataStream& stream, std::vector<T>& array)
+{
+   quint32 size = 0;
+   stream >> size;
+   if (stream.status() != QDataStream::Ok)
+      return false;
+
+   const auto& bytes = static_cast<qint64>(size) * sizeof(T);
+   if (bytes > stream.device()->bytesAvailable())
+      return false;
+
+   array.resize(size);
+   return stream.readRawData(reinterpret_cast<char*>(array.data()), bytes) == bytes;
+}
+/**
+ * Write a color to a stream.
+ */
+void
+writeColor(QDataStream& stream, const clockwork::graphics::ColorRGBA& color)
+{
+   stream << color.red << color.green << color.blue << color.alpha;
+}
+/**
+ * Read a color from a stream.
+ */
+void
+readColor(QDataStream& stream, clockwork::graphics::ColorRGBA& color)
+{
+   stream >> color.red >> color.green >> color.blue >> color.alpha;
+}
+} // namespace
+
+
+clockwork::Error
+clockwork::io::readModel3DCache(QFile& file, clockwork::graphics::Model3D& model)
+{
+   // If the file was opened in this method, then it should be closed by it.
+   bool closeFileOnFinish = false;
+   if (!file.isOpen())
+   {
+      closeFileOnFinish = file.open(QIODevice::ReadOnly);
+      if (!closeFileOnFinish)
+         return clockwork::Error::FileNotAccessible;
+   }
+
+   auto error = clockwork::Error::InvalidFileFormat;
+
+   QDataStream stream(&file);
+   stream.setVersion(QDataStream::Qt_5_0);
+   stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+   quint32 magic = 0, version = 0, byteOrderMark = 0;
+   stream >> magic >> version;
+   stream.readRawData(reinterpret_cast<char*>(&byteOrderMark), sizeof(byteOrderMark));
+   if (magic == MAGIC_NUMBER && version == MODEL3D_CACHE_VERSION && byteOrderMark == BYTE_ORDER_MARK)
+   {
+      std::vector<std::array<float, 3>> positions;
+      std::vector<std::array<float, 3>> normals;
+      std::vector<std::array<float, 2>> texcoords;
+      std::vector<std::array<float, 4>> tangents;
+      std::vector<uint32_t> indices;
+      std::vector<clockwork::graphics::Model3D::Submesh> submeshes;
+
+      if
+      (
+         readRawArray(stream, positions) &&
+         readRawArray(stream, normals) &&
+         readRawArray(stream, texcoords) &&
+         readRawArray(stream, tangents) &&
+         readRawArray(stream, indices)
+      )
+      {
+         quint32 submeshCount = 0;
+         stream >> submeshCount;
+         for (quint32 i = 0; i < submeshCount && stream.status() == QDataStream::Ok; ++i)
+         {
+            quint32 offset = 0, count = 0;
+            float shininess = 0, transparency = 0;
+            clockwork::graphics::Material material;
+
+            stream >> offset >> count >> shininess >> transparency;
+            readColor(stream, material.Ka);
+            readColor(stream, material.Kd);
+            readColor(stream, material.Ks);
+            material.shininess = shininess;
+            material.transparency = transparency;
+
+            submeshes.push_back(clockwork::graphics::Model3D::Submesh(offset, count, material));
+         }
+
+         // Make sure the data is consistent before it is used.
+         const auto& vertexCount = positions.size();
+         auto isValid =
+         stream.status() == QDataStream::Ok &&
+         normals.size() == vertexCount &&
+         texcoords.size() == vertexCount &&
+         tangents.size() == vertexCount &&
+         indices.size() % 3 == 0;
+         for (std::size_t i = 0; i < indices.size() && isValid; ++i)
+            isValid = indices[i] < vertexCount;
+         for (std::size_t i = 0; i < submeshes.size() && isValid; ++i)
+            isValid = static_cast<std::size_t>(submeshes[i].offset) + submeshes[i].count <= indices.size();
+
+         if (isValid)
+         {
+            model.setMesh(positions, normals, texcoords, tangents, indices, submeshes);
+
+            // Read the levels of detail. Their submeshes use the same materials as the
+            // original mesh's submeshes.
+            quint32 levelCount = 0;
+            stream >> levelCount;
+            for (quint32 l = 0; l < levelCount && isValid; ++l)
+            {
+               std::vector<uint32_t> levelIndices;
+               auto levelSubmeshes = submeshes;
+               double levelError = 0;
+
+               isValid = readRawArray(stream, levelIndices) && levelIndices.size() % 3 == 0;
+               for (std::size_t i = 0; i < levelIndices.size() && isValid; ++i)
+                  isValid = levelIndices[i] < vertexCount;
+               for (auto& submesh : levelSubmeshes)
+               {
+                  quint32 offset = 0, count = 0;
+                  stream >> offset >> count;
+                  submesh.offset = offset;
+                  submesh.count = count;
+                  isValid = isValid && static_cast<std::size_t>(offset) + count <= levelIndices.size();
+               }
+               stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+               stream >> levelError;
+               stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+               isValid = isValid && stream.status() == QDataStream::Ok;
+               if (isValid)
+                  model.addLevelOfDetail(levelIndices, levelSubmeshes, levelError);
+            }
+            if (isValid)
+               error = clockwork::Error::None;
+         }
+      }
+   }
+
+   if (closeFileOnFinish)
+      file.close();
+
+   return error;
+}
+
+
+clockwork::Error
+clockwork::io::writeModel3DCache(QFile& file, const clockwork::graphics::Model3D& model)
+{
+   // If the file was opened in this method, then it should be closed by it.
+   bool closeFileOnFinish = false;
+   if (!file.isOpen())
+   {
+      closeFileOnFinish = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+      if (!closeFileOnFinish)
+         return clockwork::Error::FileNotWritable;
+   }
+
+   QDataStream stream(&file);
+   stream.setVersion(QDataStream::Qt_5_0);
+   stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+   stream << MAGIC_NUMBER << MODEL3D_CACHE_VERSION;
+   stream.writeRawData(reinterpret_cast<const char*>(&BYTE_ORDER_MARK), sizeof(BYTE_ORDER_MARK));
+
+   writeRawArray(stream, model.getPositions());
+   writeRawArray(stream, model.getNormals());
+   writeRawArray(stream, model.getTextureMappingCoordinates());
+   writeRawArray(stream, model.getTangents());
+   writeRawArray(stream, model.getIndices().toVector());
+
+   // Texture maps are not loaded by the OBJ reader yet, so they are not cached either.
+   const auto& submeshes = model.getSubmeshes();
+   stream << static_cast<quint32>(submeshes.size());
+   for (const auto& submesh : submeshes)
+   {
+      const auto& material = submesh.material;
+      stream
+      << static_cast<quint32>(submesh.offset)
+      << static_cast<quint32>(submesh.count)
+      << static_cast<float>(material.shininess)
+      << static_cast<float>(material.transparency);
+      writeColor(stream, material.Ka);
+      writeColor(stream, material.Kd);
+      writeColor(stream, material.Ks);
+   }
+
+   // Write the levels of detail, without their materials.
+   const auto& levels = model.getLevelsOfDetail();
+   stream << static_cast<quint32>(levels.empty() ? 0 : levels.size() - 1);
+   for (std::size_t l = 1; l < levels.size(); ++l)
+   {
+      const auto& level = levels[l];
+      writeRawArray(stream, level.indices.toVector());
+      for (const auto& submesh : level.submeshes)
+         stream << static_cast<quint32>(submesh.offset) << static_cast<quint32>(submesh.count);
+
+      stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+      stream << level.error;
+      stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+   }
+
+   const auto& error = stream.status() == QDataStream::Ok ? clockwork::Error::None : clockwork::Error::FileNotWritable;
+   if (closeFileOnFinish)
+      file.close();
+
+   return error;
+}
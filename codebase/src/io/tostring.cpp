@@ -33,6 +33,15 @@ clockwork::toString(const clockwork::Error& error)
       case clockwork::Error::None:
          output.append("None");
          break;
+      case clockwork::Error::FileNotAccessible:
+         output.append("File not accessible");
+         break;
+      case clockwork::Error::FileNotWritable:
+         output.append("File not writable");
+         break;
+      case clockwork::Error::InvalidFileFormat:
+         output.append("Invalid file format");
+         break;
       case clockwork::Error::Unknown:
       default:
          output.append("???");
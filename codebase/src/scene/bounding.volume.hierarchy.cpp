@@ -0,0 +1,676 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "bounding.volume.hierarchy.hh"
+#include "transform.hierarchy.hh"
+#include "scene.object.hh"
+#include "property.appearance.hh"
+#include <QSet>
+#include <algorithm>
+#include <limits>
+
+using clockwork::scene::BoundingVolumeHierarchy;
+using clockwork::graphics::BoundingBox;
+
+
+constexpr int32_t BoundingVolumeHierarchy::NULL_NODE;
+constexpr double BoundingVolumeHierarchy::FAT_MARGIN;
+constexpr double BoundingVolumeHierarchy::REBUILD_THRESHOLD;
+constexpr unsigned int BoundingVolumeHierarchy::SAH_BIN_COUNT;
+
+
+namespace {
+/**
+ * Return true if two boxes are identical, false otherwise.
+ */
+bool
+isEqual(const BoundingBox& a, const BoundingBox& b)
+{
+   return
+   a.minimum.x == b.minimum.x && a.minimum.y == b.minimum.y && a.minimum.z == b.minimum.z &&
+   a.maximum.x == b.maximum.x && a.maximum.y == b.maximum.y && a.maximum.z == b.maximum.z;
+}
+/**
+ * Return the union of two boxes.
+ */
+BoundingBox
+merge(const BoundingBox& a, const BoundingBox& b)
+{
+   auto output = a;
+   output.extend(b);
+   return output;
+}
+/**
+ * Return a box that is enlarged by a fraction of its largest extent on every side.
+ */
+BoundingBox
+fatten(const BoundingBox& box, const double& margin)
+{
+   const auto& extent = std::max
+   (
+      {box.maximum.x - box.minimum.x, box.maximum.y - box.minimum.y, box.maximum.z - box.minimum.z}
+   );
+   const auto& d = margin * extent;
+
+   return BoundingBox
+   (
+      clockwork::Point3(box.minimum.x - d, box.minimum.y - d, box.minimum.z - d),
+      clockwork::Point3(box.maximum.x + d, box.maximum.y + d, box.maximum.z + d)
+   );
+}
+/**
+ * Return a point's coordinate on the specified axis.
+ */
+double
+getCoordinate(const clockwork::Point3& point, const unsigned int& axis)
+{
+   return axis == 0 ? point.x : axis == 1 ? point.y : point.z;
+}
+} // namespace
+
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() :
+_root(NULL_NODE),
+_freeList(NULL_NODE),
+_cost(0),
+_rebuildCost(0),
+_topologyRevision(0)
+{}
+
+
+std::size_t
+BoundingVolumeHierarchy::size() const
+{
+   return _leaves.size();
+}
+
+
+bool
+BoundingVolumeHierarchy::contains(const Object& object) const
+{
+   return _leaves.contains(&object);
+}
+
+
+double
+BoundingVolumeHierarchy::getCost() const
+{
+   return _cost;
+}
+
+
+int32_t
+BoundingVolumeHierarchy::allocateNode()
+{
+   int32_t index = _freeList;
+   if (index != NULL_NODE)
+      _freeList = _nodes[index].parent;
+   else
+   {
+      index = static_cast<int32_t>(_nodes.size());
+      _nodes.push_back(Node());
+   }
+
+   auto& node = _nodes[index];
+   node.box = BoundingBox();
+   node.parent = NULL_NODE;
+   node.left = NULL_NODE;
+   node.right = NULL_NODE;
+   node.object = nullptr;
+
+   return index;
+}
+
+
+void
+BoundingVolumeHierarchy::freeNode(const int32_t& index)
+{
+   auto& node = _nodes[index];
+   node.parent = _freeList;
+   node.left = NULL_NODE;
+   node.right = NULL_NODE;
+   node.object = nullptr;
+
+   _freeList = index;
+}
+
+
+void
+BoundingVolumeHierarchy::setBox(const int32_t& index, const BoundingBox& box)
+{
+   auto& node = _nodes[index];
+   if (!node.isLeaf())
+      _cost += box.getSurfaceArea() - node.box.getSurfaceArea();
+
+   node.box = box;
+}
+
+
+void
+BoundingVolumeHierarchy::insertLeaf(const int32_t& leaf)
+{
+   if (_root == NULL_NODE)
+   {
+      _root = leaf;
+      _nodes[leaf].parent = NULL_NODE;
+      return;
+   }
+
+   // Descend the tree to find the best sibling for the new leaf. At each node, the cost
+   // of pairing the leaf with the node is compared to the lowest possible cost of pairing
+   // it with one of the node's descendants, which includes the growth of every ancestor.
+   const auto leafBox = _nodes[leaf].box;
+   const auto& getDescendCost = [this, &leafBox](const int32_t& index, const double& inheritedCost)
+   {
+      const auto& node = _nodes[index];
+      const auto& area = merge(node.box, leafBox).getSurfaceArea();
+
+      return (node.isLeaf() ? area : area - node.box.getSurfaceArea()) + inheritedCost;
+   };
+
+   auto index = _root;
+   while (!_nodes[index].isLeaf())
+   {
+      const auto& node = _nodes[index];
+      const auto& area = node.box.getSurfaceArea();
+      const auto& combinedArea = merge(node.box, leafBox).getSurfaceArea();
+
+      const auto& cost = 2.0 * combinedArea;
+      const auto& inheritedCost = 2.0 * (combinedArea - area);
+      const auto& leftCost = getDescendCost(node.left, inheritedCost);
+      const auto& rightCost = getDescendCost(node.right, inheritedCost);
+
+      if (cost < leftCost && cost < rightCost)
+         break;
+
+      index = leftCost < rightCost ? node.left : node.right;
+   }
+
+   // Create a new parent for the sibling and the leaf.
+   const auto sibling = index;
+   const auto oldParent = _nodes[sibling].parent;
+   const auto newParent = allocateNode();
+
+   _nodes[newParent].parent = oldParent;
+   _nodes[newParent].left = sibling;
+   _nodes[newParent].right = leaf;
+   setBox(newParent, merge(_nodes[sibling].box, leafBox));
+
+   _nodes[sibling].parent = newParent;
+   _nodes[leaf].parent = newParent;
+
+   if (oldParent == NULL_NODE)
+      _root = newParent;
+   else
+   {
+      auto& parent = _nodes[oldParent];
+      (parent.left == sibling ? parent.left : parent.right) = newParent;
+      refit(oldParent);
+   }
+}
+
+
+void
+BoundingVolumeHierarchy::removeLeaf(const int32_t& leaf)
+{
+   if (leaf == _root)
+   {
+      _root = NULL_NODE;
+      return;
+   }
+
+   const auto parent = _nodes[leaf].parent;
+   const auto grandParent = _nodes[parent].parent;
+   const auto sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+
+   // Replace the parent with the sibling.
+   if (grandParent == NULL_NODE)
+      _root = sibling;
+   else
+   {
+      auto& node = _nodes[grandParent];
+      (node.left == parent ? node.left : node.right) = sibling;
+   }
+   _nodes[sibling].parent = grandParent;
+   _nodes[leaf].parent = NULL_NODE;
+
+   setBox(parent, BoundingBox());
+   freeNode(parent);
+
+   if (grandParent != NULL_NODE)
+      refit(grandParent);
+}
+
+
+void
+BoundingVolumeHierarchy::refit(int32_t index)
+{
+   // Recalculate the boxes on the path to the root, stopping early when a box does
+   // not change since none of its ancestors will either.
+   while (index != NULL_NODE)
+   {
+      const auto& node = _nodes[index];
+      const auto& box = merge(_nodes[node.left].box, _nodes[node.right].box);
+      if (isEqual(box, node.box))
+         break;
+
+      setBox(index, box);
+      index = node.parent;
+   }
+}
+
+
+void
+BoundingVolumeHierarchy::update(Object& object, const BoundingBox& box)
+{
+   if (box.isEmpty())
+   {
+      remove(object);
+      return;
+   }
+
+   const auto& it = _leaves.constFind(&object);
+   if (it == _leaves.constEnd())
+   {
+      const auto leaf = allocateNode();
+      _nodes[leaf].object = &object;
+      setBox(leaf, fatten(box, FAT_MARGIN));
+      insertLeaf(leaf);
+      _leaves.insert(&object, leaf);
+   }
+   else
+   {
+      // An object that is still inside its fat box does not modify the tree. An object
+      // that has moved a little is refitted in place, while an object that has moved
+      // far from its previous location is reinserted.
+      const auto leaf = it.value();
+      const auto& leafBox = _nodes[leaf].box;
+      if (leafBox.contains(box))
+         return;
+
+      if (leafBox.intersects(box))
+      {
+         setBox(leaf, fatten(box, FAT_MARGIN));
+         refit(_nodes[leaf].parent);
+      }
+      else
+      {
+         removeLeaf(leaf);
+         setBox(leaf, fatten(box, FAT_MARGIN));
+         insertLeaf(leaf);
+      }
+   }
+}
+
+
+void
+BoundingVolumeHierarchy::remove(const Object& object)
+{
+   const auto& it = _leaves.find(&object);
+   if (it != _leaves.end())
+   {
+      const auto leaf = it.value();
+      removeLeaf(leaf);
+      freeNode(leaf);
+      _leaves.erase(it);
+   }
+}
+
+
+void
+BoundingVolumeHierarchy::update(const TransformHierarchy& hierarchy)
+{
+   // When the scene graph's topology changes, the objects that were removed from it
+   // are removed from the tree. Note that these objects may no longer exist, so they
+   // are only used as keys.
+   if (hierarchy.getTopologyRevision() != _topologyRevision)
+   {
+      QSet<const Object*> objects;
+      objects.reserve(static_cast<int>(hierarchy.size()));
+      for (std::size_t i = 0; i < hierarchy.size(); ++i)
+         objects.insert(&hierarchy.getObject(i));
+
+      for (auto it = _leaves.begin(); it != _leaves.end();)
+      {
+         if (objects.contains(it.key()))
+            ++it;
+         else
+         {
+            removeLeaf(it.value());
+            freeNode(it.value());
+            it = _leaves.erase(it);
+         }
+      }
+      _topologyRevision = hierarchy.getTopologyRevision();
+   }
+
+   for (const auto& index : hierarchy.getChangedObjects())
+   {
+      auto& object = hierarchy.getObject(index);
+      update(object, getBoundingBox(object));
+   }
+
+   if (_leaves.size() > 2 && _cost > REBUILD_THRESHOLD * _rebuildCost)
+      rebuild();
+}
+
+
+void
+BoundingVolumeHierarchy::rebuild()
+{
+   std::vector<LeafEntry> entries;
+   entries.reserve(_leaves.size());
+   for (const auto& leaf : _leaves)
+   {
+      const auto& node = _nodes[leaf];
+      entries.push_back({node.object, node.box, node.box.getCenter()});
+   }
+
+   _nodes.clear();
+   _leaves.clear();
+   _root = NULL_NODE;
+   _freeList = NULL_NODE;
+   _cost = 0;
+
+   if (!entries.empty())
+   {
+      _nodes.reserve((2 * entries.size()) - 1);
+      _root = build(entries, 0, entries.size(), NULL_NODE);
+   }
+   _rebuildCost = _cost;
+}
+
+
+int32_t
+BoundingVolumeHierarchy::build
+(
+   std::vector<LeafEntry>& entries,
+   const std::size_t& begin,
+   const std::size_t& end,
+   const int32_t& parent
+)
+{
+   const auto index = allocateNode();
+   _nodes[index].parent = parent;
+
+   const auto& count = end - begin;
+   if (count == 1)
+   {
+      auto& entry = entries[begin];
+      _nodes[index].object = entry.object;
+      setBox(index, entry.box);
+      _leaves.insert(entry.object, index);
+      return index;
+   }
+
+   BoundingBox bounds;
+   BoundingBox centroidBounds;
+   for (auto i = begin; i < end; ++i)
+   {
+      bounds.extend(entries[i].box);
+      centroidBounds.extend(entries[i].centroid);
+   }
+
+   // Split along the axis with the largest centroid extent.
+   unsigned int axis = 0;
+   double extent = 0.0;
+   for (unsigned int a = 0; a < 3; ++a)
+   {
+      const auto& e = getCoordinate(centroidBounds.maximum, a) - getCoordinate(centroidBounds.minimum, a);
+      if (e > extent)
+      {
+         axis = a;
+         extent = e;
+      }
+   }
+
+   auto split = begin + (count / 2);
+   if (extent > 0.0)
+   {
+      // Distribute the entries into bins along the axis, then choose the split between
+      // two bins that minimises the surface area heuristic.
+      const auto& offset = getCoordinate(centroidBounds.minimum, axis);
+      const auto& getBin = [&](const LeafEntry& entry)
+      {
+         const auto& t = (getCoordinate(entry.centroid, axis) - offset) / extent;
+         return std::min(static_cast<unsigned int>(t * SAH_BIN_COUNT), SAH_BIN_COUNT - 1);
+      };
+
+      std::array<BoundingBox, SAH_BIN_COUNT> binBounds;
+      std::array<std::size_t, SAH_BIN_COUNT> binCounts = {};
+      for (auto i = begin; i < end; ++i)
+      {
+         const auto& bin = getBin(entries[i]);
+         binBounds[bin].extend(entries[i].box);
+         ++binCounts[bin];
+      }
+
+      std::array<double, SAH_BIN_COUNT> rightCosts = {};
+      BoundingBox rightBounds;
+      std::size_t rightCount = 0;
+      for (auto bin = SAH_BIN_COUNT - 1; bin > 0; --bin)
+      {
+         rightBounds.extend(binBounds[bin]);
+         rightCount += binCounts[bin];
+         rightCosts[bin - 1] = rightCount * rightBounds.getSurfaceArea();
+      }
+
+      BoundingBox leftBounds;
+      std::size_t leftCount = 0;
+      auto bestCost = std::numeric_limits<double>::max();
+      unsigned int bestBin = 0;
+      for (unsigned int bin = 0; bin + 1 < SAH_BIN_COUNT; ++bin)
+      {
+         leftBounds.extend(binBounds[bin]);
+         leftCount += binCounts[bin];
+
+         const auto& cost = (leftCount * leftBounds.getSurfaceArea()) + rightCosts[bin];
+         if (leftCount > 0 && leftCount < count && cost < bestCost)
+         {
+            bestCost = cost;
+            bestBin = bin;
+         }
+      }
+
+      const auto& middle = std::partition
+      (
+         entries.begin() + begin, entries.begin() + end,
+         [&](const LeafEntry& entry) { return getBin(entry) <= bestBin; }
+      );
+      split = static_cast<std::size_t>(middle - entries.begin());
+   }
+
+   // Fall back to a median split if every entry ended up on the same side.
+   if (split == begin || split == end)
+   {
+      split = begin + (count / 2);
+      std::nth_element
+      (
+         entries.begin() + begin, entries.begin() + split, entries.begin() + end,
+         [&axis](const LeafEntry& a, const LeafEntry& b)
+         {
+            return getCoordinate(a.centroid, axis) < getCoordinate(b.centroid, axis);
+         }
+      );
+   }
+
+   const auto left = build(entries, begin, split, index);
+   const auto right = build(entries, split, end, index);
+
+   _nodes[index].left = left;
+   _nodes[index].right = right;
+   setBox(index, bounds);
+
+   return index;
+}
+
+
+void
+BoundingVolumeHierarchy::query
+(
+   const clockwork::graphics::BoundingFrustum& frustum,
+   const std::function<void(Object&)>& visitor
+) const
+{
+   using clockwork::graphics::BoundingFrustum;
+
+   if (_root == NULL_NODE)
+      return;
+
+   // Each stack entry records whether its node is known to be completely inside the
+   // frustum, in which case its descendants do not need to be tested.
+   std::vector<std::pair<int32_t, bool>> stack;
+   stack.emplace_back(_root, false);
+   while (!stack.empty())
+   {
+      const auto entry = stack.back();
+      stack.pop_back();
+
+      const auto& node = _nodes[entry.first];
+      auto isInside = entry.second;
+      if (!isInside)
+      {
+         const auto& containment = frustum.contains(node.box);
+         if (containment == BoundingFrustum::Containment::Outside)
+            continue;
+
+         isInside = containment == BoundingFrustum::Containment::Inside;
+      }
+
+      if (node.isLeaf())
+         visitor(*node.object);
+      else
+      {
+         stack.emplace_back(node.right, isInside);
+         stack.emplace_back(node.left, isInside);
+      }
+   }
+}
+
+
+void
+BoundingVolumeHierarchy::query(const BoundingBox& box, const std::function<void(Object&)>& visitor) const
+{
+   if (_root == NULL_NODE)
+      return;
+
+   std::vector<int32_t> stack(1, _root);
+   while (!stack.empty())
+   {
+      const auto& node = _nodes[stack.back()];
+      stack.pop_back();
+
+      if (node.box.intersects(box))
+      {
+         if (node.isLeaf())
+            visitor(*node.object);
+         else
+         {
+            stack.push_back(node.right);
+            stack.push_back(node.left);
+         }
+      }
+   }
+}
+
+
+void
+BoundingVolumeHierarchy::query
+(
+   const clockwork::graphics::Ray& ray,
+   const double& maximumDistance,
+   const std::function<double(Object&, const double&)>& visitor
+) const
+{
+   if (_root == NULL_NODE)
+      return;
+
+   auto tmin = 0.0;
+   auto tmax = maximumDistance;
+   if (!_nodes[_root].box.intersects(ray, tmin, tmax))
+      return;
+
+   // Each stack entry records the distance at which the ray enters its node, so that
+   // nodes that are further away than the closest hit so far can be skipped. The nearer
+   // child is always visited first.
+   auto distance = maximumDistance;
+   std::vector<std::pair<int32_t, double>> stack;
+   stack.emplace_back(_root, tmin);
+   while (!stack.empty())
+   {
+      const auto entry = stack.back();
+      stack.pop_back();
+      if (entry.second > distance)
+         continue;
+
+      const auto& node = _nodes[entry.first];
+      if (node.isLeaf())
+      {
+         distance = std::min(distance, visitor(*node.object, entry.second));
+         continue;
+      }
+
+      auto leftMinimum = 0.0;
+      auto leftMaximum = distance;
+      auto rightMinimum = 0.0;
+      auto rightMaximum = distance;
+      const auto& isLeftHit = _nodes[node.left].box.intersects(ray, leftMinimum, leftMaximum);
+      const auto& isRightHit = _nodes[node.right].box.intersects(ray, rightMinimum, rightMaximum);
+
+      if (isLeftHit && isRightHit)
+      {
+         if (leftMinimum <= rightMinimum)
+         {
+            stack.emplace_back(node.right, rightMinimum);
+            stack.emplace_back(node.left, leftMinimum);
+         }
+         else
+         {
+            stack.emplace_back(node.left, leftMinimum);
+            stack.emplace_back(node.right, rightMinimum);
+         }
+      }
+      else if (isLeftHit)
+         stack.emplace_back(node.left, leftMinimum);
+      else if (isRightHit)
+         stack.emplace_back(node.right, rightMinimum);
+   }
+}
+
+
+BoundingBox
+BoundingVolumeHierarchy::getBoundingBox(const Object& object)
+{
+   using clockwork::scene::Appearance;
+   using clockwork::scene::Property;
+
+   const auto* const appearance =
+   static_cast<const Appearance*>(object.getProperty(Property::Identifier::Appearance));
+   if (appearance != nullptr)
+   {
+      const auto* const model3D = appearance->getModel3D();
+      if (model3D != nullptr && !model3D->isEmpty())
+         return BoundingBox::transform(model3D->getBoundingBox(), object.getCMTM());
+   }
+   return BoundingBox();
+}
@@ -0,0 +1,725 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "scene.generator.hh"
+#include "property.appearance.hh"
+#include "property.light.emission.hh"
+#include <QStringList>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+
+using clockwork::scene::SceneGenerator;
+using clockwork::graphics::Model3D;
+
+
+namespace {
+/**
+ * The ratio of a circle's circumference to its diameter.
+ */
+constexpr double PI = 3.14159265358979323846;
+/**
+ * Half the width of the area covered by the mesh objects.
+ */
+constexpr double GRID_EXTENT = 0.8;
+/**
+ * Half the width of the area that scattered objects travel across. It is larger than
+ * the grid, so scattered objects may leave the view.
+ */
+constexpr double SCATTER_EXTENT = 1.2;
+/**
+ * The distance from the scene's center to its light sources.
+ */
+constexpr double LIGHT_RING_RADIUS = 1.0;
+/**
+ * The largest displacement of a terrain's vertices, relative to its half-width.
+ */
+constexpr double TERRAIN_AMPLITUDE = 0.25;
+/**
+ * The independent sequences of random values used by the generator.
+ */
+enum class RandomStream : uint32_t
+{
+   Phase,
+   Moving,
+   Destination,
+   LightColor,
+   Noise
+};
+/**
+ * Scramble a 64-bit value (SplitMix64's finaliser).
+ */
+uint64_t
+mix(uint64_t x)
+{
+   x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+   return x ^ (x >> 31);
+}
+/**
+ * Return a random value in [0, 1) for an index of a stream. The same inputs always
+ * return the same value, regardless of the order in which values are requested.
+ */
+double
+getRandomValue(const uint32_t& seed, const RandomStream& stream, const uint64_t& index)
+{
+   const auto& key = static_cast<uint64_t>(seed) << 32 | static_cast<uint32_t>(stream);
+   return (mix(mix(key) + 0x9e3779b97f4a7c15ULL * (index + 1)) >> 11) * (1.0 / 9007199254740992.0);
+}
+/**
+ * Return the value of smooth 2D noise at a given point, in [-1, 1]. Random values are
+ * placed at integer coordinates, and interpolated in between.
+ */
+double
+getValueNoise(const double& x, const double& y, const uint32_t& seed)
+{
+   const auto& i = std::floor(x);
+   const auto& j = std::floor(y);
+   const auto& lattice = [seed](const double& u, const double& v)
+   {
+      const auto& index = static_cast<uint64_t>(static_cast<uint32_t>(u)) << 32 | static_cast<uint32_t>(v);
+      return 2.0 * getRandomValue(seed, RandomStream::Noise, index) - 1.0;
+   };
+   const auto& smooth = [](const double& t) { return t * t * (3.0 - 2.0 * t); };
+   const auto& s = smooth(x - i);
+   const auto& t = smooth(y - j);
+
+   const auto& bottom = (1.0 - s) * lattice(i, j) + s * lattice(i + 1, j);
+   const auto& top = (1.0 - s) * lattice(i, j + 1) + s * lattice(i + 1, j + 1);
+   return (1.0 - t) * bottom + t * top;
+}
+/**
+ * Return the value of fractal noise at a given point, in [-1, 1]. Each octave adds
+ * finer detail with half the amplitude of the previous one.
+ */
+double
+getFractalNoise(const double& x, const double& y, const uint32_t& seed)
+{
+   constexpr unsigned int OCTAVE_COUNT = 4;
+
+   auto value = 0.0;
+   auto amplitude = 1.0;
+   auto frequency = 1.0;
+   auto totalAmplitude = 0.0;
+   for (unsigned int octave = 0; octave < OCTAVE_COUNT; ++octave)
+   {
+      value += amplitude * getValueNoise(frequency * x, frequency * y, seed + octave);
+      totalAmplitude += amplitude;
+      amplitude *= 0.5;
+      frequency *= 2.0;
+   }
+   return value / totalAmplitude;
+}
+/**
+ * Return the coordinates of the cell at a given position along a Z-order curve, which
+ * keeps cells that are close along the curve close on the grid.
+ */
+std::array<uint32_t, 2>
+getMortonCell(const uint32_t& index)
+{
+   const auto& compact = [](uint32_t x)
+   {
+      x &= 0x55555555;
+      x = (x | (x >> 1)) & 0x33333333;
+      x = (x | (x >> 2)) & 0x0f0f0f0f;
+      x = (x | (x >> 4)) & 0x00ff00ff;
+      x = (x | (x >> 8)) & 0x0000ffff;
+      return x;
+   };
+   return {{compact(index), compact(index >> 1)}};
+}
+/**
+ * Return base raised to a given exponent, or limit if the result would exceed it.
+ */
+uint64_t
+power(const uint64_t& base, const uint32_t& exponent, const uint64_t& limit)
+{
+   uint64_t result = 1;
+   for (uint32_t i = 0; i < exponent && result <= limit; ++i)
+      result *= base;
+
+   return std::min(result, limit + 1);
+}
+/**
+ * Return a set of options whose values are within their valid ranges.
+ */
+SceneGenerator::Options
+sanitise(const SceneGenerator::Options& options)
+{
+   auto sanitised = options;
+   sanitised.objectCount = std::min(std::max(options.objectCount, 1U), SceneGenerator::MAXIMUM_OBJECT_COUNT);
+   sanitised.hierarchyDepth = std::min(std::max(options.hierarchyDepth, 1U), SceneGenerator::MAXIMUM_HIERARCHY_DEPTH);
+   sanitised.meshResolution = std::max(options.meshResolution, 2U);
+   sanitised.instancingRatio = std::min(std::max(options.instancingRatio, 0.0), 1.0);
+   sanitised.movingRatio = std::min(std::max(options.movingRatio, 0.0), 1.0);
+
+   return sanitised;
+}
+/**
+ * Return the name of a mesh, as it appears in a scene description.
+ */
+QString
+getName(const SceneGenerator::Mesh& mesh)
+{
+   switch (mesh)
+   {
+      case SceneGenerator::Mesh::Sphere:
+         return "sphere";
+      case SceneGenerator::Mesh::Grid:
+         return "grid";
+      case SceneGenerator::Mesh::Terrain:
+         return "terrain";
+      default:
+         return "unknown";
+   }
+}
+/**
+ * Return the name of a motion, as it appears in a scene description.
+ */
+QString
+getName(const SceneGenerator::Motion& motion)
+{
+   switch (motion)
+   {
+      case SceneGenerator::Motion::Static:
+         return "static";
+      case SceneGenerator::Motion::Turn:
+         return "turn";
+      case SceneGenerator::Motion::Spin:
+         return "spin";
+      case SceneGenerator::Motion::Orbit:
+         return "orbit";
+      case SceneGenerator::Motion::Scatter:
+         return "scatter";
+      default:
+         return "unknown";
+   }
+}
+/**
+ * Find the value with a given name, which is matched without regard to case. Returns
+ * true if a value was found, false otherwise.
+ */
+template<class T>
+bool
+findByName(const QString& name, const std::initializer_list<T>& values, T& value)
+{
+   for (const auto& candidate : values)
+   {
+      if (getName(candidate).compare(name, Qt::CaseInsensitive) == 0)
+      {
+         value = candidate;
+         return true;
+      }
+   }
+   return false;
+}
+} // namespace
+
+
+constexpr uint32_t SceneGenerator::MAXIMUM_OBJECT_COUNT;
+constexpr uint32_t SceneGenerator::MAXIMUM_HIERARCHY_DEPTH;
+
+
+SceneGenerator::SceneGenerator(const Options& options, Object& parent) :
+_options(sanitise(options)),
+_parent(parent),
+_root(new Object("Generated Scene")),
+_lights(nullptr),
+_spacing(0.0)
+{
+   _objects.push_back(_root);
+
+   createModel3Ds();
+   createObjects();
+   createLights();
+
+   // The scene is only attached once it is complete, so that the hierarchy is built once.
+   _parent.addChild(_root);
+}
+
+
+SceneGenerator::~SceneGenerator()
+{
+   // The generated objects are deleted along with the root.
+   _parent.removeChild(_root);
+}
+
+
+const SceneGenerator::Options&
+SceneGenerator::getOptions() const
+{
+   return _options;
+}
+
+
+clockwork::scene::Object&
+SceneGenerator::getRoot()
+{
+   return *_root;
+}
+
+
+const std::vector<clockwork::scene::Object*>&
+SceneGenerator::getObjects() const
+{
+   return _objects;
+}
+
+
+std::size_t
+SceneGenerator::getModel3DCount() const
+{
+   return _model3Ds.size();
+}
+
+
+void
+SceneGenerator::animate(const double& t)
+{
+   switch (_options.motion)
+   {
+      case Motion::Static:
+         break;
+      case Motion::Turn:
+         _root->setRotation(0, 0, 360.0 * t);
+         break;
+      case Motion::Spin:
+         for (const auto& moving : _movingObjects)
+            moving.object->setRotation(0, 360.0 * (t + moving.phase), 0);
+         break;
+      case Motion::Orbit:
+      {
+         const auto& radius = 0.25 * _spacing;
+         for (const auto& moving : _movingObjects)
+         {
+            const auto& angle = 2.0 * PI * (t + moving.phase);
+            moving.object->setPosition
+            (
+               moving.home.x + radius * std::cos(angle),
+               moving.home.y + radius * std::sin(angle),
+               moving.home.z
+            );
+         }
+         break;
+      }
+      case Motion::Scatter:
+         for (const auto& moving : _movingObjects)
+         {
+            const auto& s = 0.5 - 0.5 * std::cos(2.0 * PI * (t + moving.phase));
+            moving.object->setPosition
+            (
+               moving.home.x + s * (moving.destination.x - moving.home.x),
+               moving.home.y + s * (moving.destination.y - moving.home.y),
+               moving.home.z + s * (moving.destination.z - moving.home.z)
+            );
+         }
+         break;
+   }
+
+   // The light sources circle the objects, unless they already turn with the scene.
+   if (_lights != nullptr && _options.motion != Motion::Static && _options.motion != Motion::Turn)
+      _lights->setRotation(0, 0, 360.0 * t);
+}
+
+
+bool
+SceneGenerator::parse(const QString& description, Options& options, std::ostream& errors)
+{
+   auto parsed = options;
+   for (const auto& pair : description.split(',', QString::SkipEmptyParts))
+   {
+      const auto& separator = pair.indexOf('=');
+      const auto& key = pair.left(separator).trimmed().toLower();
+      const auto& value = separator < 0 ? QString() : pair.mid(separator + 1).trimmed();
+
+      auto isValid = true;
+      if (key == "objects")
+      {
+         parsed.objectCount = value.toUInt(&isValid);
+         isValid = isValid && parsed.objectCount >= 1 && parsed.objectCount <= MAXIMUM_OBJECT_COUNT;
+      }
+      else if (key == "depth")
+      {
+         parsed.hierarchyDepth = value.toUInt(&isValid);
+         isValid = isValid && parsed.hierarchyDepth >= 1 && parsed.hierarchyDepth <= MAXIMUM_HIERARCHY_DEPTH;
+      }
+      else if (key == "mesh")
+         isValid = findByName(value, {Mesh::Sphere, Mesh::Grid, Mesh::Terrain}, parsed.mesh);
+      else if (key == "resolution")
+      {
+         parsed.meshResolution = value.toUInt(&isValid);
+         isValid = isValid && parsed.meshResolution >= 2;
+      }
+      else if (key == "instancing")
+      {
+         parsed.instancingRatio = value.toDouble(&isValid);
+         isValid = isValid && parsed.instancingRatio >= 0.0 && parsed.instancingRatio <= 1.0;
+      }
+      else if (key == "lights")
+         parsed.lightCount = value.toUInt(&isValid);
+      else if (key == "motion")
+         isValid = findByName(value, {Motion::Static, Motion::Turn, Motion::Spin, Motion::Orbit, Motion::Scatter}, parsed.motion);
+      else if (key == "moving")
+      {
+         parsed.movingRatio = value.toDouble(&isValid);
+         isValid = isValid && parsed.movingRatio >= 0.0 && parsed.movingRatio <= 1.0;
+      }
+      else if (key == "seed")
+         parsed.seed = value.toUInt(&isValid);
+      else
+      {
+         errors << "Unknown scene parameter '" << pair.trimmed().toStdString() << "'. The parameters are objects, depth, "
+                << "mesh, resolution, instancing, lights, motion, moving and seed." << std::endl;
+         return false;
+      }
+
+      if (separator <= 0 || !isValid)
+      {
+         errors << "Invalid value '" << value.toStdString() << "' for the scene parameter '" << key.toStdString() << "'." << std::endl;
+         return false;
+      }
+   }
+   options = parsed;
+   return true;
+}
+
+
+QString
+SceneGenerator::toString(const Options& options)
+{
+   return QStringList
+   ({
+      QString("objects=%1").arg(options.objectCount),
+      QString("depth=%1").arg(options.hierarchyDepth),
+      QString("mesh=%1").arg(getName(options.mesh)),
+      QString("resolution=%1").arg(options.meshResolution),
+      QString("instancing=%1").arg(options.instancingRatio),
+      QString("lights=%1").arg(options.lightCount),
+      QString("motion=%1").arg(getName(options.motion)),
+      QString("moving=%1").arg(options.movingRatio),
+      QString("seed=%1").arg(options.seed)
+   }).join(',');
+}
+
+
+std::unique_ptr<Model3D>
+SceneGenerator::createSphere(const uint32_t& slices, const uint32_t& stacks)
+{
+   std::vector<std::array<float, 3>> positions;
+   std::vector<std::array<float, 3>> normals;
+   std::vector<std::array<float, 2>> texcoords;
+   std::vector<std::array<float, 4>> tangents;
+   for (uint32_t i = 0; i <= stacks; ++i)
+   {
+      const auto& theta = PI * i / stacks;
+      for (uint32_t j = 0; j <= slices; ++j)
+      {
+         const auto& phi = 2.0 * PI * j / slices;
+         const std::array<float, 3> position =
+         {{
+            static_cast<float>(std::sin(theta) * std::cos(phi)),
+            static_cast<float>(std::cos(theta)),
+            static_cast<float>(std::sin(theta) * std::sin(phi))
+         }};
+         positions.push_back(position);
+         normals.push_back(position);
+         texcoords.push_back({{static_cast<float>(j) / slices, static_cast<float>(i) / stacks}});
+         tangents.push_back({{static_cast<float>(-std::sin(phi)), 0.0f, static_cast<float>(std::cos(phi)), 1.0f}});
+      }
+   }
+
+   // Each quad between two stacks is split into two triangles, except at the poles
+   // where one of them would be degenerate.
+   std::vector<uint32_t> indices;
+   for (uint32_t i = 0; i < stacks; ++i)
+   {
+      for (uint32_t j = 0; j < slices; ++j)
+      {
+         const auto& a = i * (slices + 1) + j;
+         const auto& b = a + slices + 1;
+         if (i != 0)
+            indices.insert(indices.end(), {a, b, a + 1});
+         if (i + 1 != stacks)
+            indices.insert(indices.end(), {a + 1, b, b + 1});
+      }
+   }
+
+   std::unique_ptr<Model3D> model3D(new Model3D);
+   model3D->setMesh
+   (
+      positions, normals, texcoords, tangents, indices,
+      {Model3D::Submesh(0, static_cast<uint32_t>(indices.size()), clockwork::graphics::Material())}
+   );
+   return model3D;
+}
+
+
+std::unique_ptr<Model3D>
+SceneGenerator::createGrid(const uint32_t& resolution, const double& amplitude, const uint32_t& seed)
+{
+   const auto n = std::max(resolution, 1U);
+   const auto& step = 2.0 / n;
+
+   // The noise has a few features across the grid, whatever its resolution.
+   std::vector<double> heights;
+   heights.reserve((n + 1) * (n + 1));
+   for (uint32_t i = 0; i <= n; ++i)
+   {
+      for (uint32_t j = 0; j <= n; ++j)
+         heights.push_back(amplitude != 0.0 ? amplitude * getFractalNoise(4.0 * j / n, 4.0 * i / n, seed) : 0.0);
+   }
+   const auto& getHeight = [&heights, n](const uint32_t& i, const uint32_t& j) { return heights[i * (n + 1) + j]; };
+
+   // Rows run from the top of the grid to its bottom, and columns from left to right.
+   std::vector<std::array<float, 3>> positions;
+   std::vector<std::array<float, 3>> normals;
+   std::vector<std::array<float, 2>> texcoords;
+   std::vector<std::array<float, 4>> tangents;
+   for (uint32_t i = 0; i <= n; ++i)
+   {
+      for (uint32_t j = 0; j <= n; ++j)
+      {
+         positions.push_back
+         ({{
+            static_cast<float>(-1.0 + step * j),
+            static_cast<float>(1.0 - step * i),
+            static_cast<float>(getHeight(i, j))
+         }});
+         texcoords.push_back({{static_cast<float>(j) / n, static_cast<float>(i) / n}});
+
+         // The surface's slopes are estimated from the neighbouring heights.
+         const auto& left = j > 0 ? j - 1 : j;
+         const auto& right = j < n ? j + 1 : j;
+         const auto& above = i > 0 ? i - 1 : i;
+         const auto& below = i < n ? i + 1 : i;
+         const auto& dzdx = (getHeight(i, right) - getHeight(i, left)) / (step * (right - left));
+         const auto& dzdy = (getHeight(above, j) - getHeight(below, j)) / (step * (below - above));
+
+         const auto& normalLength = std::sqrt(dzdx * dzdx + dzdy * dzdy + 1.0);
+         normals.push_back
+         ({{
+            static_cast<float>(-dzdx / normalLength),
+            static_cast<float>(-dzdy / normalLength),
+            static_cast<float>(1.0 / normalLength)
+         }});
+         const auto& tangentLength = std::sqrt(1.0 + dzdx * dzdx);
+         tangents.push_back({{static_cast<float>(1.0 / tangentLength), 0.0f, static_cast<float>(dzdx / tangentLength), 1.0f}});
+      }
+   }
+
+   // Each cell is split into two triangles, which are wound like the sphere's.
+   std::vector<uint32_t> indices;
+   indices.reserve(6 * n * n);
+   for (uint32_t i = 0; i < n; ++i)
+   {
+      for (uint32_t j = 0; j < n; ++j)
+      {
+         const auto& a = i * (n + 1) + j;
+         const auto& b = a + n + 1;
+         indices.insert(indices.end(), {a, a + 1, b, a + 1, b + 1, b});
+      }
+   }
+
+   std::unique_ptr<Model3D> model3D(new Model3D);
+   model3D->setMesh
+   (
+      positions, normals, texcoords, tangents, indices,
+      {Model3D::Submesh(0, static_cast<uint32_t>(indices.size()), clockwork::graphics::Material())}
+   );
+   return model3D;
+}
+
+
+void
+SceneGenerator::createModel3Ds()
+{
+   // Objects that don't share a 3D model each get their own copy of the mesh, and each
+   // terrain gets its own noise.
+   const auto& uniqueCount = (1.0 - _options.instancingRatio) * _options.objectCount;
+   const auto count = std::max(static_cast<std::size_t>(std::llround(uniqueCount)), static_cast<std::size_t>(1));
+
+   const auto& resolution = _options.meshResolution;
+   _model3Ds.reserve(count);
+   for (std::size_t k = 0; k < count; ++k)
+   {
+      switch (_options.mesh)
+      {
+         case Mesh::Sphere:
+            _model3Ds.push_back(createSphere(2 * resolution, resolution));
+            break;
+         case Mesh::Grid:
+            _model3Ds.push_back(createGrid(resolution));
+            break;
+         case Mesh::Terrain:
+            _model3Ds.push_back(createGrid(resolution, TERRAIN_AMPLITUDE, _options.seed + static_cast<uint32_t>(k)));
+            break;
+      }
+   }
+}
+
+
+void
+SceneGenerator::createObjects()
+{
+   const auto& objectCount = _options.objectCount;
+   const auto& depth = _options.hierarchyDepth;
+
+   // Place the objects along a Z-order curve, then center them and fit them to the grid.
+   std::vector<std::array<uint32_t, 2>> cells(objectCount);
+   std::array<uint32_t, 2> minimum = {{std::numeric_limits<uint32_t>::max(), std::numeric_limits<uint32_t>::max()}};
+   std::array<uint32_t, 2> maximum = {{0, 0}};
+   for (uint32_t i = 0; i < objectCount; ++i)
+   {
+      cells[i] = getMortonCell(i);
+      for (unsigned int axis = 0; axis < 2; ++axis)
+      {
+         minimum[axis] = std::min(minimum[axis], cells[i][axis]);
+         maximum[axis] = std::max(maximum[axis], cells[i][axis]);
+      }
+   }
+   const auto& columnCount = maximum[0] - minimum[0] + 1;
+   const auto& rowCount = maximum[1] - minimum[1] + 1;
+   _spacing = 2.0 * GRID_EXTENT / std::max(columnCount, rowCount);
+
+   std::vector<clockwork::Point3> positions;
+   positions.reserve(objectCount);
+   for (const auto& cell : cells)
+   {
+      positions.emplace_back
+      (
+         _spacing * (cell[0] - minimum[0] + 0.5 - 0.5 * columnCount),
+         _spacing * (cell[1] - minimum[1] + 0.5 - 0.5 * rowCount),
+         0.0
+      );
+   }
+
+   // Every group has the same number of children, except perhaps the last of each level.
+   // Consecutive objects along the curve are grouped together, so each group covers a
+   // compact area of the grid. The groups at a level are found by dividing an object's
+   // index by the number of objects that each of them holds.
+   uint64_t branching = std::max(std::llround(std::pow(objectCount, 1.0 / depth)), 2LL);
+   while (power(branching, depth, objectCount) < objectCount)
+      ++branching;
+   while (branching > 2 && power(branching - 1, depth, objectCount) >= objectCount)
+      --branching;
+
+   // The groups are placed at the center of the objects they hold, and every position is
+   // relative to the parent's.
+   std::vector<std::vector<Object*>> groups(depth);
+   std::vector<std::vector<clockwork::Point3>> centers(depth);
+   groups[0].push_back(_root);
+   centers[0].emplace_back(0.0, 0.0, 0.0);
+   for (uint32_t level = 1; level < depth; ++level)
+   {
+      const auto& size = power(branching, depth - level, objectCount);
+      const auto& groupCount = (objectCount + size - 1) / size;
+
+      std::vector<uint32_t> counts(groupCount, 0);
+      centers[level].assign(groupCount, clockwork::Point3(0.0, 0.0, 0.0));
+      for (uint32_t i = 0; i < objectCount; ++i)
+      {
+         auto& center = centers[level][i / size];
+         center.x += positions[i].x;
+         center.y += positions[i].y;
+         ++counts[i / size];
+      }
+      for (uint64_t g = 0; g < groupCount; ++g)
+      {
+         auto& center = centers[level][g];
+         center.x /= counts[g];
+         center.y /= counts[g];
+
+         const auto& parentIndex = level > 1 ? g / branching : 0;
+         const auto& parentCenter = centers[level - 1][parentIndex];
+         auto* const group = new Object(QString("Group %1.%2").arg(level).arg(g));
+         group->setPosition(center.x - parentCenter.x, center.y - parentCenter.y, 0.0);
+         groups[level - 1][parentIndex]->addChild(group);
+         groups[level].push_back(group);
+         _objects.push_back(group);
+      }
+   }
+
+   const auto& name = getName(_options.mesh);
+   const auto& objectName = name.left(1).toUpper() + name.mid(1) + " %1";
+   const auto& leafGroupSize = depth > 1 ? branching : 1;
+   const auto& scale = 0.4 * _spacing;
+   const auto& isMoving = _options.motion == Motion::Spin || _options.motion == Motion::Orbit || _options.motion == Motion::Scatter;
+   for (uint32_t i = 0; i < objectCount; ++i)
+   {
+      const auto& parentIndex = depth > 1 ? i / leafGroupSize : 0;
+      const auto& parentCenter = centers[depth - 1][parentIndex];
+      const clockwork::Point3 home(positions[i].x - parentCenter.x, positions[i].y - parentCenter.y, 0.0);
+
+      auto* const object = new Object(objectName.arg(i));
+      auto& appearance = static_cast<Appearance&>(object->addProperty(Property::Identifier::Appearance));
+      appearance.setModel3D(_model3Ds[i % _model3Ds.size()].get());
+      object->setPosition(home);
+      object->setScale(scale, scale, scale);
+      groups[depth - 1][parentIndex]->addChild(object);
+      _objects.push_back(object);
+
+      if (isMoving && getRandomValue(_options.seed, RandomStream::Moving, i) < _options.movingRatio)
+      {
+         const clockwork::Point3 destination
+         (
+            SCATTER_EXTENT * (2.0 * getRandomValue(_options.seed, RandomStream::Destination, 2 * i) - 1.0) - parentCenter.x,
+            SCATTER_EXTENT * (2.0 * getRandomValue(_options.seed, RandomStream::Destination, 2 * i + 1) - 1.0) - parentCenter.y,
+            0.0
+         );
+         _movingObjects.push_back({object, home, destination, getRandomValue(_options.seed, RandomStream::Phase, i)});
+      }
+   }
+}
+
+
+void
+SceneGenerator::createLights()
+{
+   if (_options.lightCount == 0)
+      return;
+
+   _lights = new Object("Lights");
+   _root->addChild(_lights);
+   _objects.push_back(_lights);
+
+   // The light sources are evenly spread on a ring around the objects, and each has a
+   // pale random color.
+   for (uint32_t k = 0; k < _options.lightCount; ++k)
+   {
+      const auto& angle = 2.0 * PI * k / _options.lightCount;
+      auto* const light = new Object(QString("Light %1").arg(k));
+      light->setPosition(LIGHT_RING_RADIUS * std::cos(angle), LIGHT_RING_RADIUS * std::sin(angle), 0.0);
+
+      auto& emission = static_cast<LightEmission&>(light->addProperty(Property::Identifier::LightEmission));
+      const auto& channel = [this, k](const uint32_t& c)
+      {
+         return static_cast<float>(0.5 + 0.5 * getRandomValue(_options.seed, RandomStream::LightColor, 3 * k + c));
+      };
+      emission.setColor(clockwork::graphics::ColorRGBA(channel(0), channel(1), channel(2)));
+
+      _lights->addChild(light);
+      _objects.push_back(light);
+   }
+}
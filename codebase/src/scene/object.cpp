@@ -22,7 +22,9 @@
  * THE SOFTWARE.
  */
 #include "scene.hh"
+#include "transform.hierarchy.hh"
 #include "services.hh"
+#include "property.light.emission.hh"
 #include <cassert>
 
 using clockwork::scene::Object;
@@ -34,7 +36,9 @@ _isPruned(false),
 _position(0, 0, 0),
 _rotation(0, 0, 0),
 _scale(1, 1, 1),
-_doModelTransformUpdate(true)
+_doModelTransformUpdate(true),
+_hierarchy(nullptr),
+_hierarchyIndex(0)
 {
    setObjectName(name);
 }
@@ -81,7 +85,7 @@ Object::setPosition(const double& x, const double& y, const double& z)
    _position.x = x;
    _position.y = y;
    _position.z = z;
-   _doModelTransformUpdate = true;
+   invalidateModelTransform();
 }
 
 
@@ -105,7 +109,7 @@ Object::setRotation(const double pitch, const double yaw, const double roll)
    _rotation.i = pitch;
    _rotation.j = yaw;
    _rotation.k = roll;
-   _doModelTransformUpdate = true;
+   invalidateModelTransform();
 }
 
 
@@ -129,12 +133,21 @@ Object::setScale(const double x, const double y, const double z)
    _scale.i = x;
    _scale.j = y;
    _scale.k = z;
+   invalidateModelTransform();
+}
+
+
+void
+Object::invalidateModelTransform()
+{
    _doModelTransformUpdate = true;
+   if (_hierarchy != nullptr)
+      _hierarchy->setDirty(*this);
 }
 
 
 const clockwork::Matrix4&
-Object::getModelTransform()
+Object::getModelTransform() const
 {
    if (_doModelTransformUpdate)
    {
@@ -148,20 +161,7 @@ Object::getModelTransform()
 const clockwork::Matrix4&
 Object::getCMTM() const
 {
-   return _CMTM;
-}
-
-
-void
-Object::updateCMTM()
-{
-   const auto* const parentObject = static_cast<const clockwork::scene::Object*>(parent());
-
-   // Update the CMTM. Note that instead of directy accessing the _modelTransform variable,
-   // getModelTransform() is used to update a possibly "dirty" transformation matrix.
-   const auto& modelTransform = getModelTransform();
-
-   _CMTM = parentObject != nullptr ? parentObject->getCMTM() * modelTransform : modelTransform;
+   return _hierarchy != nullptr ? _hierarchy->getCumulativeTransform(_hierarchyIndex) : getModelTransform();
 }
 
 
@@ -175,7 +175,11 @@ Object::isPruned() const
 void
 Object::setPruned(const bool pruned)
 {
-   _isPruned = pruned;
+   if (_isPruned != pruned)
+   {
+      _isPruned = pruned;
+      clockwork::system::Services::Graphics.invalidateFrame();
+   }
 }
 
 
@@ -186,6 +190,8 @@ Object::addChild(Object* const child)
    {
       _children << child;
       child->setParent(this);
+      if (_hierarchy != nullptr)
+         _hierarchy->setTopologyDirty();
    }
 }
 
@@ -196,7 +202,9 @@ Object::removeChild(Object* const child)
    if (child != nullptr)
    {
       _children.remove(child);
-      setParent(nullptr);
+      if (_hierarchy != nullptr)
+         _hierarchy->detach(*child);
+      child->setParent(nullptr);
       child->deleteLater();
    }
 }
@@ -227,6 +235,9 @@ Object::addProperty(const Property::Identifier& identifier)
       case Property::Identifier::Appearance:
          property = new Appearance(*this);
          break;
+      case Property::Identifier::LightEmission:
+         property = new LightEmission(*this);
+         break;
       default:
          assert(false);
          break;
@@ -23,6 +23,7 @@
  */
 #include "property.appearance.hh"
 #include "services.hh"
+#include "scene.object.hh"
 #include <cassert>
 
 using clockwork::scene::Appearance;
@@ -45,6 +46,7 @@ void
 Appearance::setModel3D(const clockwork::graphics::Model3D* const model3D)
 {
    _model3D = model3D;
+   getProprietor().invalidateModelTransform();
 }
 
 
@@ -52,6 +54,7 @@ void
 Appearance::setModel3D(const QString& filename)
 {
    _model3D = clockwork::system::Services::Resource.loadModel3D(filename);
+   getProprietor().invalidateModelTransform();
 }
 
 
@@ -69,3 +72,17 @@ Appearance::setMaterial(const clockwork::graphics::Material&& material)
    //TODO Test move semantics.
    _material = material;
 }
+
+
+std::size_t
+Appearance::getLevelOfDetail(const clockwork::scene::Viewer& viewer) const
+{
+   return _levelsOfDetail.value(&viewer, 0);
+}
+
+
+void
+Appearance::setLevelOfDetail(const clockwork::scene::Viewer& viewer, const std::size_t& level) const
+{
+   _levelsOfDetail.insert(&viewer, level);
+}
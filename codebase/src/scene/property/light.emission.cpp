@@ -21,36 +21,42 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
-#include "task.render.hh"
-#include "services.hh"
-#include "scene.hh"
+#include "property.light.emission.hh"
+#include <algorithm>
 
-using clockwork::concurrency::RenderTask;
+using clockwork::scene::LightEmission;
 
 
-RenderTask::RenderTask(const int priority) :
-Task(priority)
+LightEmission::LightEmission(clockwork::scene::Object& proprietor) :
+Property(proprietor, "Light Emission", Property::Identifier::LightEmission),
+_color(1.0f, 1.0f, 1.0f),
+_intensity(1.0f)
+{}
+
+
+const clockwork::graphics::ColorRGBA&
+LightEmission::getColor() const
 {
-   connect
-   (
-      this, SIGNAL(completed()),
-      &clockwork::system::Services::Graphics.getFramebuffer(), SIGNAL(frameReady())
-   );
+   return _color;
 }
 
 
 void
-RenderTask::run()
+LightEmission::setColor(const clockwork::graphics::ColorRGBA& color)
 {
-   using clockwork::system::Services;
+   _color = color;
+}
 
-   auto& scene = clockwork::scene::Scene::getInstance();
 
-   Services::Graphics.getFramebuffer().clear();
-   Services::Graphics.renderObject(scene.getGraph());
+const float&
+LightEmission::getIntensity() const
+{
+   return _intensity;
+}
 
-   for (auto* const viewer : scene.getActiveViewers())
-      Services::Graphics.postProcess(viewer->getImageFilter(), viewer->getViewport());
 
-   emit completed();
+void
+LightEmission::setIntensity(const float& intensity)
+{
+   _intensity = std::max(intensity, 0.0f);
 }
@@ -22,18 +22,23 @@
  * THE SOFTWARE.
  */
 #include "scene.hh"
+#include "scene.snapshot.hh"
 #include "services.hh"
 #include "predefs.hh"
 #include "camera.hh"
+#include <atomic>
 #include <cassert>
 
 using clockwork::scene::Scene;
 using clockwork::scene::Viewer;
+using clockwork::scene::SceneSnapshot;
 
 
 Scene::Scene() :
 QAbstractItemModel(nullptr),
 _graph(new Object("Default Scene Graph")),
+_transformHierarchy(*_graph),
+_snapshotSequence(0),
 _doViewportUpdate(true)
 {
    assert(_graph != nullptr);
@@ -71,6 +76,20 @@ Scene::getGraph()
 }
 
 
+clockwork::scene::TransformHierarchy&
+Scene::getTransformHierarchy()
+{
+   return _transformHierarchy;
+}
+
+
+clockwork::scene::BoundingVolumeHierarchy&
+Scene::getBoundingVolumeHierarchy()
+{
+   return _boundingVolumeHierarchy;
+}
+
+
 const QSet<Viewer*>&
 Scene::getActiveViewers()
 {
@@ -105,6 +124,32 @@ Scene::hasActiveViewers() const
 }
 
 
+std::shared_ptr<const SceneSnapshot>
+Scene::captureSnapshot()
+{
+   // A reader that loaded the spare snapshot before it was replaced may still be using
+   // it, in which case a new snapshot is allocated. Otherwise, the reader's last accesses
+   // must happen before the snapshot is overwritten.
+   auto snapshot = std::move(_spareSnapshot);
+   if (snapshot == nullptr || snapshot.use_count() > 1)
+      snapshot = std::make_shared<SceneSnapshot>();
+   else
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+   snapshot->capture(*this, ++_snapshotSequence);
+   _spareSnapshot = std::atomic_exchange(&_snapshot, snapshot);
+
+   return snapshot;
+}
+
+
+std::shared_ptr<const SceneSnapshot>
+Scene::getSnapshot() const
+{
+   return std::atomic_load(&_snapshot);
+}
+
+
 void
 Scene::updateViewports()
 {
@@ -0,0 +1,175 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "scene.snapshot.hh"
+#include "scene.hh"
+#include "scene.viewer.hh"
+#include "property.appearance.hh"
+#include <cassert>
+
+using clockwork::scene::SceneSnapshot;
+using clockwork::scene::ViewerSnapshot;
+
+
+constexpr int32_t SceneSnapshot::NOT_CAPTURED;
+constexpr int32_t SceneSnapshot::NOT_RENDERABLE;
+
+
+void
+ViewerSnapshot::capture(clockwork::scene::Viewer& viewer)
+{
+   key = &viewer;
+   position = viewer.getPosition();
+   viewpoint = viewer.getCMTM() * clockwork::Point3(0, 0, 0);
+   VIEW = viewer.getViewTransform();
+   PROJECTION = viewer.getProjectionTransform();
+   VIEWPROJECTION = viewer.getViewProjectionTransform();
+   viewport = viewer.getViewport();
+   renderAlgorithm = viewer.getRenderAlgorithm();
+   primitiveMode = viewer.getPrimitiveMode();
+   lineAlgorithm = viewer.getLineAlgorithm();
+   imageFilter = viewer.getImageFilter();
+}
+
+
+SceneSnapshot::SceneSnapshot() :
+_sequence(0),
+_topologyRevision(0)
+{}
+
+
+const uint64_t&
+SceneSnapshot::getSequence() const
+{
+   return _sequence;
+}
+
+
+const uint64_t&
+SceneSnapshot::getTopologyRevision() const
+{
+   return _topologyRevision;
+}
+
+
+const std::vector<clockwork::scene::ObjectSnapshot>&
+SceneSnapshot::getObjects() const
+{
+   return _objects;
+}
+
+
+const std::vector<ViewerSnapshot>&
+SceneSnapshot::getViewers() const
+{
+   return _viewers;
+}
+
+
+const std::vector<uint32_t>&
+SceneSnapshot::getChangedObjects() const
+{
+   return _changedObjects;
+}
+
+
+void
+SceneSnapshot::capture(clockwork::scene::Scene& scene, const uint64_t& sequence)
+{
+   const auto& hierarchy = scene.getTransformHierarchy();
+   const auto& bvh = scene.getBoundingVolumeHierarchy();
+   const auto& viewers = scene.getActiveViewers();
+
+   _sequence = sequence;
+   _topologyRevision = hierarchy.getTopologyRevision();
+   _objects.clear();
+   _changedObjects.clear();
+   _indices.assign(hierarchy.size(), NOT_CAPTURED);
+
+   // Only the objects that a viewer can see are captured. Resizing the viewer array
+   // rather than clearing it keeps the memory of each viewer's list of visible objects.
+   _viewers.resize(viewers.size());
+   auto viewerSnapshot = _viewers.begin();
+   for (auto* const viewer : viewers)
+   {
+      viewerSnapshot->capture(*viewer);
+      viewerSnapshot->visibleObjects.clear();
+
+      auto& visibleObjects = viewerSnapshot->visibleObjects;
+      const clockwork::graphics::BoundingFrustum frustum(viewerSnapshot->VIEWPROJECTION);
+      bvh.query(frustum, [this, &scene, &visibleObjects](Object& object)
+      {
+         if (!object.isPruned())
+         {
+            const auto& index = add(scene, object);
+            if (index >= 0)
+               visibleObjects.push_back(static_cast<uint32_t>(index));
+         }
+      });
+      ++viewerSnapshot;
+   }
+
+   // The objects that have moved are captured too, even if they are no longer visible,
+   // since the part of the image they used to cover needs to be redrawn.
+   for (const auto& i : hierarchy.getChangedObjects())
+   {
+      const auto& object = hierarchy.getObject(i);
+      if (!object.isPruned())
+      {
+         const auto& index = add(scene, object);
+         if (index >= 0)
+            _changedObjects.push_back(static_cast<uint32_t>(index));
+      }
+   }
+}
+
+
+int32_t
+SceneSnapshot::add(clockwork::scene::Scene& scene, const Object& object)
+{
+   const auto& hierarchy = scene.getTransformHierarchy();
+   const auto& i = hierarchy.getIndex(object);
+
+   auto& index = _indices[i];
+   if (index == NOT_CAPTURED)
+   {
+      const auto* const appearance =
+      static_cast<const Appearance*>(object.getProperty(Property::Identifier::Appearance));
+      const auto* const model3D = appearance != nullptr ? appearance->getModel3D() : nullptr;
+      if (model3D == nullptr || model3D->isEmpty())
+         index = NOT_RENDERABLE;
+      else
+      {
+         index = static_cast<int32_t>(_objects.size());
+         _objects.push_back
+         ({
+            &object,
+            model3D,
+            appearance->getMaterial(),
+            hierarchy.getCumulativeTransform(i),
+            BoundingVolumeHierarchy::getBoundingBox(object)
+         });
+      }
+   }
+   return index;
+}
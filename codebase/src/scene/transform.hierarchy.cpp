@@ -0,0 +1,264 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "transform.hierarchy.hh"
+#include "scene.object.hh"
+#include "services.hh"
+#include <algorithm>
+#include <cassert>
+
+using clockwork::scene::TransformHierarchy;
+
+
+constexpr uint8_t TransformHierarchy::LOCAL_DIRTY;
+constexpr uint8_t TransformHierarchy::CUMULATIVE_DIRTY;
+constexpr std::size_t TransformHierarchy::NO_DIRTY_INDEX;
+constexpr std::size_t TransformHierarchy::UPDATE_GRAIN;
+
+
+TransformHierarchy::TransformHierarchy(Object& root) :
+_root(root),
+_firstDirtyIndex(NO_DIRTY_INDEX),
+_topologyRevision(0),
+_isTopologyDirty(true)
+{}
+
+
+std::size_t
+TransformHierarchy::size() const
+{
+   return _objects.size();
+}
+
+
+clockwork::scene::Object&
+TransformHierarchy::getObject(const std::size_t& index) const
+{
+   assert(index < _objects.size());
+   return *_objects[index];
+}
+
+
+std::size_t
+TransformHierarchy::getIndex(const clockwork::scene::Object& object) const
+{
+   assert(object._hierarchy == this && object._hierarchyIndex < _objects.size());
+   return object._hierarchyIndex;
+}
+
+
+const int32_t&
+TransformHierarchy::getParent(const std::size_t& index) const
+{
+   assert(index < _parents.size());
+   return _parents[index];
+}
+
+
+std::size_t
+TransformHierarchy::getLevelCount() const
+{
+   return _levels.empty() ? 0 : _levels.size() - 1;
+}
+
+
+const clockwork::Matrix4&
+TransformHierarchy::getCumulativeTransform(const std::size_t& index) const
+{
+   assert(index < _cumulativeTransforms.size());
+   return _cumulativeTransforms[index];
+}
+
+
+const std::vector<std::size_t>&
+TransformHierarchy::getChangedObjects() const
+{
+   return _changedObjects;
+}
+
+
+const uint64_t&
+TransformHierarchy::getTopologyRevision() const
+{
+   return _topologyRevision;
+}
+
+
+void
+TransformHierarchy::setDirty(const Object& object)
+{
+   QMutexLocker locker(&_pendingMutex);
+   _pendingObjects.push_back(&object);
+}
+
+
+void
+TransformHierarchy::setTopologyDirty()
+{
+   QMutexLocker locker(&_pendingMutex);
+   _isTopologyDirty = true;
+}
+
+
+void
+TransformHierarchy::detach(Object& object)
+{
+   if (object._hierarchy == this)
+   {
+      object._hierarchy = nullptr;
+      for (auto* const child : object.getChildren())
+         detach(*child);
+
+      setTopologyDirty();
+   }
+}
+
+
+void
+TransformHierarchy::rebuild()
+{
+   _objects.clear();
+   _parents.clear();
+   _levels.clear();
+
+   // Traverse the scene graph in breadth-first order so that every parent is stored
+   // before its children, and objects at the same depth are stored contiguously.
+   // The object array doubles as the traversal queue.
+   _objects.push_back(&_root);
+   _parents.push_back(-1);
+   _levels.push_back(0);
+   while (_levels.back() < _objects.size())
+   {
+      const auto levelBegin = _levels.back();
+      const auto levelEnd = _objects.size();
+      for (auto i = levelBegin; i < levelEnd; ++i)
+      {
+         auto& object = *_objects[i];
+         object._hierarchy = this;
+         object._hierarchyIndex = i;
+
+         for (auto* const child : object.getChildren())
+         {
+            _objects.push_back(child);
+            _parents.push_back(static_cast<int32_t>(i));
+         }
+      }
+      _levels.push_back(levelEnd);
+   }
+
+   const auto& count = _objects.size();
+   _localTransforms.resize(count);
+   _cumulativeTransforms.resize(count);
+   _dirty.assign(count, LOCAL_DIRTY);
+
+   _firstDirtyIndex = 0;
+   _isTopologyDirty = false;
+   ++_topologyRevision;
+}
+
+
+void
+TransformHierarchy::update()
+{
+   // Apply the changes that were signalled since the last update began. This is done while
+   // the lock is held, since an object can't be detached and destroyed without flagging
+   // the topology first. Rebuilding the hierarchy marks every object as dirty, in which
+   // case the pending objects are simply discarded.
+   {
+      QMutexLocker locker(&_pendingMutex);
+      if (_isTopologyDirty)
+         rebuild();
+      else
+      {
+         for (const auto* const object : _pendingObjects)
+         {
+            if (object->_hierarchy == this)
+            {
+               const auto index = object->_hierarchyIndex;
+               _dirty[index] |= LOCAL_DIRTY;
+               _firstDirtyIndex = std::min(_firstDirtyIndex, index);
+            }
+         }
+      }
+      _pendingObjects.clear();
+   }
+   _changedObjects.clear();
+
+   const auto& count = _objects.size();
+   if (_firstDirtyIndex >= count)
+      return;
+
+   // Sweep over the depth levels that follow the first dirty object. Since parents precede
+   // their children, a change is propagated to an entire subtree in a single pass. Objects
+   // in the same level only read their parents' transforms, which belong to the previous
+   // level, so each level can be split across the thread pool.
+   for (std::size_t level = 0; level + 1 < _levels.size(); ++level)
+   {
+      const auto begin = std::max(_levels[level], _firstDirtyIndex);
+      const auto& end = _levels[level + 1];
+      if (begin < end)
+      {
+         clockwork::system::Services::Concurrency.parallelFor(end - begin, UPDATE_GRAIN,
+         [this, begin](const std::size_t& first, const std::size_t& last)
+         {
+            update(begin + first, begin + last);
+         });
+      }
+   }
+   // Record the objects that have changed, then reset the dirty flags.
+   for (auto i = _firstDirtyIndex; i < count; ++i)
+   {
+      if (_dirty[i] != 0)
+      {
+         _changedObjects.push_back(i);
+         _dirty[i] = 0;
+      }
+   }
+   _firstDirtyIndex = NO_DIRTY_INDEX;
+}
+
+
+void
+TransformHierarchy::update(const std::size_t& begin, const std::size_t& end)
+{
+   // An object's cumulative transform is only recalculated if its local transform or
+   // its parent's cumulative transform has changed.
+   for (auto i = begin; i < end; ++i)
+   {
+      auto& dirty = _dirty[i];
+      const auto& parent = _parents[i];
+      const auto& isParentDirty = parent >= 0 && (_dirty[parent] & CUMULATIVE_DIRTY) != 0;
+
+      if (dirty != 0 || isParentDirty)
+      {
+         auto& localTransform = _localTransforms[i];
+         if (dirty & LOCAL_DIRTY)
+            localTransform = _objects[i]->getModelTransform();
+
+         _cumulativeTransforms[i] =
+         parent >= 0 ? _cumulativeTransforms[parent] * localTransform : localTransform;
+
+         dirty = CUMULATIVE_DIRTY;
+      }
+   }
+}
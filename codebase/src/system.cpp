@@ -23,8 +23,10 @@
  */
 #include "system.hh"
 #include "scene.hh"
-#include "task.update.hh"
+#include "predefs.hh"
+#include "profiler.hh"
 #include <cassert>
+#include <cmath>
 
 using clockwork::System;
 using clockwork::system::Services;
@@ -36,7 +38,8 @@ static QList<clockwork::system::Subsystem*> allSubsystems =
 
 
 System::System(int& argc, char** argv) :
-QApplication(argc, argv)
+QApplication(argc, argv),
+_sceneTime(0.0)
 {
    Services::ExecutionContext =
    parseCommandLineArguments(const_cast<const int&>(argc), const_cast<const char**>(argv));
@@ -47,8 +50,17 @@ QApplication(argc, argv)
 
 System::~System()
 {
+   _sceneGenerator.reset();
+
    for (auto* const subsystem : allSubsystems)
       subsystem->destroy();
+
+#ifdef CLOCKWORK_PROFILER
+   // Export the most recent events if a trace file was requested.
+   const auto& traceFilename = qgetenv("CLOCKWORK_TRACE");
+   if (!traceFilename.isEmpty() && !clockwork::system::Profiler::getInstance().exportChromeTrace(QString::fromLocal8Bit(traceFilename)))
+      std::cerr << "Could not write the trace to '" << traceFilename.constData() << "'." << std::endl;
+#endif
 }
 
 
@@ -62,6 +74,13 @@ System::initialise()
       if (error != clockwork::Error::None)
          return error;
    }
+
+   // A generated scene replaces the default one when it is described by the environment,
+   // e.g. CLOCKWORK_SCENE="objects=10000,depth=3,mesh=terrain,motion=orbit".
+   const auto& sceneDescription = qgetenv("CLOCKWORK_SCENE");
+   if (!sceneDescription.isEmpty())
+      generateScene(QString::fromLocal8Bit(sceneDescription));
+
    return _window.open(false);
 }
 
@@ -69,16 +88,38 @@ System::initialise()
 void
 System::update()
 {
-   static const int timeout = 100;
+   _frameLoop.requestFrame();
+}
+
 
-   // Coalesce update calls into a single one. The actual update is found in
-   // the timerEvent member function, and is triggered when _coalescer expires.
-   if (!_coalescer.isActive())
-      _coalescer.start(timeout, this);
-   else if (_coalescer.isActive())
+void
+System::step(const double& timestep)
+{
+   _sceneTime = std::fmod(_sceneTime + timestep / SCENE_MOTION_PERIOD, 1.0);
+   _sceneGenerator->animate(_sceneTime);
+}
+
+
+void
+System::generateScene(const QString& description)
+{
+   using clockwork::scene::SceneGenerator;
+
+   SceneGenerator::Options options;
+   if (!SceneGenerator::parse(description, options, std::cerr))
+   {
+      std::cerr << "The default scene is drawn instead." << std::endl;
+      return;
+   }
+
+   clockwork::scene::predefs::Suzanne::getInstance().setPruned(true);
+   _sceneGenerator.reset(new SceneGenerator(options, clockwork::scene::Scene::getInstance().getGraph()));
+
+   // A moving scene is animated by the simulation's timesteps, so it is drawn continuously.
+   if (options.motion != SceneGenerator::Motion::Static)
    {
-      _coalescer.stop();
-      _coalescer.start(timeout, this);
+      connect(&_frameLoop, SIGNAL(stepped(const double&)), this, SLOT(step(const double&)));
+      _frameLoop.setContinuous(true);
    }
 }
 
@@ -92,16 +133,3 @@ System::parseCommandLineArguments(const int& argc, const char** argv)
    return clockwork::system::ExecutionContext();
 }
 
-
-void
-System::timerEvent(QTimerEvent* const e)
-{
-   if (e->timerId() == _coalescer.timerId())
-   {
-      _coalescer.stop();
-
-      // Remove all outdated tasks and start afresh.
-      Services::Concurrency.purgeTasks();
-      Services::Concurrency.submitTask(new clockwork::concurrency::UpdateTask);
-   }
-}
@@ -22,6 +22,11 @@
  * THE SOFTWARE.
  */
 #include "debug.hh"
+#include "profiler.hh"
+#include "services.hh"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 
 
 bool clockwork::system::Debug::printToDisplay = true;
@@ -30,5 +35,42 @@ bool clockwork::system::Debug::printToDisplay = true;
 std::string
 clockwork::system::Debug::toString()
 {
-   return "TODO::DEBUG INFORMATION";
+   std::ostringstream stream;
+#ifdef CLOCKWORK_PROFILER
+   using clockwork::system::Profiler;
+
+   // Average the most recent frames, so that the numbers are readable.
+   constexpr std::size_t AVERAGED_FRAME_COUNT = 60;
+   const auto& history = Profiler::getInstance().getFrameHistory();
+   if (!history.empty())
+   {
+      const auto count = std::min(history.size(), AVERAGED_FRAME_COUNT);
+      Profiler::FrameRecord average = {};
+      for (auto it = history.end() - count; it != history.end(); ++it)
+      {
+         average.frameTime += it->frameTime / count;
+         for (std::size_t i = 0; i < Profiler::STAGE_COUNT; ++i)
+            average.stageTimes[i] += it->stageTimes[i] / count;
+      }
+
+      stream << std::fixed << std::setprecision(2);
+      stream << "Frame: " << average.frameTime << " ms (" << (average.frameTime > 0.0 ? 1000.0 / average.frameTime : 0.0) << " fps)";
+      for (std::size_t i = 0; i < Profiler::STAGE_COUNT; ++i)
+         stream << "\n" << Profiler::getName(static_cast<Profiler::Stage>(i)) << ": " << average.stageTimes[i] << " ms";
+   }
+   else
+      stream << "No frame has been profiled.";
+#else
+   stream << "The profiler is disabled. Build with CONFIG+=profiler to enable it.";
+#endif
+
+   // The pipeline statistics of the last frame, which only count what was redrawn.
+   const auto& statistics = clockwork::system::Services::Graphics.getFrameStatistics();
+   stream << "\n\nVertices: " << statistics.verticesIn << " in, " << statistics.vertexCacheHits << " cache hits";
+   stream << "\nPrimitives: " << statistics.primitivesAssembled << " assembled, " << statistics.primitivesClipped << " clipped";
+   stream << "\nCulled: " << statistics.backfaceCulled << " backface, " << statistics.frustumCulled << " frustum, " << statistics.occlusionCulled << " occlusion";
+   stream << "\nFragments: " << statistics.fragmentsGenerated << " generated, " << statistics.fragmentsDepthRejected << " depth-rejected";
+   stream << "\nShaded: " << statistics.fragmentsShaded << " fragments, " << statistics.fragmentsWritten << " written";
+
+   return stream.str();
 }
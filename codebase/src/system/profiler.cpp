@@ -0,0 +1,325 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Jeremy Othieno.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "profiler.hh"
+
+#ifdef CLOCKWORK_PROFILER
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+using clockwork::system::Profiler;
+
+
+constexpr std::size_t Profiler::STAGE_COUNT;
+constexpr std::size_t Profiler::HISTORY_LENGTH;
+constexpr std::size_t Profiler::EventBuffer::CAPACITY;
+
+
+namespace {
+/**
+ * Return the calling thread's name.
+ * @param index the thread's position in the order threads started recording events.
+ */
+QString
+getThreadName(const uint32_t& index)
+{
+   auto* const thread = QThread::currentThread();
+   if (!thread->objectName().isEmpty())
+      return thread->objectName();
+
+   const auto* const application = QCoreApplication::instance();
+   if (application != nullptr && thread == application->thread())
+      return "Main thread";
+
+   return QString("Thread %1").arg(index);
+}
+} // namespace
+
+
+Profiler::Scope::Scope(const Profiler::Stage& stage) :
+_profiler(Profiler::getInstance()),
+_stage(stage),
+_begin(Profiler::now())
+{}
+
+
+Profiler::Scope::~Scope()
+{
+   _profiler.record(_stage, _begin, Profiler::now());
+}
+
+
+Profiler::AccumulatingScope::AccumulatingScope(const Profiler::Stage& stage) :
+_profiler(Profiler::getInstance()),
+_stage(stage),
+_begin(Profiler::now())
+{}
+
+
+Profiler::AccumulatingScope::~AccumulatingScope()
+{
+   _profiler.accumulate(_stage, Profiler::now() - _begin);
+}
+
+
+Profiler::EventBuffer::EventBuffer(const uint32_t& t, const QString& n) :
+head(0),
+hasPendingTime(false),
+cursor(0),
+thread(t),
+name(n),
+next(nullptr)
+{
+   pending.fill(0);
+}
+
+
+void
+Profiler::EventBuffer::push(const Profiler::Event& event)
+{
+   // The buffer only has one writer, so the head doesn't need to be incremented atomically.
+   // It is published after the event is written, so readers never see an unwritten event.
+   const auto& position = head.load(std::memory_order_relaxed);
+   events[position & (CAPACITY - 1)] = event;
+   head.store(position + 1, std::memory_order_release);
+}
+
+
+uint64_t
+Profiler::EventBuffer::read(uint64_t from, std::vector<Profiler::Event>& output) const
+{
+   const auto& end = head.load(std::memory_order_acquire);
+   from = std::max(from, end > CAPACITY ? end - CAPACITY : static_cast<uint64_t>(0));
+
+   output.clear();
+   for (auto i = from; i < end; ++i)
+      output.push_back(events[i & (CAPACITY - 1)]);
+
+   // The writer may have wrapped around while the events were copied, in which case the
+   // oldest copies are unreliable and discarded.
+   std::atomic_thread_fence(std::memory_order_acquire);
+   const auto& written = head.load(std::memory_order_relaxed);
+   if (written > from + CAPACITY)
+   {
+      const auto overwritten = std::min<uint64_t>(written - CAPACITY - from, output.size());
+      output.erase(output.begin(), output.begin() + overwritten);
+   }
+   return end;
+}
+
+
+Profiler::Profiler() :
+_epoch(now()),
+_buffers(nullptr),
+_threadCount(0),
+_lastFrameTime(_epoch)
+{}
+
+
+Profiler::~Profiler()
+{
+   auto* buffer = _buffers.load();
+   while (buffer != nullptr)
+   {
+      auto* const next = buffer->next;
+      delete buffer;
+      buffer = next;
+   }
+}
+
+
+Profiler&
+Profiler::getInstance()
+{
+   static Profiler INSTANCE;
+   return INSTANCE;
+}
+
+
+int64_t
+Profiler::now()
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+const char*
+Profiler::getName(const Profiler::Stage& stage)
+{
+   switch (stage)
+   {
+      case Stage::Update:
+         return "Update";
+      case Stage::Culling:
+         return "Culling";
+      case Stage::Vertex:
+         return "Vertex";
+      case Stage::Setup:
+         return "Setup";
+      case Stage::Raster:
+         return "Raster";
+      case Stage::Fragment:
+         return "Fragment";
+      case Stage::Post:
+         return "Post";
+      case Stage::Present:
+         return "Present";
+      default:
+         return "Unknown";
+   }
+}
+
+
+Profiler::EventBuffer&
+Profiler::getEventBuffer()
+{
+   thread_local EventBuffer* buffer = nullptr;
+   if (buffer == nullptr)
+   {
+      const auto& thread = _threadCount++;
+      buffer = new EventBuffer(thread, getThreadName(thread));
+
+      // Push the buffer onto the front of the list.
+      buffer->next = _buffers.load(std::memory_order_relaxed);
+      while (!_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+   }
+   return *buffer;
+}
+
+
+void
+Profiler::record(const Profiler::Stage& stage, const int64_t& begin, const int64_t& end)
+{
+   auto& buffer = getEventBuffer();
+   if (!buffer.hasPendingTime)
+   {
+      buffer.push({begin, end, stage});
+      return;
+   }
+
+   // The accumulated stages were interleaved with this one, so they are laid out one after
+   // the other at the end of the event.
+   int64_t pendingTime = 0;
+   for (const auto& time : buffer.pending)
+      pendingTime += time;
+
+   auto cursor = std::max(begin, end - pendingTime);
+   buffer.push({begin, cursor, stage});
+   for (std::size_t i = 0; i < STAGE_COUNT; ++i)
+   {
+      auto& time = buffer.pending[i];
+      if (time > 0)
+      {
+         buffer.push({cursor, cursor + time, static_cast<Stage>(i)});
+         cursor += time;
+         time = 0;
+      }
+   }
+   buffer.hasPendingTime = false;
+}
+
+
+void
+Profiler::accumulate(const Profiler::Stage& stage, const int64_t& duration)
+{
+   auto& buffer = getEventBuffer();
+   buffer.pending[static_cast<std::size_t>(stage)] += duration;
+   buffer.hasPendingTime = true;
+}
+
+
+void
+Profiler::onFrameCompleted()
+{
+   QMutexLocker locker(&_historyMutex);
+
+   const auto& time = now();
+   FrameRecord frame;
+   frame.frameTime = 1e-6 * (time - _lastFrameTime);
+   frame.stageTimes.fill(0.0);
+   _lastFrameTime = time;
+
+   std::vector<Event> events;
+   for (auto* buffer = _buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next)
+   {
+      buffer->cursor = buffer->read(buffer->cursor, events);
+      for (const auto& event : events)
+         frame.stageTimes[static_cast<std::size_t>(event.stage)] += 1e-6 * (event.end - event.begin);
+   }
+
+   _history.push_back(frame);
+   if (_history.size() > HISTORY_LENGTH)
+      _history.pop_front();
+}
+
+
+std::vector<Profiler::FrameRecord>
+Profiler::getFrameHistory() const
+{
+   QMutexLocker locker(&_historyMutex);
+   return std::vector<FrameRecord>(_history.begin(), _history.end());
+}
+
+
+bool
+Profiler::exportChromeTrace(const QString& filename) const
+{
+   QFile file(filename);
+   if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+      return false;
+
+   // Timestamps and durations are in microseconds, relative to the profiler's instantiation.
+   QTextStream stream(&file);
+   stream.setRealNumberNotation(QTextStream::FixedNotation);
+   stream.setRealNumberPrecision(3);
+   stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+   auto isFirst = true;
+   std::vector<Event> events;
+   for (auto* buffer = _buffers.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next)
+   {
+      stream << (isFirst ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+             << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+      isFirst = false;
+
+      buffer->read(0, events);
+      for (const auto& event : events)
+      {
+         stream << ",\n{\"name\":\"" << getName(event.stage) << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+                << ",\"ts\":" << 1e-3 * (event.begin - _epoch) << ",\"dur\":" << 1e-3 * (event.end - event.begin) << "}";
+      }
+   }
+   stream << "\n]}\n";
+   stream.flush();
+
+   return stream.status() == QTextStream::Ok;
+}
+
+#endif // CLOCKWORK_PROFILER
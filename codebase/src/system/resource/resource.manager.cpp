@@ -23,14 +23,21 @@
  */
 #include "resource.manager.hh"
 #include <QFileInfo>
+#include <QDir>
+#include <QStandardPaths>
+#include <QStringList>
 #include "file.reader.hh"
+#include "model3d.cache.hh"
 #include <cassert>
 
 using clockwork::system::ResourceManager;
 
 
 ResourceManager::ResourceManager() :
-_hashGenerator(QCryptographicHash::Sha1)
+_hashGenerator(QCryptographicHash::Sha1),
+_isMeshOptimisationEnabled(true),
+_isLevelOfDetailGenerationEnabled(true),
+_isModelCacheEnabled(true)
 {}
 
 
@@ -46,13 +53,8 @@ ResourceManager::loadModel3D(const QString& filename)
       QFile file(filename);
       if (file.open(QIODevice::ReadOnly))
       {
-         // Calculate the file's hash.
-         _hashGenerator.reset();
-         while (!file.atEnd())
-            _hashGenerator.addData(file.read(8192));
-
          // If the file has been loaded, then return the loaded instance.
-         const auto& key = QString(_hashGenerator.result().toHex());
+         const auto& key = hash(file);
          if (_resources.contains(key))
             output = static_cast<clockwork::graphics::Model3D*>(_resources.value(key));
          else
@@ -62,11 +64,80 @@ ResourceManager::loadModel3D(const QString& filename)
             output = new clockwork::graphics::Model3D;
             assert(output != nullptr);
 
-            // The input file cursor needs rewound to the beginning of the file since
-            // it's currently at the end of the file.
-            assert(file.reset());
+            // Importing a model is expensive, so try the model cache first.
+            const auto& cacheFilename = getModelCacheFilename(key, hashMaterialLibraries(file));
+            auto error = clockwork::Error::Unknown;
+            if (_isModelCacheEnabled && QFileInfo::exists(cacheFilename))
+            {
+               QFile cacheFile(cacheFilename);
+               error = clockwork::io::readModel3DCache(cacheFile, *output);
+            }
+
+            if (error != clockwork::Error::None)
+            {
+               // The input file cursor needs rewound to the beginning of the file since
+               // it's currently at the end of the file.
+               file.reset();
+
+               error = clockwork::io::loadOBJ(file, *output);
+               if (error == clockwork::Error::None)
+               {
+                  if (_isLevelOfDetailGenerationEnabled)
+                     output->generateLevelsOfDetail();
+                  if (_isMeshOptimisationEnabled)
+                     output->optimize();
+
+                  if (_isModelCacheEnabled && QDir().mkpath(QFileInfo(cacheFilename).path()))
+                  {
+                     QFile cacheFile(cacheFilename);
+                     const auto& cacheError = clockwork::io::writeModel3DCache(cacheFile, *output);
+                     if (cacheError != clockwork::Error::None)
+                        std::cout << "Warning! Could not save the model cache. " << cacheError << std::endl;
+                  }
+               }
+            }
+
+            if (error != clockwork::Error::None)
+            {
+               delete output;
+               output = nullptr;
+
+               std::cout << error << std::endl;
+            }
+            else
+               _resources.insert(key, output);
+         }
+      }
+   }
+   return output;
+}
+
+
+const clockwork::graphics::MaterialLibrary*
+ResourceManager::loadMaterialLibrary(const QString& filename)
+{
+   clockwork::graphics::MaterialLibrary* output = nullptr;
+
+   // Check if the file exists and can be read.
+   const QFileInfo info(filename);
+   if (info.exists() && info.isFile() && info.isReadable() && info.size())
+   {
+      QFile file(filename);
+      if (file.open(QIODevice::ReadOnly))
+      {
+         // If the file has been loaded, then return the loaded instance.
+         const auto& key = hash(file);
+         if (_resources.contains(key))
+            output = static_cast<clockwork::graphics::MaterialLibrary*>(_resources.value(key));
+         else
+         {
+            output = new clockwork::graphics::MaterialLibrary;
+            assert(output != nullptr);
+
+            // Rewind the file cursor since hashing left it at the end of the file.
+            file.reset();
 
-            auto error = clockwork::io::loadOBJ(file, *output);
+            auto error = clockwork::io::loadMTL(file, *output);
             if (error != clockwork::Error::None)
             {
                delete output;
@@ -81,3 +152,95 @@ ResourceManager::loadModel3D(const QString& filename)
    }
    return output;
 }
+
+
+QString
+ResourceManager::hash(QFile& file)
+{
+   _hashGenerator.reset();
+   while (!file.atEnd())
+      _hashGenerator.addData(file.read(8192));
+
+   return QString(_hashGenerator.result().toHex());
+}
+
+
+QString
+ResourceManager::hashMaterialLibraries(QFile& file)
+{
+   // The libraries are found the same way the OBJ reader finds them. A library that
+   // can't be read still changes the hash, so that the model is imported again once
+   // the library can be read.
+   QStringList hashes;
+   file.reset();
+   while (!file.atEnd())
+   {
+      const auto& tokens = file.readLine().simplified().split(' ');
+      if (tokens.size() > 1 && tokens.first() == "mtllib")
+      {
+         QFile library(QFileInfo(file).canonicalPath().append("/").append(QString::fromUtf8(tokens[1])));
+         hashes << (library.open(QIODevice::ReadOnly) ? hash(library) : QString("unreadable"));
+      }
+   }
+   file.reset();
+
+   if (hashes.isEmpty())
+      return QString();
+
+   return QString(QCryptographicHash::hash(hashes.join(',').toLatin1(), QCryptographicHash::Sha1).toHex());
+}
+
+
+void
+ResourceManager::enableMeshOptimisation(const bool& enable)
+{
+   _isMeshOptimisationEnabled = enable;
+}
+
+
+bool
+ResourceManager::isMeshOptimisationEnabled() const
+{
+   return _isMeshOptimisationEnabled;
+}
+
+
+void
+ResourceManager::enableLevelOfDetailGeneration(const bool& enable)
+{
+   _isLevelOfDetailGenerationEnabled = enable;
+}
+
+
+bool
+ResourceManager::isLevelOfDetailGenerationEnabled() const
+{
+   return _isLevelOfDetailGenerationEnabled;
+}
+
+
+void
+ResourceManager::enableModelCache(const bool& enable)
+{
+   _isModelCacheEnabled = enable;
+}
+
+
+bool
+ResourceManager::isModelCacheEnabled() const
+{
+   return _isModelCacheEnabled;
+}
+
+
+QString
+ResourceManager::getModelCacheFilename(const QString& hash, const QString& materialLibrariesHash) const
+{
+   return QString("%1/models/%2%3-v%4%5%6.model")
+   .arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+   .arg(hash)
+   .arg(materialLibrariesHash.isEmpty() ? QString() : "-" + materialLibrariesHash)
+   .arg(clockwork::io::MODEL3D_CACHE_VERSION)
+   .arg(_isMeshOptimisationEnabled ? "-optimised" : "")
+   .arg(_isLevelOfDetailGenerationEnabled ? "-lod" : "");
+}
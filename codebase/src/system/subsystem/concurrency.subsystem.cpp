@@ -23,12 +23,84 @@
  */
 #include "concurrency.subsystem.hh"
 #include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
 #include <memory>
+#include <atomic>
+#include <algorithm>
 #include <cassert>
 
 using clockwork::system::ConcurrencySubsystem;
 
 
+namespace {
+/**
+ * The state shared by every thread that takes part in a ConcurrencySubsystem::parallelFor
+ * call. Chunks are claimed from an atomic counter so that threads that start late, or
+ * not at all, never hold up the others.
+ */
+struct ParallelForState
+{
+   ParallelForState
+   (
+      const std::size_t& n,
+      const std::size_t& g,
+      const std::function<void(const std::size_t&, const std::size_t&)>& k
+   ) :
+   count(n),
+   grain(g),
+   chunkCount((n + g - 1) / g),
+   kernel(k),
+   nextChunk(0),
+   completedChunks(0)
+   {}
+   /**
+    * Claim and process chunks until there are none left.
+    */
+   void work()
+   {
+      std::size_t processed = 0;
+      for (auto chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+      {
+         const auto& begin = chunk * grain;
+         kernel(begin, std::min(begin + grain, count));
+         ++processed;
+      }
+      if (processed > 0 && (completedChunks += processed) == chunkCount)
+      {
+         QMutexLocker locker(&mutex);
+         done.wakeAll();
+      }
+   }
+   const std::size_t count;
+   const std::size_t grain;
+   const std::size_t chunkCount;
+   const std::function<void(const std::size_t&, const std::size_t&)> kernel;
+   std::atomic<std::size_t> nextChunk;
+   std::atomic<std::size_t> completedChunks;
+   QMutex mutex;
+   QWaitCondition done;
+};
+/**
+ * A helper runnable that takes part in a parallelFor call. The shared state is
+ * reference-counted because a helper may start after the call has returned.
+ */
+class ParallelForRunnable : public QRunnable
+{
+public:
+   explicit ParallelForRunnable(const std::shared_ptr<ParallelForState>& state) :
+   _state(state)
+   {}
+   void run() override final
+   {
+      _state->work();
+   }
+private:
+   const std::shared_ptr<ParallelForState> _state;
+};
+} // namespace
+
+
 ConcurrencySubsystem::ConcurrencySubsystem() :
 _threadPool(QThreadPool::globalInstance())
 {
@@ -48,6 +120,9 @@ ConcurrencySubsystem::initialise()
 clockwork::Error
 ConcurrencySubsystem::destroy()
 {
+   purgeTasks();
+   wait();
+
    return clockwork::Error::None;
 }
 
@@ -55,7 +130,9 @@ ConcurrencySubsystem::destroy()
 void
 ConcurrencySubsystem::purgeTasks()
 {
-   std::cerr << "Implement ConcurrencySubsystem::purgeTasks()" << std::endl;
+   QMutexLocker locker(&_taskMutex);
+   for (auto* const task : _tasks)
+      task->cancel();
 }
 
 
@@ -63,7 +140,28 @@ void
 ConcurrencySubsystem::submitTask(clockwork::concurrency::Task* const task)
 {
    if (task != nullptr)
+   {
+      {
+         // Tasks that are still queued and would only produce an older version of the
+         // new task's result are dropped.
+         QMutexLocker locker(&_taskMutex);
+         for (auto* const other : _tasks)
+         {
+            if (!other->isStarted() && other->isSupersededBy(*task))
+               other->cancel();
+         }
+         _tasks.insert(task);
+      }
       _threadPool->start(task, task->getPriority());
+   }
+}
+
+
+void
+ConcurrencySubsystem::onTaskFinished(const clockwork::concurrency::Task& task)
+{
+   QMutexLocker locker(&_taskMutex);
+   _tasks.remove(const_cast<clockwork::concurrency::Task*>(&task));
 }
 
 
@@ -81,9 +179,60 @@ ConcurrencySubsystem::isMultitaskingEnabled() const
 }
 
 
+int
+ConcurrencySubsystem::getMaximumThreadCount() const
+{
+   return _threadPool->maxThreadCount();
+}
+
+
+void
+ConcurrencySubsystem::setMaximumThreadCount(const int& count)
+{
+   _threadPool->setMaxThreadCount(std::max(count, 1));
+}
+
+
 void
 ConcurrencySubsystem::wait()
 {
    if (_threadPool->activeThreadCount() > 0)
       _threadPool->waitForDone();
 }
+
+
+void
+ConcurrencySubsystem::parallelFor
+(
+   const std::size_t& count,
+   const std::size_t& grain,
+   const std::function<void(const std::size_t& begin, const std::size_t& end)>& kernel
+)
+{
+   if (count == 0)
+      return;
+
+   const auto chunkSize = std::max<std::size_t>(grain, 1);
+   const auto& chunkCount = (count + chunkSize - 1) / chunkSize;
+   const auto& helperCount = std::min<std::size_t>(chunkCount, _threadPool->maxThreadCount()) - 1;
+
+   // Small workloads, or a single-threaded pool, are processed on the calling thread.
+   if (helperCount == 0)
+   {
+      for (std::size_t begin = 0; begin < count; begin += chunkSize)
+         kernel(begin, std::min(begin + chunkSize, count));
+      return;
+   }
+
+   auto state = std::make_shared<ParallelForState>(count, chunkSize, kernel);
+   for (std::size_t i = 0; i < helperCount; ++i)
+      _threadPool->start(new ParallelForRunnable(state));
+
+   // The calling thread processes chunks too, then waits for the chunks that were
+   // claimed by helper threads to complete.
+   state->work();
+
+   QMutexLocker locker(&state->mutex);
+   while (state->completedChunks < state->chunkCount)
+      state->done.wait(&state->mutex);
+}
@@ -25,18 +25,72 @@
 #include "graphics.subsystem.hh"
 #include "scene.viewer.hh"
 #include "services.hh"
+#include "profiler.hh"
 #include "image.filter.hh"
 #include "render.algorithm.hh"
 #include "scene.hh"
+#include "scene.snapshot.hh"
+#include "point4.hh"
+#include <algorithm>
+#include <limits>
+#include <cmath>
 #include <cassert>
 
 using clockwork::system::GraphicsSubsystem;
 using clockwork::graphics::Framebuffer;
 
 
+constexpr std::size_t GraphicsSubsystem::MAXIMUM_OCCLUDER_COUNT;
+constexpr std::size_t GraphicsSubsystem::MAXIMUM_OCCLUDER_TRIANGLE_COUNT;
+constexpr double GraphicsSubsystem::MINIMUM_OCCLUDER_SIZE;
+constexpr int GraphicsSubsystem::MAXIMUM_DAMAGE_RECTANGLE_COUNT;
+
+
+namespace {
+/**
+ * Returns true if the two matrices are identical.
+ */
+bool
+isEqual(const clockwork::Matrix4& a, const clockwork::Matrix4& b)
+{
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      for (unsigned int j = 0; j < 4; ++j)
+      {
+         if (a.get(i, j) != b.get(i, j))
+            return false;
+      }
+   }
+   return true;
+}
+
+
+/**
+ * Returns true if the two viewports are identical.
+ */
+bool
+isEqual(const clockwork::graphics::Viewport& a, const clockwork::graphics::Viewport& b)
+{
+   return
+   a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height &&
+   a.near == b.near && a.far == b.far;
+}
+} // namespace
+
+
 GraphicsSubsystem::GraphicsSubsystem() :
-_framebuffer(Framebuffer::Resolution::XGA)
-{}
+_framebuffer(Framebuffer::Resolution::XGA),
+_isOcclusionCullingEnabled(true),
+_isFrameInvalidated(true),
+_lastSnapshotSequence(0),
+_levelOfDetailRevision(0),
+_nextPacketSequence(0),
+_nextRasterSequence(0),
+_isRasterStale(false)
+{
+   // Resizing the framebuffer clears it, so the next frame is redrawn entirely.
+   connect(&_framebuffer, SIGNAL(resized()), this, SLOT(invalidateFrame()), Qt::DirectConnection);
+}
 
 
 clockwork::Error
@@ -54,43 +108,504 @@ GraphicsSubsystem::destroy()
 
 
 void
-GraphicsSubsystem::renderObject(clockwork::scene::Object& object)
+GraphicsSubsystem::renderScene(clockwork::scene::Scene& scene)
 {
-   using clockwork::scene::Property;
+   FramePacket packet;
+   processScene(*scene.captureSnapshot(), packet);
+   rasterise(packet);
+}
 
-   if (object.isPruned())
-      return;
 
-   if (object.hasProperty(Property::Identifier::Appearance))
+void
+GraphicsSubsystem::processScene(const clockwork::scene::SceneSnapshot& snapshot, FramePacket& packet)
+{
+   packet.sequence = _nextPacketSequence++;
+   packet.passes.clear();
+   packet.statistics.clear();
+
+   // A viewer that is no longer active would leave its image behind, so everything is
+   // redrawn when the set of active viewers changes. Everything is also redrawn when a
+   // snapshot was skipped, since the objects that moved in it are unknown.
+   const auto& viewers = snapshot.getViewers();
+   auto isFrameInvalidated =
+   _isFrameInvalidated.exchange(false) ||
+   snapshot.getSequence() != _lastSnapshotSequence + 1 ||
+   viewers.size() != static_cast<std::size_t>(_damageStates.size());
+   for (const auto& viewer : viewers)
+      isFrameInvalidated = isFrameInvalidated || !_damageStates.contains(viewer.key);
+
+   _lastSnapshotSequence = snapshot.getSequence();
+   packet.isComplete = isFrameInvalidated;
+   if (isFrameInvalidated)
+      _damageStates.clear();
+
+   // The level of detail selections are keyed by objects and viewers that may no longer exist.
+   if (snapshot.getTopologyRevision() != _levelOfDetailRevision || _levelsOfDetail.size() > static_cast<int>(viewers.size()))
+   {
+      _levelsOfDetail.clear();
+      _levelOfDetailRevision = snapshot.getTopologyRevision();
+   }
+
+   const auto& objects = snapshot.getObjects();
+   for (const auto& viewer : viewers)
    {
-      for (auto* const viewer : clockwork::scene::Scene::getInstance().getActiveViewers())
+      QRegion damagedRegion;
       {
-         if (isObjectVisibleFromViewer(object, *viewer))
+         CLOCKWORK_PROFILE(Culling);
+
+         // Nothing is drawn if nothing has changed.
+         damagedRegion = updateDamagedRegion(snapshot, viewer);
+         if (damagedRegion.isEmpty())
+            continue;
+
+         _occlusionBuffer.clear();
+         if (_isOcclusionCullingEnabled)
+            updateOcclusionBuffer(snapshot, viewer);
+      }
+
+      packet.passes.emplace_back();
+      auto& pass = packet.passes.back();
+      pass.damagedRegion = damagedRegion;
+      pass.imageFilter = viewer.imageFilter;
+      pass.viewport = viewer.viewport;
+
+      // A region that is too fragmented is redrawn as a whole to avoid rasterising the
+      // same objects over and over again.
+      pass.rectangles = damagedRegion.rects();
+      if (pass.rectangles.size() > MAXIMUM_DAMAGE_RECTANGLE_COUNT)
+         pass.rectangles = {damagedRegion.boundingRect()};
+
+      // Only the visible objects that overlap the damaged region are processed.
+      const auto* const renderer =
+      clockwork::graphics::RenderAlgorithmFactory::getInstance().get(viewer.renderAlgorithm);
+      assert(renderer != nullptr);
+
+      const auto& screenBounds = _damageStates[viewer.key].screenBounds;
+      auto& levelsOfDetail = _levelsOfDetail[viewer.key];
+      for (const auto& index : viewer.visibleObjects)
+      {
+         const auto& object = objects[index];
+         const auto& bounds = screenBounds.value(object.key);
+         const auto& isDamaged = std::any_of
+         (
+            pass.rectangles.begin(), pass.rectangles.end(),
+            [&bounds](const QRect& rectangle) { return bounds.intersects(rectangle); }
+         );
+         if (!isDamaged)
+            continue;
+
+         auto& statistics = packet.statistics[object.key];
+         auto& levelOfDetail = levelsOfDetail[object.key];
+         if (_occlusionBuffer.isVisible(object.box, viewer.VIEWPROJECTION))
          {
-            const auto* const renderer =
-            clockwork::graphics::RenderAlgorithmFactory::getInstance().get(viewer->getRenderAlgorithm());
-            assert(renderer != nullptr);
+            renderer->process(object, viewer, levelOfDetail, pass.commands, statistics);
+            pass.bounds.resize(pass.commands.size(), bounds);
+         }
+         else
+            statistics.occlusionCulled += object.model3D->getTriangleCount(levelOfDetail);
+      }
+   }
+   _occlusionBuffer.clear();
+}
 
-            renderer->apply(object, *viewer);
+
+void
+GraphicsSubsystem::rasterise(const FramePacket& packet)
+{
+   QMutexLocker locker(&_rasterMutex);
+   while (_nextRasterSequence != packet.sequence)
+      _rasterTurn.wait(&_rasterMutex);
+
+   if (packet.isComplete)
+   {
+      _isRasterStale = false;
+      _framebuffer.clear();
+      _framebuffer.addDamagedRegion(QRect(0, 0, _framebuffer.getWidth(), _framebuffer.getHeight()));
+   }
+
+   // Redraw each damaged rectangle, clipping the objects that overlap it. The fragments
+   // are counted in the statistics of the object that is being drawn.
+   if (!_isRasterStale)
+   {
+      auto statistics = packet.statistics;
+      for (const auto& pass : packet.passes)
+      {
+         for (const auto& rectangle : pass.rectangles)
+         {
+            _framebuffer.clear(rectangle);
+            _framebuffer.setClipRectangle(rectangle);
+            for (std::size_t i = 0; i < pass.commands.size(); ++i)
+            {
+               if (pass.bounds[i].intersects(rectangle))
+               {
+                  const auto& command = pass.commands[i];
+                  _framebuffer.setStatistics(&statistics[command.object]);
+                  command.algorithm->draw(command);
+               }
+            }
          }
+         _framebuffer.setStatistics(nullptr);
+         _framebuffer.resetClipRectangle();
+         _framebuffer.addDamagedRegion(pass.damagedRegion);
+
+         postProcess(pass.imageFilter, pass.viewport);
+      }
+
+      clockwork::graphics::PipelineStatistics frameStatistics;
+      for (const auto& objectStatistics : statistics)
+         frameStatistics += objectStatistics;
+
+      QMutexLocker statisticsLocker(&_statisticsMutex);
+      _frameStatistics = frameStatistics;
+      _objectStatistics = std::move(statistics);
+   }
+
+   ++_nextRasterSequence;
+   _rasterTurn.wakeAll();
+}
+
+
+clockwork::graphics::PipelineStatistics
+GraphicsSubsystem::getFrameStatistics() const
+{
+   QMutexLocker locker(&_statisticsMutex);
+   return _frameStatistics;
+}
+
+
+QHash<const clockwork::scene::Object*, clockwork::graphics::PipelineStatistics>
+GraphicsSubsystem::getObjectStatistics() const
+{
+   QMutexLocker locker(&_statisticsMutex);
+   return _objectStatistics;
+}
+
+
+void
+GraphicsSubsystem::discard(const FramePacket& packet)
+{
+   QMutexLocker locker(&_rasterMutex);
+   while (_nextRasterSequence != packet.sequence)
+      _rasterTurn.wait(&_rasterMutex);
+
+   _isRasterStale = true;
+   _isFrameInvalidated = true;
+
+   ++_nextRasterSequence;
+   _rasterTurn.wakeAll();
+}
+
+
+QRegion
+GraphicsSubsystem::updateDamagedRegion
+(
+   const clockwork::scene::SceneSnapshot& snapshot,
+   const clockwork::scene::ViewerSnapshot& viewer
+)
+{
+   const auto& objects = snapshot.getObjects();
+   const auto& VIEWPROJECTION = viewer.VIEWPROJECTION;
+   const auto& viewport = viewer.viewport;
+
+   // Anything that changes how the whole viewport is drawn, such as a different render
+   // algorithm or a resized framebuffer, damages the whole viewport.
+   auto& state = _damageStates[viewer.key];
+   if
+   (
+      !state.isValid ||
+      state.topologyRevision != snapshot.getTopologyRevision() ||
+      !isEqual(state.viewProjection, VIEWPROJECTION) ||
+      !isEqual(state.viewport, viewport) ||
+      state.renderAlgorithm != viewer.renderAlgorithm ||
+      state.primitiveMode != viewer.primitiveMode ||
+      state.lineAlgorithm != viewer.lineAlgorithm ||
+      state.imageFilter != viewer.imageFilter ||
+      state.framebufferWidth != _framebuffer.getWidth() ||
+      state.framebufferHeight != _framebuffer.getHeight()
+   )
+   {
+      // The whole viewport is redrawn, and the bounds of the objects that are inside the
+      // view frustum are recorded. Objects outside the frustum have no bounds and so,
+      // when they move, only their new bounds are damaged.
+      state.isValid = true;
+      state.topologyRevision = snapshot.getTopologyRevision();
+      state.viewProjection = VIEWPROJECTION;
+      state.viewport = viewport;
+      state.renderAlgorithm = viewer.renderAlgorithm;
+      state.primitiveMode = viewer.primitiveMode;
+      state.lineAlgorithm = viewer.lineAlgorithm;
+      state.imageFilter = viewer.imageFilter;
+      state.framebufferWidth = _framebuffer.getWidth();
+      state.framebufferHeight = _framebuffer.getHeight();
+      state.screenBounds.clear();
+      for (const auto& index : viewer.visibleObjects)
+      {
+         const auto& object = objects[index];
+         const auto& bounds = getScreenBounds(object.box, VIEWPROJECTION, viewport);
+         if (!bounds.isEmpty())
+            state.screenBounds.insert(object.key, bounds);
       }
+      return getViewportRectangle(viewport);
    }
 
-   // Render the subgraph.
-   for (auto* const child : object.getChildren())
-      renderObject(*child);
+   QRegion region;
+   for (const auto& index : snapshot.getChangedObjects())
+   {
+      const auto& object = objects[index];
+      const auto& bounds = getScreenBounds(object.box, VIEWPROJECTION, viewport);
+      const auto& it = state.screenBounds.find(object.key);
+      if (it != state.screenBounds.end())
+      {
+         region += it.value();
+         if (bounds.isEmpty())
+         {
+            state.screenBounds.erase(it);
+            continue;
+         }
+      }
+      if (!bounds.isEmpty())
+      {
+         region += bounds;
+         state.screenBounds.insert(object.key, bounds);
+      }
+   }
+   return region;
+}
+
+
+QRect
+GraphicsSubsystem::getViewportRectangle(const clockwork::graphics::Viewport& viewport) const
+{
+   const auto& width = viewport.width * _framebuffer.getWidth();
+   const auto& height = viewport.height * _framebuffer.getHeight();
+   const QRect rectangle
+   (
+      QPoint(std::floor(viewport.x), std::floor(viewport.y)),
+      QPoint(std::ceil(viewport.x + width), std::ceil(viewport.y + height))
+   );
+   return rectangle.intersected(QRect(0, 0, _framebuffer.getWidth(), _framebuffer.getHeight()));
+}
+
+
+QRect
+GraphicsSubsystem::getScreenBounds
+(
+   const clockwork::graphics::BoundingBox& box,
+   const clockwork::Matrix4& VIEWPROJECTION,
+   const clockwork::graphics::Viewport& viewport
+) const
+{
+   if (box.isEmpty())
+      return QRect();
+
+   // Project the box's corners and apply the same viewport transform as the render
+   // algorithms. If the box crosses the viewpoint's plane, its projection is unbounded.
+   const auto& vpw = 0.5 * viewport.width * _framebuffer.getWidth();
+   const auto& vph = 0.5 * viewport.height * _framebuffer.getHeight();
+   auto minimumX = std::numeric_limits<double>::max();
+   auto minimumY = std::numeric_limits<double>::max();
+   auto maximumX = std::numeric_limits<double>::lowest();
+   auto maximumY = std::numeric_limits<double>::lowest();
+   for (unsigned int i = 0; i < 8; ++i)
+   {
+      const auto& corner = VIEWPROJECTION * clockwork::Point4
+      (
+         (i & 1) ? box.maximum.x : box.minimum.x,
+         (i & 2) ? box.maximum.y : box.minimum.y,
+         (i & 4) ? box.maximum.z : box.minimum.z,
+         1.0
+      );
+      if (corner.w <= 0.0)
+         return getViewportRectangle(viewport);
+
+      const auto& x = vpw * (corner.x / corner.w) + (viewport.x + vpw);
+      const auto& y = vph * (corner.y / corner.w) + (viewport.y + vph);
+      minimumX = std::min(minimumX, x);
+      minimumY = std::min(minimumY, y);
+      maximumX = std::max(maximumX, x);
+      maximumY = std::max(maximumY, y);
+   }
+
+   // The rasteriser rounds vertex positions, so the bounds are grown by a pixel.
+   const QRect rectangle
+   (
+      QPoint(std::floor(minimumX) - 1, std::floor(minimumY) - 1),
+      QPoint(std::ceil(maximumX) + 1, std::ceil(maximumY) + 1)
+   );
+   return rectangle.intersected(getViewportRectangle(viewport));
+}
+
+
+void
+GraphicsSubsystem::updateOcclusionBuffer
+(
+   const clockwork::scene::SceneSnapshot& snapshot,
+   const clockwork::scene::ViewerSnapshot& viewer
+)
+{
+   using clockwork::scene::ObjectSnapshot;
+   using clockwork::graphics::BoundingSphere;
+
+   // Rank the objects by their approximate size on the screen. Objects that contain the
+   // viewpoint, such as the walls of the room the viewer is in, are the best occluders.
+   const auto& objects = snapshot.getObjects();
+   std::vector<std::pair<double, const ObjectSnapshot*>> occluders;
+   for (const auto& index : viewer.visibleObjects)
+   {
+      const auto& object = objects[index];
+      if (object.model3D->getTriangleCount() > MAXIMUM_OCCLUDER_TRIANGLE_COUNT)
+         continue;
+
+      const auto& sphere = BoundingSphere::transform(object.model3D->getBoundingSphere(), object.MODEL);
+      const auto& distance = (sphere.center - viewer.viewpoint).getMagnitude() - sphere.radius;
+      const auto& size = distance > 0.0 ? sphere.radius / distance : std::numeric_limits<double>::max();
+      if (size >= MINIMUM_OCCLUDER_SIZE)
+         occluders.emplace_back(size, &object);
+   }
+
+   const auto count = std::min(occluders.size(), MAXIMUM_OCCLUDER_COUNT);
+   std::partial_sort
+   (
+      occluders.begin(), occluders.begin() + count, occluders.end(),
+      [](const std::pair<double, const ObjectSnapshot*>& a, const std::pair<double, const ObjectSnapshot*>& b)
+      {
+         return a.first > b.first;
+      }
+   );
+
+   for (std::size_t i = 0; i < count; ++i)
+   {
+      const auto& object = *occluders[i].second;
+      _occlusionBuffer.addOccluder(*object.model3D, viewer.VIEWPROJECTION * object.MODEL);
+   }
+}
+
+
+void
+GraphicsSubsystem::renderObject(clockwork::scene::Object& object, clockwork::scene::Viewer& viewer)
+{
+   using clockwork::scene::Property;
+
+   if (object.isPruned() || !object.hasProperty(Property::Identifier::Appearance))
+      return;
+
+   const auto* const renderer =
+   clockwork::graphics::RenderAlgorithmFactory::getInstance().get(viewer.getRenderAlgorithm());
+   assert(renderer != nullptr);
+
+   renderer->apply(object, viewer);
+}
+
+
+GraphicsSubsystem::PickResult
+GraphicsSubsystem::pick(const clockwork::scene::Viewer& viewer, const uint32_t& x, const uint32_t& y)
+{
+   using clockwork::graphics::Ray;
+
+   const auto& infinity = std::numeric_limits<double>::infinity();
+   PickResult output = {nullptr, 0, {{0, 0, 0}}, infinity, clockwork::Point3()};
+
+   // The published snapshot is immutable, so it can be read while the update stage
+   // modifies the scene. Holding the pointer keeps it alive for the whole query.
+   const auto& snapshot = clockwork::scene::Scene::getInstance().getSnapshot();
+   if (snapshot == nullptr)
+      return output;
+
+   const auto& viewers = snapshot->getViewers();
+   const auto& it = std::find_if(viewers.begin(), viewers.end(),
+   [&viewer](const clockwork::scene::ViewerSnapshot& v){ return v.key == &viewer; });
+   if (it == viewers.end())
+      return output;
+
+   const auto& viewerSnapshot = *it;
+
+   // Invert the viewport transform that is applied by the render algorithms to find the
+   // pixel's position in normalised device coordinates.
+   const auto& viewport = viewerSnapshot.viewport;
+   const auto& vpw = 0.5 * viewport.width * _framebuffer.getWidth();
+   const auto& vph = 0.5 * viewport.height * _framebuffer.getHeight();
+   if (vpw <= 0.0 || vph <= 0.0)
+      return output;
+
+   const auto& ndcx = (x - (viewport.x + vpw)) / vpw;
+   const auto& ndcy = (y - (viewport.y + vph)) / vph;
+
+   // Unproject the pixel onto the near and far planes to create a ray in world space.
+   const auto& INVERSE_VIEWPROJECTION = clockwork::Matrix4::inverse(viewerSnapshot.VIEWPROJECTION);
+   const auto& near = INVERSE_VIEWPROJECTION * clockwork::Point4(ndcx, ndcy, -1.0, 1.0);
+   const auto& far = INVERSE_VIEWPROJECTION * clockwork::Point4(ndcx, ndcy, 1.0, 1.0);
+   if (near.w == 0.0 || far.w == 0.0)
+      return output;
+
+   const clockwork::Point3 origin(near.x / near.w, near.y / near.w, near.z / near.w);
+   const clockwork::Point3 target(far.x / far.w, far.y / far.w, far.z / far.w);
+   const Ray ray(origin, target - origin);
+
+   // Only the objects that the viewer can see need to be tested. Those whose boxes the ray
+   // hits are sorted by the distance at which the ray enters their boxes, and tested from
+   // front to back, so the search ends as soon as a box starts behind the closest hit.
+   const auto& objects = snapshot->getObjects();
+   std::vector<std::pair<double, uint32_t>> candidates;
+   candidates.reserve(viewerSnapshot.visibleObjects.size());
+   for (const auto& index : viewerSnapshot.visibleObjects)
+   {
+      const auto& object = objects[index];
+
+      double entryDistance = 0.0;
+      double exitDistance = infinity;
+      if (object.model3D != nullptr && object.box.intersects(ray, entryDistance, exitDistance))
+         candidates.push_back(std::make_pair(entryDistance, index));
+   }
+   std::sort(candidates.begin(), candidates.end());
+
+   for (const auto& candidate : candidates)
+   {
+      if (candidate.first >= output.depth)
+         break;
+
+      const auto& object = objects[candidate.second];
+
+      // Cast the ray in the model's coordinate space. Since the ray's direction is normalised,
+      // distances in model space are scaled by the length of the transformed direction.
+      const auto& INVERSE_MODEL = clockwork::Matrix4::inverse(object.MODEL);
+      const auto& localOrigin = INVERSE_MODEL * ray.origin;
+      const auto& localDirection = (INVERSE_MODEL * ray.getPoint(1.0)) - localOrigin;
+      const auto& scale = localDirection.getMagnitude();
+      if (scale <= 0.0)
+         continue;
+
+      clockwork::graphics::TriangleHierarchy::Hit hit;
+      const auto& hierarchy = object.model3D->getTriangleHierarchy();
+      if (hierarchy.intersect(Ray(localOrigin, localDirection), output.depth * scale, hit))
+      {
+         const auto& distance = hit.distance / scale;
+         if (distance < output.depth)
+         {
+            output.object = object.key;
+            output.triangle = hit.triangle;
+            output.barycentrics = {{1.0 - hit.u - hit.v, hit.u, hit.v}};
+            output.depth = distance;
+            output.position = ray.getPoint(distance);
+         }
+      }
+   }
+   return output;
 }
 
 
 bool
 GraphicsSubsystem::isObjectVisibleFromViewer
 (
-   const clockwork::scene::Object&,
-   const clockwork::scene::Viewer&
+   const clockwork::scene::Object& object,
+   clockwork::scene::Viewer& viewer
 ) const
 {
-   //TODO Implement me.
-   return true;
+   using clockwork::graphics::BoundingFrustum;
+
+   const BoundingFrustum frustum(viewer.getViewProjectionTransform());
+   const auto& box = clockwork::scene::BoundingVolumeHierarchy::getBoundingBox(object);
+
+   return frustum.contains(box) != BoundingFrustum::Containment::Outside;
 }
 
 
@@ -101,10 +616,19 @@ GraphicsSubsystem::postProcess
    const clockwork::graphics::Viewport&
 )
 {
+   CLOCKWORK_PROFILE(Post);
+
    //TODO Implement me.
 }
 
 
+void
+GraphicsSubsystem::invalidateFrame()
+{
+   _isFrameInvalidated = true;
+}
+
+
 clockwork::graphics::Framebuffer&
 GraphicsSubsystem::getFramebuffer()
 {
@@ -112,6 +636,27 @@ GraphicsSubsystem::getFramebuffer()
 }
 
 
+const clockwork::graphics::OcclusionBuffer&
+GraphicsSubsystem::getOcclusionBuffer() const
+{
+   return _occlusionBuffer;
+}
+
+
+bool
+GraphicsSubsystem::isOcclusionCullingEnabled() const
+{
+   return _isOcclusionCullingEnabled;
+}
+
+
+void
+GraphicsSubsystem::enableOcclusionCulling(const bool enable)
+{
+   _isOcclusionCullingEnabled = enable;
+}
+
+
 bool
 GraphicsSubsystem::isScissorTestEnabled() const
 {
@@ -25,8 +25,10 @@
 #include "ui.hh"
 #include "debug.hh"
 #include "services.hh"
+#include "profiler.hh"
 #include <QPainter>
 #include <QPaintEvent>
+#include <array>
 
 using clockwork::ui::GUIDisplayDevice;
 
@@ -47,47 +49,136 @@ _framebuffer(clockwork::system::Services::Graphics.getFramebuffer())
 void
 GUIDisplayDevice::onFrameReady()
 {
-   setUpdatesEnabled(false);
+   const auto& damagedRegion = _framebuffer.takeDamagedRegion();
 
-   // Upload the framebuffer's pixel buffer into the output buffer.
-   _outputBuffer = QImage
+   // The output buffer wraps the framebuffer's pixel buffer, so it only needs to be
+   // recreated when the pixel buffer is reallocated.
+   const auto* const pixels = reinterpret_cast<const uchar*>(_framebuffer.getPixelBuffer());
+   if
    (
-      reinterpret_cast<const uchar*>(_framebuffer.getPixelBuffer()),
-      _framebuffer.getWidth(),
-      _framebuffer.getHeight(),
-      QImage::Format_ARGB32
-   );
-
-   setUpdatesEnabled(true);
-   update();
+      _outputBuffer.constBits() != pixels ||
+      static_cast<uint32_t>(_outputBuffer.width()) != _framebuffer.getWidth() ||
+      static_cast<uint32_t>(_outputBuffer.height()) != _framebuffer.getHeight()
+   )
+   {
+      _outputBuffer = QImage(pixels, _framebuffer.getWidth(), _framebuffer.getHeight(), QImage::Format_ARGB32);
+      update();
+      return;
+   }
+
+   // Repaint the parts of the display that cover the damaged region. The rectangles are
+   // grown by a pixel to account for the filtering of the scaled image.
+   const auto& sx = static_cast<double>(width()) / _framebuffer.getWidth();
+   const auto& sy = static_cast<double>(height()) / _framebuffer.getHeight();
+   QRegion region;
+   for (const auto& rectangle : damagedRegion.rects())
+   {
+      const QRectF target(sx * rectangle.x(), sy * rectangle.y(), sx * rectangle.width(), sy * rectangle.height());
+      region += target.toAlignedRect().adjusted(-1, -1, 1, 1);
+   }
+
+#ifdef CLOCKWORK_PROFILER
+   // The heads-up display changes with every frame.
+   if (clockwork::system::Debug::printToDisplay)
+      region += getHeadsUpDisplayRectangle();
+#endif
+
+   if (!region.isEmpty())
+      update(region);
 }
 
 
 void
-GUIDisplayDevice::paintEvent(QPaintEvent* const)
+GUIDisplayDevice::paintEvent(QPaintEvent* const event)
 {
    // Begin painting this device.
    _painter.begin(this);
 
-   //TODO Optimise this to draw only the part of the screen that doesn't change.
-   // Draw the output buffer.
-   _painter.drawImage(rect(), _outputBuffer);
-//   auto& targetRect = event->rect();
-//   _painter.drawImage(rect, _outputBuffer.copy(rect));
-//   _painter.drawImage(targetRect, _outputBuffer, rect());
-
-/*
- * TODO Implement me.
- *
-   if (clockwork::system::Services::ExecutionContext.printDebugInformation)
+   // Draw the parts of the output buffer that lie in the region that needs repainting.
+   if (!_outputBuffer.isNull())
    {
-      const auto& debugInfo = QObject::tr(clockwork::system::Debug::toString().c_str());
+      CLOCKWORK_PROFILE(Present);
 
-      _painter.setRenderHint(QPainter::TextAntialiasing);
-      _painter.setPen(_pen);
-      _painter.drawText(rect.adjusted(5, 5, 0, 0), debugInfo);
+      const auto& sx = static_cast<double>(_outputBuffer.width()) / width();
+      const auto& sy = static_cast<double>(_outputBuffer.height()) / height();
+      for (const auto& rectangle : event->region().rects())
+      {
+         const QRectF source(sx * rectangle.x(), sy * rectangle.y(), sx * rectangle.width(), sy * rectangle.height());
+         _painter.drawImage(QRectF(rectangle), _outputBuffer, source);
+      }
    }
-*/
+
+#ifdef CLOCKWORK_PROFILER
+   if (clockwork::system::Debug::printToDisplay && event->region().intersects(getHeadsUpDisplayRectangle()))
+      paintHeadsUpDisplay();
+#endif
+
    // End painting.
    _painter.end();
 }
+
+
+#ifdef CLOCKWORK_PROFILER
+QRect
+GUIDisplayDevice::getHeadsUpDisplayRectangle()
+{
+   return QRect(8, 8, 640, 220);
+}
+
+
+void
+GUIDisplayDevice::paintHeadsUpDisplay()
+{
+   const auto& rectangle = getHeadsUpDisplayRectangle();
+   const auto& debugInfo = QString::fromStdString(clockwork::system::Debug::toString());
+
+   _painter.fillRect(rectangle, QColor(0, 0, 0, 160));
+   _painter.setRenderHint(QPainter::TextAntialiasing);
+   _painter.setPen(_pen);
+   _painter.drawText(rectangle.adjusted(6, 4, 0, 0), Qt::AlignLeft | Qt::AlignTop, debugInfo);
+
+   using clockwork::system::Profiler;
+
+   // Plot the most recent frames as stacked bars of stage times, from the oldest on the
+   // left to the newest on the right. The graph's scale spans two 60 Hz frames, and the
+   // line marks the duration of one.
+   static const std::array<QColor, Profiler::STAGE_COUNT> colors =
+   {{
+      QColor(0x42, 0xa5, 0xf5), // Update
+      QColor(0x26, 0xc6, 0xda), // Culling
+      QColor(0x66, 0xbb, 0x6a), // Vertex
+      QColor(0xd4, 0xe1, 0x57), // Setup
+      QColor(0xff, 0xa7, 0x26), // Raster
+      QColor(0xef, 0x53, 0x50), // Fragment
+      QColor(0xab, 0x47, 0xbc), // Post
+      QColor(0xbd, 0xbd, 0xbd)  // Present
+   }};
+   constexpr double GRAPH_RANGE = 2000.0 / 60.0;
+   const QRectF graph(rectangle.x() + 360, rectangle.y() + 6, rectangle.width() - 366, rectangle.height() - 12);
+   const auto& barWidth = graph.width() / Profiler::HISTORY_LENGTH;
+   const auto& pixelsPerMillisecond = graph.height() / GRAPH_RANGE;
+
+   const auto& history = Profiler::getInstance().getFrameHistory();
+   auto x = graph.right() - history.size() * barWidth;
+   for (const auto& frame : history)
+   {
+      auto y = graph.bottom();
+      for (std::size_t i = 0; i < Profiler::STAGE_COUNT; ++i)
+      {
+         const auto height = std::min(frame.stageTimes[i] * pixelsPerMillisecond, y - graph.top());
+         _painter.fillRect(QRectF(x, y - height, barWidth, height), colors[i]);
+         y -= height;
+      }
+
+      // The frame's duration, which includes the time spent waiting for the next frame.
+      const auto& frameY = graph.bottom() - std::min(frame.frameTime * pixelsPerMillisecond, graph.height());
+      _painter.fillRect(QRectF(x, frameY, barWidth, 1.0), Qt::white);
+      x += barWidth;
+   }
+
+   const auto& budgetY = graph.bottom() - 0.5 * graph.height();
+   _painter.setPen(QPen(Qt::white, 1.0, Qt::DashLine));
+   _painter.drawLine(QPointF(graph.left(), budgetY), QPointF(graph.right(), budgetY));
+   _painter.setPen(_pen);
+}
+#endif // CLOCKWORK_PROFILER
@@ -23,12 +23,124 @@
  * THE SOFTWARE.
  */
 #include "Framebuffer.hh"
+#include <algorithm>
+#include <utility>
+#include <limits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using clockwork::Framebuffer;
 
 
+constexpr unsigned int Framebuffer::TILE_SIZE;
+
+
+namespace {
+/**
+ * Returns the range of depth values in the specified buffer, ignoring fragments that
+ * still hold the clear value. If no fragment was written, the range is empty (min > max).
+ */
+std::pair<double, double>
+getDepthRange(const double* const depths, const std::size_t count, const double clearValue)
+{
+    auto min = std::numeric_limits<double>::max();
+    auto max = std::numeric_limits<double>::lowest();
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const auto clear = _mm_set1_pd(clearValue);
+    const auto lowest = _mm_set1_pd(std::numeric_limits<double>::lowest());
+    auto mins = _mm_set1_pd(min);
+    auto maxs = _mm_set1_pd(max);
+    for (; i + 2 <= count; i += 2)
+    {
+        // Cleared fragments are replaced with values that leave the range unchanged.
+        const auto d = _mm_loadu_pd(depths + i);
+        const auto written = _mm_cmplt_pd(d, clear);
+        mins = _mm_min_pd(mins, d);
+        maxs = _mm_max_pd(maxs, _mm_or_pd(_mm_and_pd(written, d), _mm_andnot_pd(written, lowest)));
+    }
+    double m[2];
+    _mm_storeu_pd(m, mins);
+    min = std::min(m[0], m[1]);
+    _mm_storeu_pd(m, maxs);
+    max = std::max(m[0], m[1]);
+#endif
+    for (; i < count; ++i)
+    {
+        if (depths[i] < clearValue)
+        {
+            min = std::min(min, depths[i]);
+            max = std::max(max, depths[i]);
+        }
+    }
+    return std::make_pair(min, max);
+}
+/**
+ * Converts the depth buffer into opaque greyscale pixels, mapping the specified range to
+ * [0, 255]. Values outside the range, including the clear value, are saturated.
+ */
+void
+convertDepths(const double* const depths, std::uint32_t* const pixels, const std::size_t count, const double min, const double max)
+{
+    const auto scale = max > min ? 255.0 / (max - min) : 0.0;
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const auto offset = _mm_set1_pd(min);
+    const auto scales = _mm_set1_pd(scale);
+    const auto zero = _mm_setzero_pd();
+    const auto full = _mm_set1_pd(255.0);
+    const auto alpha = _mm_set1_epi32(0xFF000000);
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto a = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(depths + i), offset), scales), zero), full);
+        const auto b = _mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(depths + i + 2), offset), scales), zero), full);
+        const auto grey = _mm_unpacklo_epi64(_mm_cvttpd_epi32(a), _mm_cvttpd_epi32(b));
+        const auto rgb = _mm_or_si128(grey, _mm_or_si128(_mm_slli_epi32(grey, 8), _mm_slli_epi32(grey, 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), _mm_or_si128(rgb, alpha));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const auto grey = static_cast<std::uint32_t>(std::min(std::max((depths[i] - min) * scale, 0.0), 255.0));
+        pixels[i] = 0xFF000000 | (grey << 16) | (grey << 8) | grey;
+    }
+}
+/**
+ * Converts the stencil buffer into opaque greyscale pixels.
+ */
+void
+convertStencils(const std::uint8_t* const stencils, std::uint32_t* const pixels, const std::size_t count)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const auto alpha = _mm_set1_epi32(0xFF000000);
+    for (; i + 16 <= count; i += 16)
+    {
+        // Each byte is widened by interleaving it with itself twice, replicating it into
+        // the red, green and blue channels (and alpha, which is then forced to opaque).
+        const auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stencils + i));
+        const auto lo = _mm_unpacklo_epi8(s, s);
+        const auto hi = _mm_unpackhi_epi8(s, s);
+        auto* const out = reinterpret_cast<__m128i*>(pixels + i);
+        _mm_storeu_si128(out + 0, _mm_or_si128(_mm_unpacklo_epi16(lo, lo), alpha));
+        _mm_storeu_si128(out + 1, _mm_or_si128(_mm_unpackhi_epi16(lo, lo), alpha));
+        _mm_storeu_si128(out + 2, _mm_or_si128(_mm_unpacklo_epi16(hi, hi), alpha));
+        _mm_storeu_si128(out + 3, _mm_or_si128(_mm_unpackhi_epi16(hi, hi), alpha));
+    }
+#endif
+    for (; i < count; ++i)
+        pixels[i] = 0xFF000000 | (std::uint32_t(stencils[i]) * 0x010101);
+}
+} // namespace
+
+
 Framebuffer::Framebuffer(const Resolution resolution) :
 resolution_(resolution),
+tileColumnCount_(0),
+tileRowCount_(0),
+tileStates_(nullptr),
+clearedTileCount_(0),
 pixelBuffer_(nullptr),
 pixelBufferClearValue_(0xFF000000),
 pixelBufferImage_(nullptr),
@@ -38,6 +150,7 @@ depthBufferImageData_(nullptr),
 depthBufferImage_(nullptr),
 stencilBuffer_(nullptr),
 stencilBufferClearValue_(0x00),
+stencilBufferImageData_(nullptr),
 stencilBufferImage_(nullptr)
 {
     resize();
@@ -94,6 +207,7 @@ Framebuffer::getPixelBuffer()
 const QImage&
 Framebuffer::getPixelBufferImage() const
 {
+    resolve();
     return *pixelBufferImage_;
 }
 
@@ -108,6 +222,18 @@ Framebuffer::getDepthBuffer()
 const QImage&
 Framebuffer::getDepthBufferImage() const
 {
+    resolve();
+
+    const auto& resolution = getResolution();
+    const std::size_t size = resolution.width() * resolution.height();
+    if (depthBufferImage_ == nullptr)
+    {
+        depthBufferImageData_.reset(new std::uint32_t[size]);
+        depthBufferImage_.reset(new QImage(reinterpret_cast<uchar*>(depthBufferImageData_.get()), resolution.width(), resolution.height(), QImage::Format_RGB32));
+    }
+    const auto& range = getDepthRange(depthBuffer_.get(), size, depthBufferClearValue_);
+    convertDepths(depthBuffer_.get(), depthBufferImageData_.get(), size, range.first, range.second);
+
     return *depthBufferImage_;
 }
 
@@ -122,6 +248,17 @@ Framebuffer::getStencilBuffer()
 const QImage&
 Framebuffer::getStencilBufferImage() const
 {
+    resolve();
+
+    const auto& resolution = getResolution();
+    const std::size_t size = resolution.width() * resolution.height();
+    if (stencilBufferImage_ == nullptr)
+    {
+        stencilBufferImageData_.reset(new std::uint32_t[size]);
+        stencilBufferImage_.reset(new QImage(reinterpret_cast<uchar*>(stencilBufferImageData_.get()), resolution.width(), resolution.height(), QImage::Format_RGB32));
+    }
+    convertStencils(stencilBuffer_.get(), stencilBufferImageData_.get(), size);
+
     return *stencilBufferImage_;
 }
 
@@ -129,22 +266,94 @@ Framebuffer::getStencilBufferImage() const
 void
 Framebuffer::clear()
 {
+    const std::size_t tileCount = tileColumnCount_ * tileRowCount_;
+    std::fill_n(tileStates_.get(), tileCount, TileState::Cleared);
+    clearedTileCount_ = tileCount;
+}
+
+
+void
+Framebuffer::touch(const unsigned int x, const unsigned int y)
+{
+    const auto column = x / TILE_SIZE;
+    const auto row = y / TILE_SIZE;
+    if (column < tileColumnCount_ && row < tileRowCount_)
+        resolveTile(column, row);
+}
+
+
+void
+Framebuffer::cover(const QRect& region)
+{
+    const auto& bounds = region.intersected(QRect(QPoint(0, 0), getResolution()));
+    if (bounds.isEmpty() || clearedTileCount_ == 0)
+        return;
+
     const auto& resolution = getResolution();
-    if (!resolution.isValid())
+    const unsigned int left = bounds.left();
+    const unsigned int top = bounds.top();
+    const unsigned int right = bounds.right() + 1;
+    const unsigned int bottom = bounds.bottom() + 1;
+
+    for (auto row = top / TILE_SIZE; row <= (bottom - 1) / TILE_SIZE; ++row)
+    {
+        const auto y0 = row * TILE_SIZE;
+        const auto y1 = std::min(y0 + TILE_SIZE, static_cast<unsigned int>(resolution.height()));
+        for (auto column = left / TILE_SIZE; column <= (right - 1) / TILE_SIZE; ++column)
+        {
+            auto& state = tileStates_[row * tileColumnCount_ + column];
+            if (state != TileState::Cleared)
+                continue;
+
+            // A tile that is entirely overwritten never needs its clear values.
+            const auto x0 = column * TILE_SIZE;
+            const auto x1 = std::min(x0 + TILE_SIZE, static_cast<unsigned int>(resolution.width()));
+            if (left <= x0 && x1 <= right && top <= y0 && y1 <= bottom)
+            {
+                state = TileState::Resolved;
+                --clearedTileCount_;
+            }
+            else
+                resolveTile(column, row);
+        }
+    }
+}
+
+
+void
+Framebuffer::resolve() const
+{
+    for (unsigned int row = 0; row < tileRowCount_ && clearedTileCount_ > 0; ++row)
+    {
+        for (unsigned int column = 0; column < tileColumnCount_; ++column)
+            resolveTile(column, row);
+    }
+}
+
+
+void
+Framebuffer::resolveTile(const unsigned int column, const unsigned int row) const
+{
+    auto& state = tileStates_[row * tileColumnCount_ + column];
+    if (state != TileState::Cleared)
         return;
 
-    auto* a = pixelBuffer_.get();
-    auto* b = depthBuffer_.get();
-    auto* c = depthBufferImageData_.get();
-    auto* d = stencilBuffer_.get();
+    const auto& resolution = getResolution();
+    const std::size_t width = resolution.width();
+    const auto x0 = column * TILE_SIZE;
+    const auto y0 = row * TILE_SIZE;
+    const std::size_t tileWidth = std::min(TILE_SIZE, static_cast<unsigned int>(resolution.width()) - x0);
+    const auto tileHeight = std::min(TILE_SIZE, static_cast<unsigned int>(resolution.height()) - y0);
 
-    for (std::size_t i = 0; i < std::size_t(resolution.width() * resolution.height()); ++i)
+    for (auto y = y0; y < y0 + tileHeight; ++y)
     {
-        *a++ = pixelBufferClearValue_;
-        *b++ = depthBufferClearValue_;
-        *c++ = std::numeric_limits<std::uint32_t>::max();
-        *d++ = stencilBufferClearValue_;
+        const auto offset = y * width + x0;
+        std::fill_n(pixelBuffer_.get() + offset, tileWidth, pixelBufferClearValue_);
+        std::fill_n(depthBuffer_.get() + offset, tileWidth, depthBufferClearValue_);
+        std::fill_n(stencilBuffer_.get() + offset, tileWidth, stencilBufferClearValue_);
     }
+    state = TileState::Resolved;
+    --clearedTileCount_;
 }
 
 
@@ -171,11 +380,17 @@ Framebuffer::resize()
     pixelBufferImage_.reset(new QImage(reinterpret_cast<uchar*>(pixelBuffer_.get()), width, height, QImage::Format_ARGB32));
 
     depthBuffer_.reset(new double[size]);
-    depthBufferImageData_.reset(new std::uint32_t[size]);
-    depthBufferImage_.reset(new QImage(reinterpret_cast<uchar*>(depthBufferImageData_.get()), width, height, QImage::Format_RGB32));
-
     stencilBuffer_.reset(new std::uint8_t[size]);
-    stencilBufferImage_.reset(new QImage(reinterpret_cast<uchar*>(stencilBuffer_.get()), width, height, QImage::Format_Mono));
+
+    // The depth and stencil visualisations are only created when they're requested.
+    depthBufferImage_.reset();
+    depthBufferImageData_.reset();
+    stencilBufferImage_.reset();
+    stencilBufferImageData_.reset();
+
+    tileColumnCount_ = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tileRowCount_ = (height + TILE_SIZE - 1) / TILE_SIZE;
+    tileStates_.reset(new TileState[tileColumnCount_ * tileRowCount_]);
 
     clear();
 }
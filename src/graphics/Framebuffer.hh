@@ -28,6 +28,7 @@
 #include <QObject>
 #include <QSize>
 #include <QImage>
+#include <QRect>
 #include <memory>
 
 
@@ -82,7 +83,15 @@ public:
      */
     void setResolution(const Framebuffer::Resolution resolution);
     /**
-     * Returns the pixel buffer.
+     * The width and height (in pixels) of a framebuffer tile. The attachments are
+     * cleared lazily at tile granularity, so this is also the size of the smallest
+     * region a clear value is ever written to.
+     */
+    static constexpr unsigned int TILE_SIZE = 64;
+    /**
+     * Returns the pixel buffer. Fragments in a tile that has been cleared but not yet
+     * touched hold stale data, so callers must touch (or cover) a tile before reading
+     * from or partially writing to it.
      */
     std::uint32_t* getPixelBuffer();
     /**
@@ -90,34 +99,77 @@ public:
      */
     const QImage& getPixelBufferImage() const;
     /**
-     * Returns the depth buffer.
+     * Returns the depth buffer. The same tile rules as getPixelBuffer apply.
      */
     double* getDepthBuffer();
     /**
-     * Returns an image representation of the depth buffer.
+     * Returns an image representation of the depth buffer, where depth values are
+     * normalised to greyscale between the nearest (black) and farthest (white) written
+     * fragments. The image is converted on every call, so it is meant for debug views.
      */
     const QImage& getDepthBufferImage() const;
     /**
-     * Returns the stencil buffer.
+     * Returns the stencil buffer. The same tile rules as getPixelBuffer apply.
      */
     std::uint8_t* getStencilBuffer();
     /**
-     * Returns an image representation of the stencil buffer.
+     * Returns an image representation of the stencil buffer, where each stencil value is
+     * used as a greyscale intensity. Like the depth buffer image, it is converted on
+     * every call.
      */
     const QImage& getStencilBufferImage() const;
     /**
-     * Clears the framebuffer.
+     * Clears the framebuffer. This only tags each tile as cleared; the clear values are
+     * written when a tile is first touched or when the framebuffer is resolved.
      */
     void clear();
+    /**
+     * Prepares the tile containing the fragment at the specified <x, y> coordinate for
+     * writing, materialising its clear values if the tile has been cleared.
+     */
+    void touch(const unsigned int x, const unsigned int y);
+    /**
+     * Declares that every fragment in the specified region will be overwritten. Cleared
+     * tiles that lie entirely inside the region are marked as resolved without writing
+     * their clear values, while partially covered tiles are touched.
+     */
+    void cover(const QRect& region);
+    /**
+     * Writes the clear values to every tile that is still tagged as cleared. This is
+     * done implicitly when an image representation of an attachment is requested.
+     */
+    void resolve() const;
     /**
      * Discards the fragment at the specified <x, y> coordinate.
      */
     void discard(const unsigned int x, const unsigned int y);
 private:
+    /**
+     * The state of a framebuffer tile.
+     */
+    enum class TileState : std::uint8_t
+    {
+        Resolved, // The tile's attachments hold valid data.
+        Cleared   // The tile has been cleared but its clear values have not been written.
+    };
     /**
      * The framebuffer's resolution.
      */
     Framebuffer::Resolution resolution_;
+    /**
+     * The number of tile columns and rows.
+     */
+    unsigned int tileColumnCount_;
+    unsigned int tileRowCount_;
+    /**
+     * The state of each tile, in row-major order. This is mutable since a resolve may be
+     * triggered by a read-only request for an attachment's image.
+     */
+    mutable std::unique_ptr<TileState[]> tileStates_;
+    /**
+     * The number of tiles that are still tagged as cleared.
+     */
+    mutable std::size_t clearedTileCount_;
     /**
      * The framebuffer's pixel buffer attachment.
      */
@@ -139,13 +191,14 @@ private:
      */
     double depthBufferClearValue_;
     /**
-     * The framebuffer's depth buffer image data.
+     * The depth buffer's visualisation data. This is only allocated and written when the
+     * depth buffer image is requested, and is reused across requests.
      */
-    std::unique_ptr<std::uint32_t[]> depthBufferImageData_;
+    mutable std::unique_ptr<std::uint32_t[]> depthBufferImageData_;
     /**
-     * The framebuffer's depth-stencil buffer image.
+     * The framebuffer's depth buffer image.
      */
-    std::unique_ptr<QImage> depthBufferImage_;
+    mutable std::unique_ptr<QImage> depthBufferImage_;
     /**
      * The framebuffer's stencil buffer attachment.
      */
@@ -154,14 +207,24 @@ private:
      * The stencil buffer's clear value.
      */
     std::uint8_t stencilBufferClearValue_;
+    /**
+     * The stencil buffer's visualisation data. Like the depth buffer's, this is only
+     * allocated and written on request.
+     */
+    mutable std::unique_ptr<std::uint32_t[]> stencilBufferImageData_;
     /**
      * The framebuffer's stencil buffer image.
      */
-    std::unique_ptr<QImage> stencilBufferImage_;
+    mutable std::unique_ptr<QImage> stencilBufferImage_;
     /**
      * Resizes the framebuffer's attachments.
      */
     void resize();
+    /**
+     * Writes the clear values to the tile at the specified column and row, if it has been
+     * cleared.
+     */
+    void resolveTile(const unsigned int column, const unsigned int row) const;
 };
 
 /**
@@ -29,7 +29,7 @@ using clockwork::GraphicsEngine;
 
 GraphicsEngine::GraphicsEngine(TaskManager& taskManager) :
 taskManager_(taskManager),
-framebuffer_(Framebuffer::Resolution::SVGA)
+swapChain_(Framebuffer::Resolution::SVGA)
 {}
 
 
@@ -37,8 +37,8 @@ GraphicsEngine::~GraphicsEngine()
 {}
 
 
-clockwork::Framebuffer&
-GraphicsEngine::getFramebuffer()
+clockwork::SwapChain&
+GraphicsEngine::getSwapChain()
 {
-    return framebuffer_;
+    return swapChain_;
 }
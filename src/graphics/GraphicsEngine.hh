@@ -25,7 +25,7 @@
 #ifndef CLOCKWORK_GRAPHICS_ENGINE_HH
 #define CLOCKWORK_GRAPHICS_ENGINE_HH
 
-#include "Framebuffer.hh"
+#include "SwapChain.hh"
 
 
 namespace clockwork {
@@ -65,18 +65,18 @@ public:
      */
     void render(const Scene& scene);
     /**
-     * Returns the framebuffer instance.
+     * Returns the swap chain that rendered frames are presented through.
      */
-    Framebuffer& getFramebuffer();
+    SwapChain& getSwapChain();
 private:
     /**
      * The task manager.
      */
     TaskManager& taskManager_;
     /**
-     * The framebuffer.
+     * The swap chain.
      */
-    Framebuffer framebuffer_;
+    SwapChain swapChain_;
 };
 
 } // namespace clockwork
@@ -0,0 +1,101 @@
+/*
+ * This file is part of Clockwork.
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * The MIT License (MIT)
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "SwapChain.hh"
+
+using clockwork::SwapChain;
+
+
+constexpr std::size_t SwapChain::LENGTH;
+constexpr unsigned int SwapChain::PENDING_FRAME;
+
+
+SwapChain::SwapChain(const Framebuffer::Resolution resolution) :
+resolution_(resolution),
+back_(0),
+pending_(1),
+front_(2)
+{
+    for (auto& framebuffer : framebuffers_)
+        framebuffer.reset(new Framebuffer(resolution));
+}
+
+
+SwapChain::~SwapChain()
+{}
+
+
+clockwork::Framebuffer::Resolution
+SwapChain::getResolution() const
+{
+    return resolution_.load(std::memory_order_relaxed);
+}
+
+
+void
+SwapChain::setResolution(const Framebuffer::Resolution resolution)
+{
+    resolution_.store(resolution, std::memory_order_relaxed);
+}
+
+
+clockwork::Framebuffer&
+SwapChain::getBackBuffer()
+{
+    auto& framebuffer = *framebuffers_[back_];
+    framebuffer.setResolution(getResolution());
+
+    return framebuffer;
+}
+
+
+void
+SwapChain::swap()
+{
+    // Release the back buffer's contents to the presenter, and acquire whichever buffer
+    // the presenter last released (or the stale pending frame it never picked up).
+    const auto previous = pending_.exchange(back_ | PENDING_FRAME, std::memory_order_acq_rel);
+    back_ = previous & ~PENDING_FRAME;
+
+    emit frameReady();
+}
+
+
+bool
+SwapChain::hasPendingFrame() const
+{
+    return (pending_.load(std::memory_order_acquire) & PENDING_FRAME) != 0;
+}
+
+
+clockwork::Framebuffer&
+SwapChain::getFrontBuffer()
+{
+    if (hasPendingFrame())
+    {
+        const auto previous = pending_.exchange(front_, std::memory_order_acq_rel);
+        front_ = previous & ~PENDING_FRAME;
+    }
+    return *framebuffers_[front_];
+}
@@ -0,0 +1,144 @@
+/*
+ * This file is part of Clockwork.
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * The MIT License (MIT)
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef CLOCKWORK_SWAP_CHAIN_HH
+#define CLOCKWORK_SWAP_CHAIN_HH
+
+#include "Framebuffer.hh"
+#include <QObject>
+#include <array>
+#include <atomic>
+
+
+namespace clockwork {
+
+/**
+ * A swap chain hands rendered framebuffers over to the presenter without either side
+ * having to wait for the other. It holds three framebuffers: the back buffer, which the
+ * renderer draws into; the front buffer, which the presenter reads from; and a pending
+ * buffer which holds the most recently completed frame. Swapping and presenting simply
+ * exchange a buffer with the pending one atomically, so the renderer can draw frame N+1
+ * while the presenter is still reading frame N.
+ *
+ * The swap chain supports exactly one renderer thread and one presenter thread.
+ */
+class SwapChain final : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * The number of framebuffers in the swap chain.
+     */
+    static constexpr std::size_t LENGTH = 3;
+    /**
+     *
+     */
+    explicit SwapChain(const Framebuffer::Resolution resolution);
+    /**
+     *
+     */
+    SwapChain(const SwapChain&) = delete;
+    /**
+     *
+     */
+    SwapChain(SwapChain&&) = delete;
+    /**
+     *
+     */
+    ~SwapChain();
+    /**
+     *
+     */
+    SwapChain& operator=(const SwapChain&) = delete;
+    /**
+     *
+     */
+    SwapChain& operator=(SwapChain&&) = delete;
+    /**
+     * Returns the framebuffers' resolution.
+     */
+    Framebuffer::Resolution getResolution() const;
+    /**
+     * Sets the framebuffers' resolution. The change is applied to each framebuffer the
+     * next time it becomes the back buffer, so it is safe to call from any thread.
+     */
+    void setResolution(const Framebuffer::Resolution resolution);
+    /**
+     * Returns the framebuffer the renderer should draw into. This must only be called by
+     * the renderer thread.
+     */
+    Framebuffer& getBackBuffer();
+    /**
+     * Publishes the back buffer as the most recently completed frame, and makes another
+     * framebuffer the back buffer. This must only be called by the renderer thread.
+     */
+    void swap();
+    /**
+     * Returns true if a frame has been completed since the presenter last acquired the
+     * front buffer.
+     */
+    bool hasPendingFrame() const;
+    /**
+     * Returns the most recently completed frame. The framebuffer remains valid and
+     * unmodified until the next call to this function. This must only be called by the
+     * presenter thread.
+     */
+    Framebuffer& getFrontBuffer();
+signals:
+    /**
+     * Signals that a frame has been completed and can be presented. This is emitted from
+     * the renderer thread.
+     */
+    void frameReady();
+private:
+    /**
+     * A flag set in the pending buffer's index when it holds a frame that the presenter
+     * has not yet acquired.
+     */
+    static constexpr unsigned int PENDING_FRAME = 0x4;
+    /**
+     * The swap chain's framebuffers.
+     */
+    std::array<std::unique_ptr<Framebuffer>, LENGTH> framebuffers_;
+    /**
+     * The requested framebuffer resolution.
+     */
+    std::atomic<Framebuffer::Resolution> resolution_;
+    /**
+     * The index of the renderer's back buffer.
+     */
+    unsigned int back_;
+    /**
+     * The index of the pending buffer, combined with the PENDING_FRAME flag.
+     */
+    std::atomic<unsigned int> pending_;
+    /**
+     * The index of the presenter's front buffer.
+     */
+    unsigned int front_;
+};
+
+} // namespace clockwork
+
+#endif // CLOCKWORK_SWAP_CHAIN_HH
@@ -44,7 +44,7 @@ Application::initialize()
 {
     auto error = Error::None;
 
-    error = userInterface_.initialize(graphicsEngine_.getFramebuffer());
+    error = userInterface_.initialize(graphicsEngine_.getSwapChain());
     if (error != Error::None)
         return error;
 
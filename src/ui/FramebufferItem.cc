@@ -0,0 +1,188 @@
+/*
+ * This file is part of Clockwork.
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * The MIT License (MIT)
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include "FramebufferItem.hh"
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+#include <cmath>
+
+using clockwork::FramebufferItem;
+
+
+namespace {
+/**
+ * A render node that paints an image with the software backend's painter.
+ */
+class FramebufferNode final : public QSGRenderNode
+{
+public:
+    explicit FramebufferNode(QQuickWindow& window) :
+    window_(window)
+    {}
+
+    void setPosition(const QPointF& position)
+    {
+        position_ = position;
+    }
+
+    void setImage(const QImage& image)
+    {
+        image_ = image;
+    }
+
+    const QImage& getImage() const
+    {
+        return image_;
+    }
+
+    void render(const RenderState* state) override
+    {
+        auto* const renderer = window_.rendererInterface();
+        auto* const painter = static_cast<QPainter*>(renderer->getResource(&window_, QSGRendererInterface::PainterResource));
+        if (painter == nullptr || image_.isNull())
+            return;
+
+        painter->setTransform(matrix()->toTransform());
+        painter->setOpacity(inheritedOpacity());
+        if (state->clipRegion() != nullptr)
+            painter->setClipRegion(*state->clipRegion(), Qt::IntersectClip);
+
+        // The image shares the framebuffer's memory, and is drawn at its native size.
+        painter->drawImage(position_, image_);
+    }
+
+    StateFlags changedStates() const override
+    {
+        return 0;
+    }
+
+    RenderingFlags flags() const override
+    {
+        return BoundedRectRendering | OpaqueRendering;
+    }
+
+    QRectF rect() const override
+    {
+        return QRectF(position_, image_.size());
+    }
+private:
+    QQuickWindow& window_;
+    QImage image_;
+    QPointF position_;
+};
+} // namespace
+
+
+FramebufferItem::FramebufferItem(QQuickItem* const parent) :
+QQuickItem(parent),
+swapChain_(nullptr),
+attachment_("pixel"),
+isAttachmentDirty_(false)
+{
+    setFlag(QQuickItem::ItemHasContents);
+}
+
+
+clockwork::SwapChain*
+FramebufferItem::getSwapChain() const
+{
+    return swapChain_;
+}
+
+
+void
+FramebufferItem::setSwapChain(SwapChain* const swapChain)
+{
+    if (swapChain_ != swapChain)
+    {
+        if (swapChain_ != nullptr)
+            disconnect(swapChain_, &SwapChain::frameReady, this, &QQuickItem::update);
+
+        swapChain_ = swapChain;
+        if (swapChain_ != nullptr)
+            connect(swapChain_, &SwapChain::frameReady, this, &QQuickItem::update, Qt::QueuedConnection);
+
+        emit swapChainChanged();
+        update();
+    }
+}
+
+
+const QString&
+FramebufferItem::getAttachment() const
+{
+    return attachment_;
+}
+
+
+void
+FramebufferItem::setAttachment(const QString& attachment)
+{
+    if (attachment_ != attachment)
+    {
+        attachment_ = attachment;
+        isAttachmentDirty_ = true;
+        emit attachmentChanged();
+        update();
+    }
+}
+
+
+QSGNode*
+FramebufferItem::updatePaintNode(QSGNode* node, UpdatePaintNodeData*)
+{
+    auto* framebufferNode = static_cast<FramebufferNode*>(node);
+    if (swapChain_ == nullptr)
+    {
+        delete framebufferNode;
+        return nullptr;
+    }
+    if (framebufferNode == nullptr)
+        framebufferNode = new FramebufferNode(*window());
+
+    // The scene graph is synchronized while the GUI thread is blocked, so this is the
+    // only place the front buffer is acquired. The previous front buffer is handed back
+    // to the renderer, which is why the node's image is always replaced here.
+    if (swapChain_->hasPendingFrame() || isAttachmentDirty_ || framebufferNode->getImage().isNull())
+    {
+        const auto& framebuffer = swapChain_->getFrontBuffer();
+        if (attachment_ == "depth")
+            framebufferNode->setImage(framebuffer.getDepthBufferImage());
+        else if (attachment_ == "stencil")
+            framebufferNode->setImage(framebuffer.getStencilBufferImage());
+        else
+            framebufferNode->setImage(framebuffer.getPixelBufferImage());
+
+        isAttachmentDirty_ = false;
+        framebufferNode->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    // Center the image in the item, on a pixel boundary so it is never resampled.
+    const auto& size = framebufferNode->getImage().size();
+    framebufferNode->setPosition(QPointF(std::floor(0.5 * (width() - size.width())), std::floor(0.5 * (height() - size.height()))));
+
+    return framebufferNode;
+}
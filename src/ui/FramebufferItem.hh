@@ -0,0 +1,98 @@
+/*
+ * This file is part of Clockwork.
+ *
+ * Copyright (c) 2014-2016 Jeremy Othieno.
+ *
+ * The MIT License (MIT)
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef CLOCKWORK_FRAMEBUFFER_ITEM_HH
+#define CLOCKWORK_FRAMEBUFFER_ITEM_HH
+
+#include "SwapChain.hh"
+#include <QQuickItem>
+
+
+namespace clockwork {
+
+/**
+ * A Qt Quick item that presents a swap chain's front buffer. The item is repainted only
+ * when the swap chain signals that a frame is ready, and the framebuffer's image is drawn
+ * directly by the software scene graph backend at its native resolution, centered in the
+ * item, without an intermediate copy or rescale.
+ */
+class FramebufferItem final : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(clockwork::SwapChain* swapChain READ getSwapChain WRITE setSwapChain NOTIFY swapChainChanged)
+    Q_PROPERTY(QString attachment READ getAttachment WRITE setAttachment NOTIFY attachmentChanged)
+public:
+    /**
+     *
+     */
+    explicit FramebufferItem(QQuickItem* const parent = nullptr);
+    /**
+     * Returns the swap chain whose frames are presented.
+     */
+    SwapChain* getSwapChain() const;
+    /**
+     * Sets the swap chain whose frames are presented.
+     */
+    void setSwapChain(SwapChain* const swapChain);
+    /**
+     * Returns the name of the presented attachment, i.e. "pixel", "depth" or "stencil".
+     */
+    const QString& getAttachment() const;
+    /**
+     * Sets the name of the presented attachment.
+     */
+    void setAttachment(const QString& attachment);
+signals:
+    /**
+     *
+     */
+    void swapChainChanged();
+    /**
+     *
+     */
+    void attachmentChanged();
+protected:
+    /**
+     * Updates the item's render node with the most recently completed frame.
+     */
+    QSGNode* updatePaintNode(QSGNode* node, UpdatePaintNodeData*) override;
+private:
+    /**
+     * The swap chain whose frames are presented.
+     */
+    SwapChain* swapChain_;
+    /**
+     * The name of the presented attachment.
+     */
+    QString attachment_;
+    /**
+     * True if the attachment has changed since the node was last updated, in which case
+     * the current front buffer must be presented again.
+     */
+    bool isAttachmentDirty_;
+};
+
+} // namespace clockwork
+
+#endif // CLOCKWORK_FRAMEBUFFER_ITEM_HH
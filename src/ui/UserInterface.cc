@@ -24,15 +24,23 @@
  */
 #include "UserInterface.hh"
 #include "Application.hh"
-#include "FramebufferProvider.hh"
+#include "FramebufferItem.hh"
+#include "SwapChain.hh"
+#include <QQmlContext>
+#include <QQuickWindow>
 
 using clockwork::UserInterface;
 
 
 clockwork::Error
-UserInterface::initialize(const Framebuffer& framebuffer)
+UserInterface::initialize(SwapChain& swapChain)
 {
-    engine_.addImageProvider("framebuffer", new clockwork::FramebufferProvider(framebuffer));
+    // Frames are painted directly by the software backend, so no texture uploads are
+    // needed to present them.
+    QQuickWindow::setSceneGraphBackend(QSGRendererInterface::Software);
+    qmlRegisterType<FramebufferItem>("Clockwork", 1, 0, "Framebuffer");
+
+    engine_.rootContext()->setContextProperty("graphicsSwapChain", &swapChain);
     engine_.load(QUrl("qrc:/view/main"));
 
     return Error::None;
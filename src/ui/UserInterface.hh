@@ -32,7 +32,7 @@
 namespace clockwork {
 
 class Application;
-class Framebuffer;
+class SwapChain;
 
 class UserInterface
 {
@@ -43,7 +43,7 @@ public:
     UserInterface& operator=(const UserInterface&) = delete;
     UserInterface& operator=(UserInterface&&) = delete;
 
-    Error initialize(const Framebuffer& framebuffer);
+    Error initialize(SwapChain& swapChain);
 private:
     QQmlApplicationEngine engine_;
 
@@ -27,6 +27,7 @@ import QtQuick.Controls 1.4
 import QtQuick.Controls.Styles 1.4
 import QtQuick.Layouts 1.0
 import Material 0.2
+import Clockwork 1.0
 
 
 ApplicationWindow {
@@ -38,16 +39,10 @@ ApplicationWindow {
         id: sceneView
         title: "Scene"
 
-        Image {
-            anchors.centerIn: parent
-            width: dp(800)
-            height: dp(600)
-            cache: false
-            source: "image://framebuffer/pixel"
-/*
-            source: "image://framebuffer/depth"
-            source: "image://framebuffer/stencil"
-*/
+        Framebuffer {
+            anchors.fill: parent
+            swapChain: graphicsSwapChain
+            attachment: "pixel" // Or "depth", "stencil".
         }
     }
     statusBar: StatusBar {